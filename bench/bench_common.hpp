@@ -0,0 +1,416 @@
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Beam {
+
+inline uint64_t benchNowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** @brief Keeps the optimizer from discarding a benchmark's output. */
+inline void benchDoNotOptimize(const void* data) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(data) : "memory");
+#else
+    static volatile const void* sink;
+    sink = data;
+#endif
+}
+
+/**
+ * @class PerfCounters
+ * @brief User-space instruction and cycle counters (Linux perf_event), for IPC.
+ * Unavailable elsewhere, in containers without perf access, or when
+ * perf_event_paranoid forbids it; getIPC() then returns -1.
+ */
+class PerfCounters {
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        m_cyclesFd = open(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (m_cyclesFd >= 0) m_instructionsFd = open(PERF_COUNT_HW_INSTRUCTIONS, m_cyclesFd);
+        if (m_instructionsFd < 0 && m_cyclesFd >= 0) {
+            close(m_cyclesFd);
+            m_cyclesFd = -1;
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        if (m_instructionsFd >= 0) close(m_instructionsFd);
+        if (m_cyclesFd >= 0) close(m_cyclesFd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool isAvailable() const { return m_cyclesFd >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        if (!isAvailable()) return;
+        ioctl(m_cyclesFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_cyclesFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    void stop() {
+#if defined(__linux__)
+        if (!isAvailable()) return;
+        ioctl(m_cyclesFd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[3] = {}; // nr, cycles, instructions
+        if (read(m_cyclesFd, values, sizeof(values)) == (ssize_t)sizeof(values)) {
+            m_cycles = values[1];
+            m_instructions = values[2];
+        }
+#endif
+    }
+
+    uint64_t getCycles() const { return m_cycles; }
+    uint64_t getInstructions() const { return m_instructions; }
+
+    /** @brief Instructions per cycle over the last start()/stop(), or -1. */
+    double getIPC() const { return (isAvailable() && m_cycles > 0) ? (double)m_instructions / (double)m_cycles : -1.0; }
+
+private:
+#if defined(__linux__)
+    static int open(uint64_t config, int groupFd) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = groupFd < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+    }
+#endif
+
+    int m_cyclesFd = -1;
+    int m_instructionsFd = -1;
+    uint64_t m_cycles = 0;
+    uint64_t m_instructions = 0;
+};
+
+/**
+ * @class TestSignal
+ * @brief Deterministic interleaved stereo program material: a detuned chord,
+ * pink-ish noise and decaying percussive bursts, peaking around -6 dBFS.
+ * Exercises dynamics, filters and reverbs the way music does, unlike silence
+ * (which hits denormal and early-out paths) or a single sine.
+ */
+class TestSignal {
+public:
+    TestSignal(float sampleRate, float seconds = 2.0f) {
+        const size_t frames = (size_t)(sampleRate * seconds);
+        m_samples.resize(frames * 2);
+        std::mt19937 rng(0xF1u);
+        std::uniform_real_distribution<float> white(-1.0f, 1.0f);
+        const float twoPi = 6.2831853f;
+        const float chord[3] = { 110.0f, 164.8f, 220.7f };
+        const size_t beat = (size_t)(sampleRate * 0.25f);
+        float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f; // Paul Kellet's economy pink filter
+
+        for (size_t i = 0; i < frames; ++i) {
+            const float t = (float)i / sampleRate;
+            float tone = 0.0f;
+            for (float f : chord) tone += std::sin(twoPi * f * t) / 3.0f;
+
+            const float w = white(rng);
+            b0 = 0.99765f * b0 + w * 0.0990460f;
+            b1 = 0.96300f * b1 + w * 0.2965164f;
+            b2 = 0.57000f * b2 + w * 1.0526913f;
+            const float pink = (b0 + b1 + b2 + w * 0.1848f) * 0.05f;
+
+            const float hitAge = (float)(i % beat) / sampleRate;
+            const float hit = std::exp(-hitAge * 30.0f) * white(rng);
+
+            const float mono = 0.3f * tone + 0.15f * pink + 0.3f * hit;
+            m_samples[i * 2] = mono + 0.02f * std::sin(twoPi * 0.5f * t);
+            m_samples[i * 2 + 1] = mono - 0.02f * std::sin(twoPi * 0.5f * t);
+        }
+    }
+
+    /** @brief Copies the next `frames` frames into `out`, looping. */
+    void read(float* out, int frames) {
+        const size_t total = m_samples.size() / 2;
+        for (int i = 0; i < frames; ++i) {
+            out[i * 2] = m_samples[m_position * 2];
+            out[i * 2 + 1] = m_samples[m_position * 2 + 1];
+            if (++m_position == total) m_position = 0;
+        }
+    }
+
+private:
+    std::vector<float> m_samples;
+    size_t m_position = 0;
+};
+
+/**
+ * @struct BenchResult
+ * @brief One measured configuration. Extra metrics a suite records beside the
+ * timing (bytes, latency percentiles, ...) go into `metrics`.
+ */
+struct BenchResult {
+    std::string name;
+    int sampleRate = 0;
+    int blockFrames = 0;
+    double nsPerSample = 0.0;     // Per sample frame (all channels), or per unit of the suite's work
+    double realtimeFactor = 0.0;  // Audio time processed per wall-clock time; 0 if not applicable
+    double ipc = -1.0;            // -1 when counters are unavailable
+    uint64_t iterations = 0;
+    std::map<std::string, double> metrics;
+
+    /** @brief Baselines are matched on this. */
+    std::string key() const {
+        return name + "@" + std::to_string(sampleRate) + "/" + std::to_string(blockFrames);
+    }
+};
+
+/**
+ * @struct BenchOptions
+ * @brief Command line shared by the bench executables. A suite declares its own
+ * `--name VALUE` options before parse(); anything undeclared is rejected.
+ */
+struct BenchOptions {
+    std::string outPath;        // .json or .csv; nothing is written if empty
+    std::string baselinePath;   // JSON from an earlier --out
+    std::string filter;         // Substring of the result name
+    double thresholdPercent = 10.0;
+    double minTimeMs = 50.0;    // Per repetition
+    int repeats = 3;            // The median repetition is reported
+    bool quick = false;         // One sample rate and block size
+    std::map<std::string, std::string> extra; // Values of the suite options given
+
+    struct SuiteOption {
+        std::string name;   // Without the leading "--"
+        std::string value;  // Placeholder shown in the usage, e.g. "N"
+        std::string help;
+    };
+    std::vector<SuiteOption> suiteOptions;
+
+    /** @brief Declares a suite option, read back with get(). Call before parse(). */
+    void declare(const std::string& name, const std::string& value, const std::string& help) {
+        suiteOptions.push_back({ name, value, help });
+    }
+
+    void printUsage(const char* program, std::ostream& out) const {
+        out << "Usage: " << program << " [options]\n"
+            << "  --out FILE          Write results (.json, or .csv)\n"
+            << "  --baseline FILE     Compare with a JSON result file\n"
+            << "  --threshold PCT     Slowdown that counts as a regression (default 10)\n"
+            << "  --filter TEXT       Only run benchmarks whose name contains TEXT\n"
+            << "  --min-time MS       Minimum time per repetition (default 50)\n"
+            << "  --repeats N         Repetitions; the median is reported (default 3)\n"
+            << "  --quick             One sample rate and block size\n";
+        for (const auto& option : suiteOptions) {
+            const std::string flag = "--" + option.name + " " + option.value;
+            out << "  " << std::left << std::setw(19) << flag << std::right << " " << option.help << "\n";
+        }
+    }
+
+    /** @brief Returns false (after printing usage) on --help or a malformed command line. */
+    bool parse(int argc, char** argv) {
+        auto fail = [&](const std::string& reason) {
+            std::cerr << reason << std::endl;
+            printUsage(argv[0], std::cerr);
+            return false;
+        };
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") { printUsage(argv[0], std::cout); return false; }
+            if (arg == "--quick") { quick = true; continue; }
+
+            const bool common = arg == "--out" || arg == "--baseline" || arg == "--filter" ||
+                                arg == "--threshold" || arg == "--min-time" || arg == "--repeats";
+            const bool declared = arg.rfind("--", 0) == 0 &&
+                std::any_of(suiteOptions.begin(), suiteOptions.end(), [&](const SuiteOption& o) { return arg.compare(2, std::string::npos, o.name) == 0; });
+            if (!common && !declared) return fail("Unknown option: " + arg);
+            if (i + 1 >= argc) return fail(arg + " needs a value");
+
+            const std::string v = argv[++i];
+            if (arg == "--out") outPath = v;
+            else if (arg == "--baseline") baselinePath = v;
+            else if (arg == "--filter") filter = v;
+            else if (arg == "--threshold") thresholdPercent = std::atof(v.c_str());
+            else if (arg == "--min-time") minTimeMs = std::atof(v.c_str());
+            else if (arg == "--repeats") repeats = (std::max)(1, std::atoi(v.c_str()));
+            else extra[arg.substr(2)] = v;
+        }
+        return true;
+    }
+
+    bool matches(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    std::string get(const std::string& key, const std::string& fallback) const {
+        auto it = extra.find(key);
+        return it != extra.end() ? it->second : fallback;
+    }
+};
+
+/**
+ * @class BenchReport
+ * @brief Collects results, prints them as they arrive, writes them as JSON or
+ * CSV and compares them with a baseline file.
+ */
+class BenchReport {
+public:
+    explicit BenchReport(std::string suite) : m_suite(std::move(suite)) {}
+
+    void add(const BenchResult& result) {
+        m_results.push_back(result);
+        const StreamFormat saved(std::cout);
+        // Columns are separated explicitly, so a value that fills its width cannot run into the next.
+        std::cout << std::left << std::setw(40) << result.name << std::right
+                  << ' ' << std::setw(6) << result.sampleRate << ' ' << std::setw(7) << result.blockFrames
+                  << std::fixed << std::setprecision(2) << ' ' << std::setw(11) << result.nsPerSample << " ns";
+        if (result.realtimeFactor > 0.0) std::cout << ' ' << std::setw(10) << std::setprecision(1) << result.realtimeFactor << "x RT";
+        if (result.ipc >= 0.0) std::cout << ' ' << std::setw(6) << std::setprecision(2) << result.ipc << " IPC";
+        for (const auto& [metric, value] : result.metrics) std::cout << "  " << metric << "=" << std::setprecision(2) << value;
+        std::cout << std::endl;
+    }
+
+    const std::vector<BenchResult>& getResults() const { return m_results; }
+
+    nlohmann::json toJson() const {
+        nlohmann::json results = nlohmann::json::array();
+        for (const auto& r : m_results) {
+            nlohmann::json entry = {
+                {"name", r.name}, {"sampleRate", r.sampleRate}, {"blockFrames", r.blockFrames},
+                {"nsPerSample", r.nsPerSample}, {"realtimeFactor", r.realtimeFactor},
+                {"ipc", r.ipc}, {"iterations", r.iterations}
+            };
+            for (const auto& [metric, value] : r.metrics) entry["metrics"][metric] = value;
+            results.push_back(entry);
+        }
+        return { {"suite", m_suite}, {"timestamp", (long long)std::time(nullptr)}, {"results", results} };
+    }
+
+    bool write(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file) {
+            std::cerr << "Bench: cannot write " << path << std::endl;
+            return false;
+        }
+        const bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+        if (csv) {
+            file << "name,sampleRate,blockFrames,nsPerSample,realtimeFactor,ipc,iterations\n";
+            for (const auto& r : m_results) {
+                file << '"' << r.name << "\"," << r.sampleRate << ',' << r.blockFrames << ',' << r.nsPerSample
+                     << ',' << r.realtimeFactor << ',' << r.ipc << ',' << r.iterations << '\n';
+            }
+        } else {
+            file << toJson().dump(2) << '\n';
+        }
+        std::cout << "Results written to " << path << std::endl;
+        return (bool)file;
+    }
+
+    /**
+     * @brief Prints every result that moved by more than `thresholdPercent`
+     * against the baseline's nsPerSample.
+     * @return Number of regressions, or -1 if the baseline cannot be read.
+     */
+    int compare(const std::string& baselinePath, double thresholdPercent) const {
+        std::ifstream file(baselinePath);
+        nlohmann::json baseline = nlohmann::json::parse(file, nullptr, false);
+        if (!file || baseline.is_discarded() || !baseline.contains("results")) {
+            std::cerr << "Bench: cannot read baseline " << baselinePath << std::endl;
+            return -1;
+        }
+
+        std::map<std::string, double> previous;
+        for (const auto& entry : baseline["results"]) {
+            BenchResult r;
+            r.name = entry.value("name", "");
+            r.sampleRate = entry.value("sampleRate", 0);
+            r.blockFrames = entry.value("blockFrames", 0);
+            previous[r.key()] = entry.value("nsPerSample", 0.0);
+        }
+
+        int regressions = 0, improvements = 0, compared = 0;
+        const StreamFormat saved(std::cout);
+        std::cout << "\nAgainst " << baselinePath << " (threshold " << std::fixed << std::setprecision(1)
+                  << thresholdPercent << "%):" << std::endl;
+        for (const auto& r : m_results) {
+            auto it = previous.find(r.key());
+            if (it == previous.end() || it->second <= 0.0) continue;
+            ++compared;
+            const double change = (r.nsPerSample / it->second - 1.0) * 100.0;
+            if (std::abs(change) <= thresholdPercent) continue;
+            const bool slower = change > 0.0;
+            (slower ? regressions : improvements)++;
+            std::cout << (slower ? "  REGRESSION  " : "  improvement ") << std::left << std::setw(48) << r.key() << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(10) << it->second << " -> " << std::setw(10) << r.nsPerSample
+                      << std::showpos << std::setprecision(1) << std::setw(9) << change << "%" << std::noshowpos << std::endl;
+        }
+        std::cout << compared << " compared, " << regressions << " regressions, " << improvements << " improvements" << std::endl;
+        return regressions;
+    }
+
+    /**
+     * @brief Writes and compares as the options ask.
+     * @return The process exit code: 1 on a regression or an unreadable baseline.
+     */
+    int finish(const BenchOptions& options) const {
+        if (!options.outPath.empty()) write(options.outPath);
+        if (options.baselinePath.empty()) return 0;
+        return compare(options.baselinePath, options.thresholdPercent) == 0 ? 0 : 1;
+    }
+
+private:
+    // Restores a stream's flags and precision, so one report line cannot change how the next prints.
+    struct StreamFormat {
+        explicit StreamFormat(std::ostream& out) : stream(out), flags(out.flags()), precision(out.precision()) {}
+        ~StreamFormat() {
+            stream.flags(flags);
+            stream.precision(precision);
+        }
+        std::ostream& stream;
+        std::ios_base::fmtflags flags;
+        std::streamsize precision;
+    };
+
+    std::string m_suite;
+    std::vector<BenchResult> m_results;
+};
+
+/** @brief Median of a small sample; `values` is reordered. */
+inline double benchMedian(std::vector<double>& values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t mid = values.size() / 2;
+    return (values.size() % 2) ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
+
+} // namespace Beam
+
+#endif // BENCH_COMMON_HPP
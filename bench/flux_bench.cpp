@@ -0,0 +1,167 @@
+#include "bench_common.hpp"
+#include "../src/engine/analog_suite.hpp"
+#include "../src/engine/flux_fx_nodes.hpp"
+#include "../src/engine/tube_compressor_node.hpp"
+#include "../src/engine/master_node.hpp"
+#include "../src/engine/sine_synth_node.hpp"
+#include "../src/engine/flux_script_node.hpp"
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+// DSP microbenchmarks: every node type, driven with program material at several
+// block sizes and sample rates. Reports ns per sample frame, the real-time
+// factor (one node on one core) and instructions per cycle where the CPU
+// counters are readable. See docs/AUDIO_ENGINE.md, "Benchmarks".
+
+using namespace Beam;
+
+namespace {
+
+using NodeFactory = std::function<std::shared_ptr<FluxNode>(int blockFrames, float sampleRate)>;
+
+struct NodeBench {
+    std::string name;
+    NodeFactory create;
+};
+
+template <typename T>
+NodeBench plugin(const std::string& name) {
+    return { name, [](int block, float sr) { return std::make_shared<T>(block, sr); } };
+}
+
+const char* kScriptPath = "flux_bench.fluxscript";
+
+void writeScript() {
+    std::ofstream file(kScriptPath);
+    file << "param drive 0 10 2\n"
+            "param mix 0 1 0.5\n"
+            "process:\n"
+            "in drive * tanh mix * = out\n";
+}
+
+std::vector<NodeBench> allNodes() {
+    return {
+        plugin<TubeP_EQ>("TubeP_EQ"),
+        plugin<ConsoleE_EQ>("ConsoleE_EQ"),
+        plugin<VintageG_EQ>("VintageG_EQ"),
+        plugin<Graphic10_EQ>("Graphic10_EQ"),
+        plugin<AirLift_EQ>("AirLift_EQ"),
+        plugin<Opto2A>("Opto2A"),
+        plugin<FET76>("FET76"),
+        plugin<VCABus>("VCABus"),
+        plugin<VariMu>("VariMu"),
+        plugin<SteelPlate>("SteelPlate"),
+        plugin<GoldenHall>("GoldenHall"),
+        plugin<CopperSpring>("CopperSpring"),
+        plugin<Cathedral>("Cathedral"),
+        plugin<GrainVerb>("GrainVerb"),
+        plugin<EchoPlex>("EchoPlex"),
+        plugin<BBD_Bucket>("BBD_Bucket"),
+        plugin<Reverse_Delay>("Reverse_Delay"),
+        plugin<PingPong_Delay>("PingPong_Delay"),
+        plugin<SpaceShift>("SpaceShift"),
+        plugin<TubeLimiter>("TubeLimiter"),
+        plugin<FluxSpectrumAnalyzer>("FluxSpectrumAnalyzer"),
+        plugin<FluxLoudnessMeter>("FluxLoudnessMeter"),
+        plugin<FluxGainNode>("FluxGainNode"),
+        plugin<FluxFilterNode>("FluxFilterNode"),
+        plugin<FluxDelayNode>("FluxDelayNode"),
+        plugin<TubeCompressorNode>("TubeCompressorNode"),
+        plugin<SineSynthNode>("SineSynthNode"),
+        { "MasterNode", [](int block, float) { return std::make_shared<MasterNode>(block); } },
+        { "FluxScriptNode", [](int block, float sr) { return std::make_shared<FluxScriptNode>(kScriptPath, block, sr); } },
+    };
+}
+
+/**
+ * Times one node at one configuration: `repeats` runs of at least `minTimeMs`,
+ * after a half-second warm-up that fills delay lines and settles envelopes.
+ * Only process() is timed; refilling the input is not.
+ */
+BenchResult measure(const NodeBench& bench, int tier, float sampleRate, int blockFrames,
+                    const BenchOptions& options, PerfCounters& counters) {
+    auto node = bench.create(blockFrames, sampleRate);
+    node->prepare(sampleRate, blockFrames);
+    node->setQualityTier(tier);
+
+    MIDIBuffer noteOn;
+    noteOn.addEvent({ 0, (uint8_t)MIDIStatus::NoteOn, 57, 100 });
+    node->processMIDI(noteOn);
+
+    TestSignal signal(sampleRate);
+    float* input = node->getInputPorts().empty() ? nullptr : node->getInputBuffer(0);
+    const float* output = node->getNumOutputBuffers() > 0 ? node->getOutputBuffer(0) : nullptr;
+    auto runBlock = [&]() -> uint64_t {
+        if (input) signal.read(input, blockFrames);
+        const uint64_t start = benchNowNs();
+        node->process(blockFrames);
+        const uint64_t elapsed = benchNowNs() - start;
+        benchDoNotOptimize(output ? output : input);
+        return elapsed;
+    };
+
+    const int warmupBlocks = (std::max)(1, (int)(sampleRate * 0.5f) / blockFrames);
+    for (int i = 0; i < warmupBlocks; ++i) runBlock();
+
+    std::vector<double> nsPerSample, ipc;
+    uint64_t totalBlocks = 0;
+    const uint64_t minNs = (uint64_t)(options.minTimeMs * 1e6);
+    for (int r = 0; r < options.repeats; ++r) {
+        uint64_t processNs = 0, blocks = 0;
+        const uint64_t wallStart = benchNowNs();
+        counters.start();
+        while (benchNowNs() - wallStart < minNs || blocks < 16) {
+            processNs += runBlock();
+            ++blocks;
+        }
+        counters.stop();
+        nsPerSample.push_back((double)processNs / (double)(blocks * blockFrames));
+        if (counters.getIPC() >= 0.0) ipc.push_back(counters.getIPC());
+        totalBlocks += blocks;
+    }
+
+    BenchResult result;
+    result.name = bench.name + (tier > 0 ? "/q" + std::to_string(tier) : "");
+    result.sampleRate = (int)sampleRate;
+    result.blockFrames = blockFrames;
+    result.nsPerSample = benchMedian(nsPerSample);
+    result.realtimeFactor = result.nsPerSample > 0.0 ? (1e9 / sampleRate) / result.nsPerSample : 0.0;
+    result.ipc = ipc.empty() ? -1.0 : benchMedian(ipc);
+    result.iterations = totalBlocks;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!options.parse(argc, argv)) return 2;
+
+    const std::vector<float> sampleRates = options.quick ? std::vector<float>{ 48000.0f }
+                                                         : std::vector<float>{ 44100.0f, 48000.0f, 96000.0f };
+    const std::vector<int> blockSizes = options.quick ? std::vector<int>{ 256 }
+                                                      : std::vector<int>{ 32, 128, 512, 2048 };
+
+    writeScript();
+    PerfCounters counters;
+    std::cout << "flux_bench: " << (counters.isAvailable() ? "CPU counters available" : "CPU counters unavailable, no IPC")
+              << ", " << options.repeats << " x " << options.minTimeMs << " ms per configuration" << std::endl;
+
+    BenchReport report("flux_bench");
+    for (const NodeBench& bench : allNodes()) {
+        if (!options.matches(bench.name)) continue;
+        // Cheaper quality tiers are what the LoadGovernor falls back to; measure them too.
+        const int tiers = bench.create(blockSizes.front(), sampleRates.front())->getNumQualityTiers();
+        for (int tier = 0; tier < tiers; ++tier) {
+            for (float sampleRate : sampleRates) {
+                for (int blockFrames : blockSizes) {
+                    report.add(measure(bench, tier, sampleRate, blockFrames, options, counters));
+                }
+            }
+        }
+    }
+    std::remove(kScriptPath);
+
+    return report.finish(options);
+}
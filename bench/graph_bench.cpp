@@ -0,0 +1,273 @@
+#include "bench_common.hpp"
+#include "../src/engine/audio_engine.hpp"
+#include "../src/engine/flux_fx_nodes.hpp"
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+
+// Graph-engine scaling: synthetic topologies from 10 to 10,000 nodes. For each
+// it measures FluxGraph::compile(), the engine's plan rebuild, a single edit,
+// the steady-state block through AudioEngine::renderBlock() (the device-less
+// half of process()), plan memory and, across topologies, the cost of one
+// route. Nodes are FluxGainNodes, so the block time is mostly the scheduler,
+// router and buffer clears rather than DSP. `--stages N` compiles pipelined plans.
+
+using namespace Beam;
+
+namespace {
+
+const int kSampleRate = 48000;
+const int kBlockFrames = 256;
+const int kChannels = 2;
+
+struct Topology {
+    std::string name;
+    // Adds `count` nodes and their connections; anything without a destination goes to `master`.
+    std::function<void(GraphTransaction&, size_t master, int count, std::vector<size_t>& ids)> build;
+};
+
+std::shared_ptr<FluxNode> makeNode() {
+    return std::make_shared<FluxGainNode>(kBlockFrames, (float)kSampleRate);
+}
+
+std::vector<Topology> allTopologies() {
+    return {
+        // N parallel tracks summed into the master
+        { "wide", [](GraphTransaction& tx, size_t master, int count, std::vector<size_t>& ids) {
+            for (int i = 0; i < count; ++i) {
+                ids.push_back(tx.addNode(makeNode()));
+                tx.connect(ids.back(), 0, master, 0);
+            }
+        } },
+        // One serial chain
+        { "deep", [](GraphTransaction& tx, size_t master, int count, std::vector<size_t>& ids) {
+            for (int i = 0; i < count; ++i) {
+                ids.push_back(tx.addNode(makeNode()));
+                if (i > 0) tx.connect(ids[i - 1], 0, ids[i], 0);
+            }
+            tx.connect(ids.back(), 0, master, 0);
+        } },
+        // Every track into one bus
+        { "fanin", [](GraphTransaction& tx, size_t master, int count, std::vector<size_t>& ids) {
+            const size_t bus = tx.addNode(makeNode());
+            ids.push_back(bus);
+            for (int i = 1; i < count; ++i) {
+                ids.push_back(tx.addNode(makeNode()));
+                tx.connect(ids.back(), 0, bus, 0);
+            }
+            tx.connect(bus, 0, master, 0);
+        } },
+        // Each node fed by up to three random earlier ones; sinks go to the master
+        { "random", [](GraphTransaction& tx, size_t master, int count, std::vector<size_t>& ids) {
+            std::mt19937 rng(0x5EEDu + (unsigned)count);
+            std::vector<bool> hasOutput(count, false);
+            for (int i = 0; i < count; ++i) {
+                ids.push_back(tx.addNode(makeNode()));
+                const int inputs = i == 0 ? 0 : (int)(rng() % 4);
+                std::set<int> sources;
+                for (int k = 0; k < inputs; ++k) sources.insert((int)(rng() % i));
+                for (int s : sources) {
+                    tx.connect(ids[s], 0, ids[i], 0);
+                    hasOutput[s] = true;
+                }
+            }
+            for (int i = 0; i < count; ++i) {
+                if (!hasOutput[i]) tx.connect(ids[i], 0, master, 0);
+            }
+        } },
+    };
+}
+
+size_t planBytes(const RenderPlan& plan) {
+    size_t bytes = sizeof(RenderPlan) + plan.sequence.capacity() * sizeof(NodeExecution) +
+                   plan.clearOps.capacity() * sizeof(RenderPlan::BufferClearOp);
+    for (const auto& exec : plan.sequence) {
+        bytes += exec.outgoingRoutes.capacity() * sizeof(SignalRoute);
+        if (exec.name.capacity() > 15) bytes += exec.name.capacity() + 1; // Beyond the small-string buffer
+    }
+    return bytes;
+}
+
+size_t bufferBytes(const std::map<size_t, std::shared_ptr<FluxNode>>& nodes) {
+    size_t bytes = 0;
+    for (const auto& [id, node] : nodes) {
+        const size_t ports = node->getInputPorts().size() + (size_t)node->getNumOutputBuffers();
+        bytes += ports * (size_t)node->getMaxBlockFrames() * kChannels * sizeof(float);
+    }
+    return bytes;
+}
+
+template <typename Fn>
+double medianNs(int repeats, Fn&& fn) {
+    std::vector<double> samples;
+    for (int r = 0; r < repeats; ++r) {
+        const uint64_t start = benchNowNs();
+        fn();
+        samples.push_back((double)(benchNowNs() - start));
+    }
+    return benchMedian(samples);
+}
+
+struct Measured {
+    double compileNs = 0.0;
+    double blockNs = 0.0;
+    size_t routes = 0;
+};
+
+Measured measure(const Topology& topology, int count, int stages, const BenchOptions& options, BenchReport& report) {
+    AudioEngine engine;
+    engine.prepare(kSampleRate, kChannels, kBlockFrames);
+    engine.setRenderAhead(false); // Time the whole graph in the real-time pass
+
+    auto graph = std::make_shared<FluxGraph>();
+    engine.setGraph(graph);
+    const size_t master = graph->getNodes().begin()->first;
+
+    GraphTransaction tx(*graph);
+    std::vector<size_t> ids;
+    topology.build(tx, master, count, ids);
+    const uint64_t buildStart = benchNowNs();
+    tx.commit();
+    const double buildNs = (double)(benchNowNs() - buildStart);
+
+    // Automation on every tenth node, as on a mixed session
+    std::vector<std::shared_ptr<AutomationLane>> lanes;
+    for (size_t i = 0; i < ids.size(); i += 10) {
+        lanes.push_back(std::make_shared<AutomationLane>(graph->getNode(ids[i])->getParameter("Gain")));
+        lanes.back()->addPoint(0, 0.5f);
+        lanes.back()->addPoint((size_t)kSampleRate, 1.0f);
+    }
+    engine.addAutomationLanes(lanes);
+    if (stages > 1) engine.setPipelineStages(stages);
+
+    const int repeats = (std::max)(options.repeats, 3);
+    std::shared_ptr<RenderPlan> plan;
+    const double compileNs = medianNs(repeats, [&]() { plan = graph->compile(kBlockFrames, kChannels, stages); });
+    const double updateNs = medianNs(repeats, [&]() { engine.updatePlan(); });
+
+    // One connect and its undo against the full graph
+    const size_t extra = graph->addNode(makeNode());
+    const double editNs = medianNs(repeats, [&]() {
+        graph->connect(extra, 0, master, 0);
+        graph->disconnect(extra, 0, master, 0);
+    }) / 2.0;
+    graph->removeNode(extra);
+    engine.updatePlan();
+
+    size_t routes = 0;
+    for (const auto& exec : plan->sequence) routes += exec.outgoingRoutes.size();
+
+    engine.setPlaying(true);
+    std::vector<float> output((size_t)kBlockFrames * kChannels);
+    for (int i = 0; i < 20; ++i) engine.renderBlock(output.data(), kBlockFrames);
+
+    std::vector<double> blockNs;
+    uint64_t totalBlocks = 0;
+    const uint64_t minNs = (uint64_t)(options.minTimeMs * 1e6);
+    for (int r = 0; r < options.repeats; ++r) {
+        uint64_t elapsed = 0, blocks = 0;
+        while (elapsed < minNs || blocks < 8) {
+            const uint64_t start = benchNowNs();
+            engine.renderBlock(output.data(), kBlockFrames);
+            elapsed += benchNowNs() - start;
+            ++blocks;
+        }
+        blockNs.push_back((double)elapsed / (double)blocks);
+        totalBlocks += blocks;
+    }
+    const double block = benchMedian(blockNs);
+    benchDoNotOptimize(output.data());
+    engine.setPlaying(false);
+
+    const std::string suffix = topology.name + "/" + std::to_string(count) + (stages > 1 ? "/s" + std::to_string(stages) : "");
+    const size_t nodes = (size_t)count + 1;
+
+    BenchResult compile;
+    compile.name = "compile/" + suffix;
+    compile.sampleRate = kSampleRate;
+    compile.blockFrames = kBlockFrames;
+    compile.nsPerSample = compileNs / (double)nodes; // Per node
+    compile.iterations = (uint64_t)repeats;
+    compile.metrics = {
+        { "compileUs", compileNs / 1e3 }, { "updatePlanUs", updateNs / 1e3 }, { "editUs", editNs / 1e3 },
+        { "buildMs", buildNs / 1e6 }, { "planKB", planBytes(*plan) / 1024.0 },
+        { "planBytesPerNode", (double)planBytes(*plan) / (double)nodes },
+        { "bufferKB", bufferBytes(graph->getNodes()) / 1024.0 }, { "routes", (double)routes }
+    };
+    report.add(compile);
+
+    BenchResult process;
+    process.name = "process/" + suffix;
+    process.sampleRate = kSampleRate;
+    process.blockFrames = kBlockFrames;
+    process.nsPerSample = block / kBlockFrames;
+    process.realtimeFactor = (kBlockFrames * 1e9 / kSampleRate) / block;
+    process.iterations = totalBlocks;
+    process.metrics = { { "blockUs", block / 1e3 }, { "nsPerNode", block / (double)nodes } };
+    report.add(process);
+
+    return { compileNs, block, routes };
+}
+
+// Growth exponent of `cost` between the smallest and largest size: 1 is linear.
+double exponent(int smallN, double smallCost, int largeN, double largeCost) {
+    if (smallCost <= 0.0 || largeN == smallN) return 0.0;
+    return std::log(largeCost / smallCost) / std::log((double)largeN / (double)smallN);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    options.declare("stages", "N", "Compile into N pipeline stages (default 1)");
+    if (!options.parse(argc, argv)) return 2;
+    const int stages = std::atoi(options.get("stages", "1").c_str());
+
+    const std::vector<int> sizes = options.quick ? std::vector<int>{ 10, 1000 }
+                                                 : std::vector<int>{ 10, 100, 1000, 10000 };
+
+    std::cout << "graph_bench: " << kSampleRate << " Hz, " << kBlockFrames << " frames, "
+              << stages << " stage(s), block time is the median of " << options.repeats << " runs" << std::endl;
+
+    BenchReport report("graph_bench");
+    std::map<std::string, std::map<int, Measured>> measured;
+    for (const Topology& topology : allTopologies()) {
+        for (int count : sizes) {
+            if (!options.matches(topology.name + "/" + std::to_string(count))) continue;
+            measured[topology.name][count] = measure(topology, count, stages, options, report);
+        }
+    }
+
+    // Same node count, different route counts: the block time difference is the routing.
+    if (measured.count("wide") && measured.count("random")) {
+        for (int count : sizes) {
+            if (!measured["wide"].count(count) || !measured["random"].count(count)) continue;
+            const Measured& wide = measured["wide"][count];
+            const Measured& random = measured["random"][count];
+            if (random.routes <= wide.routes) continue;
+            BenchResult route;
+            route.name = "route/" + std::to_string(count);
+            route.sampleRate = kSampleRate;
+            route.blockFrames = kBlockFrames;
+            route.nsPerSample = (std::max)(0.0, random.blockNs - wide.blockNs) / (double)(random.routes - wide.routes) / kBlockFrames;
+            route.metrics = { { "nsPerRouteBlock", route.nsPerSample * kBlockFrames } };
+            report.add(route);
+        }
+    }
+
+    std::cout << "\nScaling from " << sizes.front() << " to " << sizes.back() << " nodes (1.0 = linear):" << std::endl;
+    for (const auto& [name, bySize] : measured) {
+        if (bySize.size() < 2) continue;
+        const auto& [smallN, small] = *bySize.begin();
+        const auto& [largeN, large] = *bySize.rbegin();
+        const double compileExp = exponent(smallN, small.compileNs, largeN, large.compileNs);
+        const double processExp = exponent(smallN, small.blockNs, largeN, large.blockNs);
+        std::cout << "  " << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(2)
+                  << " compile " << compileExp << (compileExp > 1.25 ? " SUPERLINEAR" : "")
+                  << ", process " << processExp << (processExp > 1.25 ? " SUPERLINEAR" : "")
+                  << std::defaultfloat << std::endl;
+    }
+
+    return report.finish(options);
+}
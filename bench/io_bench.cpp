@@ -0,0 +1,598 @@
+#include "bench_common.hpp"
+#include "../src/engine/audio_reader.hpp"
+#include "../src/engine/wav_reader.hpp"
+#include "../src/engine/disk_streamer.hpp"
+#include "../src/engine/peak_pyramid.hpp"
+#include "../src/engine/pcm_encoder.hpp"
+#include "../src/engine/recording_writer.hpp"
+#include "../src/engine/transcode_cache.hpp"
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Disk I/O: builds a corpus of temporary files, then measures for 1 to 256
+// tracks the sustained read throughput and worst read latency of AudioReader,
+// WavReader and raw reads, real-time playback through DiskStreamer (block
+// latency, underruns), seek-to-first-served-block, peak pyramid generation per hour
+// of audio, and recording write throughput. FLAC and MP3 are included when
+// ffmpeg is on the PATH or the corpus directory already holds such files.
+//
+// --cold 1 evicts the corpus from the page cache before every measurement
+// (Linux: posix_fadvise, plus /proc/sys/vm/drop_caches when permitted) and
+// opens raw reads with O_DIRECT. Use --files at least as large as the track
+// count, or later tracks re-read files an earlier track just cached.
+
+using namespace Beam;
+namespace fs = std::filesystem;
+
+namespace {
+
+const int kSampleRate = 48000;
+const int kChannels = 2;
+const size_t kReadChunkFrames = 4096; // The DiskStreamer prefetch chunk
+const int kBlockFrames = 256;
+
+struct Settings {
+    fs::path dir;
+    int files = 16;
+    double fileSeconds = 20.0;
+    double readSeconds = 5.0;   // Per track, for the flat-out reads
+    double pacedSeconds = 2.0;  // Real-time playback and recording
+    bool cold = false;
+    std::vector<int> trackCounts;
+};
+
+struct Corpus {
+    std::string format; // wav16, wav32f, flac, mp3
+    std::vector<std::string> paths;
+    uint64_t bytes = 0;
+    uint64_t frames = 0; // Per file
+
+    double bytesPerFrame() const { return frames ? (double)bytes / (double)(frames * paths.size()) : 0.0; }
+    const std::string& pathFor(int track) const { return paths[(size_t)track % paths.size()]; }
+};
+
+// --- Corpus -----------------------------------------------------------------
+
+bool writeWav(const std::string& path, PcmFormat format, double seconds, unsigned seed) {
+    PcmEncoder encoder;
+    PcmEncoder::Options options;
+    options.async = false;
+    if (!encoder.open(path, kSampleRate, kChannels, format, options)) return false;
+    TestSignal signal((float)kSampleRate, 3.0f + (float)(seed % 5)); // Files differ in content
+    std::vector<float> block(kReadChunkFrames * kChannels);
+    const size_t total = (size_t)(seconds * kSampleRate);
+    for (size_t done = 0; done < total; done += kReadChunkFrames) {
+        const size_t frames = (std::min)(kReadChunkFrames, total - done);
+        signal.read(block.data(), (int)frames);
+        if (!encoder.write(block.data(), frames)) return false;
+    }
+    return encoder.close();
+}
+
+uint64_t totalBytes(const std::vector<std::string>& paths) {
+    uint64_t bytes = 0;
+    std::error_code ec;
+    for (const auto& path : paths) bytes += fs::file_size(path, ec);
+    return bytes;
+}
+
+uint64_t framesOf(const std::string& path) {
+    AudioReader reader;
+    return reader.open(path, kChannels) ? reader.getTotalFrames() : 0;
+}
+
+std::vector<Corpus> buildCorpus(const Settings& settings) {
+    std::vector<Corpus> corpora;
+    fs::create_directories(settings.dir);
+
+    for (auto [name, format] : { std::pair<const char*, PcmFormat>{ "wav16", PcmFormat::Int16 },
+                                 std::pair<const char*, PcmFormat>{ "wav32f", PcmFormat::Float32 } }) {
+        Corpus corpus;
+        corpus.format = name;
+        for (int i = 0; i < settings.files; ++i) {
+            const std::string path = (settings.dir / (std::string(name) + "_" + std::to_string(i) + ".wav")).string();
+            std::error_code ec;
+            const bool reuse = fs::exists(path, ec) && framesOf(path) == (uint64_t)(settings.fileSeconds * kSampleRate);
+            if (!reuse && !writeWav(path, format, settings.fileSeconds, (unsigned)i)) {
+                std::cerr << "io_bench: cannot write " << path << std::endl;
+                return {};
+            }
+            corpus.paths.push_back(path);
+        }
+        corpus.frames = framesOf(corpus.paths.front());
+        corpus.bytes = totalBytes(corpus.paths);
+        corpora.push_back(corpus);
+    }
+
+    // Compressed formats: files already in the directory, or transcodes of the 16-bit corpus.
+    const bool haveFfmpeg = std::system("ffmpeg -version > /dev/null 2>&1") == 0;
+    for (const char* ext : { "flac", "mp3" }) {
+        Corpus corpus;
+        corpus.format = ext;
+        for (int i = 0; i < settings.files; ++i) {
+            const std::string path = (settings.dir / ("wav16_" + std::to_string(i) + "." + ext)).string();
+            std::error_code ec;
+            if (!fs::exists(path, ec) && haveFfmpeg) {
+                const std::string command = "ffmpeg -loglevel error -y -i \"" + corpora.front().paths[(size_t)i] + "\" \"" + path + "\"";
+                if (std::system(command.c_str()) != 0) continue;
+            }
+            if (fs::exists(path, ec)) corpus.paths.push_back(path);
+        }
+        if (corpus.paths.empty()) {
+            std::cout << "io_bench: no " << ext << " corpus (install ffmpeg or put wav16_<n>." << ext
+                      << " files in " << settings.dir.string() << ")" << std::endl;
+            continue;
+        }
+        corpus.frames = framesOf(corpus.paths.front());
+        corpus.bytes = totalBytes(corpus.paths);
+        corpora.push_back(corpus);
+    }
+    return corpora;
+}
+
+// --- Cold cache ---------------------------------------------------------------
+
+void evict(const std::vector<std::string>& paths) {
+#if defined(__linux__)
+    ::sync();
+    {
+        std::ofstream dropCaches("/proc/sys/vm/drop_caches");
+        if (dropCaches) dropCaches << "1\n"; // Needs root; the fadvise below works without
+    }
+    for (const auto& path : paths) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)paths;
+#endif
+}
+
+void prepareCache(const Settings& settings, const Corpus& corpus) {
+    if (settings.cold) evict(corpus.paths);
+}
+
+// --- Measurements ---------------------------------------------------------------
+
+struct LatencySamples {
+    std::vector<double> ns;
+
+    void add(uint64_t value) { ns.push_back((double)value); }
+    double percentile(double p) {
+        if (ns.empty()) return 0.0;
+        std::sort(ns.begin(), ns.end());
+        return ns[(size_t)((ns.size() - 1) * p)];
+    }
+    double max() { return ns.empty() ? 0.0 : *std::max_element(ns.begin(), ns.end()); }
+    double mean() const {
+        double sum = 0.0;
+        for (double v : ns) sum += v;
+        return ns.empty() ? 0.0 : sum / (double)ns.size();
+    }
+};
+
+BenchResult makeResult(const std::string& name, int blockFrames) {
+    BenchResult result;
+    result.name = name;
+    result.sampleRate = kSampleRate;
+    result.blockFrames = blockFrames;
+    return result;
+}
+
+// Round-robin reads of kReadChunkFrames per track, as the I/O thread does, until each
+// track has read `readSeconds` (or its whole file).
+template <typename Reader, typename OpenFn, typename ReadFn>
+BenchResult measureReads(const std::string& name, const Corpus& corpus, int tracks, const Settings& settings,
+                         OpenFn&& openReader, ReadFn&& readChunk) {
+    prepareCache(settings, corpus);
+    std::vector<std::unique_ptr<Reader>> readers;
+    for (int t = 0; t < tracks; ++t) {
+        readers.push_back(std::make_unique<Reader>());
+        if (!openReader(*readers.back(), corpus.pathFor(t))) {
+            std::cerr << "io_bench: cannot open " << corpus.pathFor(t) << std::endl;
+            return makeResult(name, (int)kReadChunkFrames);
+        }
+    }
+
+    std::vector<float> buffer(kReadChunkFrames * kChannels);
+    const uint64_t perTrack = (std::min)(corpus.frames, (uint64_t)(settings.readSeconds * kSampleRate));
+    LatencySamples latency;
+    uint64_t frames = 0;
+    const uint64_t start = benchNowNs();
+    for (uint64_t done = 0; done < perTrack; done += kReadChunkFrames) {
+        for (auto& reader : readers) {
+            const uint64_t t0 = benchNowNs();
+            frames += readChunk(*reader, buffer.data(), (size_t)(std::min)((uint64_t)kReadChunkFrames, perTrack - done));
+            latency.add(benchNowNs() - t0);
+        }
+    }
+    const double elapsed = (double)(benchNowNs() - start);
+    benchDoNotOptimize(buffer.data());
+
+    BenchResult result = makeResult(name, (int)kReadChunkFrames);
+    result.nsPerSample = frames ? elapsed / (double)frames : 0.0;
+    result.realtimeFactor = elapsed > 0.0 ? ((double)frames / kSampleRate) / (elapsed / 1e9) : 0.0; // Tracks sustainable
+    result.iterations = latency.ns.size();
+    result.metrics = {
+        { "MBps", (double)frames * corpus.bytesPerFrame() / (elapsed / 1e9) / 1e6 },
+        { "p99ReadUs", latency.percentile(0.99) / 1e3 }, { "maxReadUs", latency.max() / 1e3 }
+    };
+    return result;
+}
+
+// Plain read() in 1 MiB chunks, O_DIRECT in cold mode: the storage ceiling for the decoders.
+BenchResult measureRaw(const Corpus& corpus, int tracks, const Settings& settings) {
+    const std::string name = "raw/" + corpus.format + "/" + std::to_string(tracks);
+#if defined(__linux__)
+    prepareCache(settings, corpus);
+    const size_t chunk = 1 << 20;
+    void* aligned = nullptr;
+    if (posix_memalign(&aligned, 4096, chunk) != 0) return makeResult(name, 0);
+    std::unique_ptr<void, decltype(&std::free)> buffer(aligned, &std::free);
+
+    bool direct = settings.cold;
+    std::vector<int> fds;
+    for (int t = 0; t < tracks; ++t) {
+        int fd = direct ? ::open(corpus.pathFor(t).c_str(), O_RDONLY | O_DIRECT) : -1;
+        if (fd < 0) {
+            direct = false; // e.g. tmpfs does not support O_DIRECT
+            fd = ::open(corpus.pathFor(t).c_str(), O_RDONLY);
+        }
+        fds.push_back(fd);
+    }
+
+    const uint64_t perTrack = (uint64_t)((double)corpus.bytes / (double)corpus.paths.size() *
+                                         (std::min)(1.0, settings.readSeconds * kSampleRate / (double)corpus.frames));
+    LatencySamples latency;
+    uint64_t bytes = 0;
+    const uint64_t start = benchNowNs();
+    for (uint64_t done = 0; done < perTrack; done += chunk) {
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            const uint64_t t0 = benchNowNs();
+            const ssize_t got = ::read(fd, buffer.get(), chunk);
+            latency.add(benchNowNs() - t0);
+            if (got > 0) bytes += (uint64_t)got;
+        }
+    }
+    const double elapsed = (double)(benchNowNs() - start);
+    for (int fd : fds) if (fd >= 0) ::close(fd);
+
+    BenchResult result = makeResult(name, (int)(chunk / (kChannels * sizeof(float))));
+    const double frames = (double)bytes / corpus.bytesPerFrame();
+    result.nsPerSample = frames > 0.0 ? elapsed / frames : 0.0;
+    result.realtimeFactor = elapsed > 0.0 ? (frames / kSampleRate) / (elapsed / 1e9) : 0.0;
+    result.iterations = latency.ns.size();
+    result.metrics = {
+        { "MBps", (double)bytes / (elapsed / 1e9) / 1e6 }, { "oDirect", direct ? 1.0 : 0.0 },
+        { "p99ReadUs", latency.percentile(0.99) / 1e3 }, { "maxReadUs", latency.max() / 1e3 }
+    };
+    return result;
+#else
+    (void)corpus; (void)tracks; (void)settings;
+    return makeResult(name, 0);
+#endif
+}
+
+// Real-time playback: every block, each track's readTimeline() on the "audio thread",
+// paced to the wall clock while the shared I/O thread prefetches.
+BenchResult measureStreaming(const Corpus& corpus, int tracks, const Settings& settings) {
+    prepareCache(settings, corpus);
+    std::vector<std::unique_ptr<DiskStreamer>> streamers;
+    for (int t = 0; t < tracks; ++t) {
+        streamers.push_back(std::make_unique<DiskStreamer>());
+        streamers.back()->open(corpus.pathFor(t), kChannels);
+        streamers.back()->seek(0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Prefetch head start, as on play
+
+    std::vector<float> buffer((size_t)kBlockFrames * kChannels);
+    const auto blockDuration = std::chrono::nanoseconds((int64_t)(kBlockFrames * 1e9 / kSampleRate));
+    const int blocks = (int)(settings.pacedSeconds * kSampleRate / kBlockFrames);
+    LatencySamples latency;
+    auto next = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; ++b) {
+        const uint64_t frame = (uint64_t)b * kBlockFrames;
+        const uint64_t t0 = benchNowNs();
+        for (auto& streamer : streamers) streamer->readTimeline(buffer.data(), kBlockFrames, kChannels, frame);
+        latency.add(benchNowNs() - t0);
+        next += blockDuration;
+        std::this_thread::sleep_until(next);
+    }
+
+    uint64_t underruns = 0;
+    for (auto& streamer : streamers) underruns += streamer->getUnderrunCount();
+    streamers.clear();
+
+    const double budget = (double)blockDuration.count();
+    BenchResult result = makeResult("stream/" + corpus.format + "/" + std::to_string(tracks), kBlockFrames);
+    result.nsPerSample = latency.mean() / (double)(kBlockFrames * tracks);
+    result.realtimeFactor = latency.mean() > 0.0 ? budget / latency.mean() : 0.0;
+    result.iterations = (uint64_t)blocks;
+    result.metrics = {
+        { "p99BlockUs", latency.percentile(0.99) / 1e3 }, { "maxBlockUs", latency.max() / 1e3 },
+        { "maxBudgetPct", latency.max() / budget * 100.0 },
+        { "underrunPct", 100.0 * (double)underruns / (double)((uint64_t)blocks * tracks) }
+    };
+    return result;
+}
+
+// Seek to a random position and time until the prefetch ring serves the block there:
+// the silence playback has after a seek. The audio thread never reads from disk, so a
+// block it misses only costs it a fill; a raw reader seek and read is the baseline.
+BenchResult measureSeeks(const Corpus& corpus, const Settings& settings) {
+    prepareCache(settings, corpus);
+    const int seeks = 32;
+    std::mt19937 rng(7);
+    std::vector<float> buffer((size_t)kBlockFrames * kChannels);
+
+    LatencySamples firstServed, audioCall, readerSeek;
+    uint64_t timeouts = 0;
+    AudioReader reader;
+    reader.open(corpus.paths.front(), kChannels);
+    DiskStreamer streamer;
+    streamer.open(corpus.paths.back(), kChannels);
+    const uint64_t span = corpus.frames > (uint64_t)kSampleRate ? corpus.frames - kSampleRate : 1;
+
+    for (int i = 0; i < seeks; ++i) {
+        if (settings.cold && i % 8 == 0) evict(corpus.paths);
+
+        const size_t target = (size_t)(rng() % span);
+        uint64_t t0 = benchNowNs();
+        reader.seek(target);
+        reader.readFrames(buffer.data(), kBlockFrames, kChannels);
+        readerSeek.add(benchNowNs() - t0);
+
+        t0 = benchNowNs();
+        streamer.seek(target);
+        const uint64_t t1 = benchNowNs();
+        streamer.readTimeline(buffer.data(), kBlockFrames, kChannels, target); // As the audio thread
+        audioCall.add(benchNowNs() - t1);
+        // The same block again, now waiting until the ring serves it.
+        const uint64_t underruns = streamer.getUnderrunCount();
+        streamer.readTimeline(buffer.data(), kBlockFrames, kChannels, target, true);
+        if (streamer.getUnderrunCount() != underruns) ++timeouts;
+        firstServed.add(benchNowNs() - t0);
+    }
+
+    BenchResult result = makeResult("seek/" + corpus.format, kBlockFrames);
+    result.nsPerSample = benchMedian(firstServed.ns); // Per seek
+    result.iterations = (uint64_t)seeks;
+    result.metrics = {
+        { "firstServedMaxUs", firstServed.max() / 1e3 }, { "timeouts", (double)timeouts },
+        { "audioCallMaxUs", audioCall.max() / 1e3 },
+        { "readerSeekP50Us", readerSeek.percentile(0.5) / 1e3 }, { "readerSeekMaxUs", readerSeek.max() / 1e3 }
+    };
+    return result;
+}
+
+BenchResult measurePeaks(const Corpus& corpus, const Settings& settings) {
+    prepareCache(settings, corpus);
+    const int files = (std::min)(4, (int)corpus.paths.size());
+    uint64_t frames = 0;
+    const uint64_t start = benchNowNs();
+    for (int i = 0; i < files; ++i) {
+        auto pyramid = PeakPyramid::build(corpus.paths[(size_t)i]);
+        if (pyramid) frames += pyramid->getTotalFrames();
+    }
+    const double elapsed = (double)(benchNowNs() - start);
+
+    BenchResult result = makeResult("peaks/" + corpus.format, (int)PeakPyramid::kBaseBinFrames);
+    result.nsPerSample = frames ? elapsed / (double)frames : 0.0;
+    result.realtimeFactor = elapsed > 0.0 ? ((double)frames / kSampleRate) / (elapsed / 1e9) : 0.0;
+    result.iterations = (uint64_t)files;
+    result.metrics = { { "msPerHour", result.nsPerSample * kSampleRate * 3600.0 / 1e6 } };
+    return result;
+}
+
+// Time from opening a compressed file until its PCM cache copy is ready.
+BenchResult measureImport(const Corpus& corpus, const Settings& settings) {
+    prepareCache(settings, corpus);
+    const fs::path cacheDir = settings.dir / ("transcode_" + corpus.format);
+    fs::remove_all(cacheDir);
+    fs::create_directories(cacheDir);
+    TranscodeCache::instance().setCacheDirectory(cacheDir.string());
+
+    const int files = (std::min)(4, (int)corpus.paths.size());
+    std::mutex mutex;
+    std::condition_variable cv;
+    int ready = 0;
+    const uint64_t start = benchNowNs();
+    for (int i = 0; i < files; ++i) {
+        TranscodeCache::instance().request(corpus.paths[(size_t)i], [&](const std::string&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++ready;
+            cv.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(120), [&]() { return ready == files; });
+    }
+    const double elapsed = (double)(benchNowNs() - start);
+
+    BenchResult result = makeResult("import/" + corpus.format, 0);
+    const double frames = (double)corpus.frames * ready;
+    result.nsPerSample = frames > 0.0 ? elapsed / frames : 0.0;
+    result.realtimeFactor = elapsed > 0.0 ? (frames / kSampleRate) / (elapsed / 1e9) : 0.0;
+    result.iterations = (uint64_t)ready;
+    result.metrics = { { "msPerHour", result.nsPerSample * kSampleRate * 3600.0 / 1e6 } };
+    return result;
+}
+
+// Flat-out encode and write of `tracks` takes through PcmEncoder, round-robin.
+BenchResult measureRecordingThroughput(int tracks, PcmFormat format, const Settings& settings) {
+    const std::string formatName = format == PcmFormat::Float32 ? "wav32f" : "wav16";
+    std::vector<std::unique_ptr<PcmEncoder>> encoders;
+    std::vector<std::string> paths;
+    for (int t = 0; t < tracks; ++t) {
+        paths.push_back((settings.dir / ("take_" + std::to_string(t) + ".wav")).string());
+        encoders.push_back(std::make_unique<PcmEncoder>());
+        encoders.back()->open(paths.back(), kSampleRate, kChannels, format);
+    }
+
+    TestSignal signal((float)kSampleRate);
+    std::vector<float> block(kReadChunkFrames * kChannels);
+    signal.read(block.data(), (int)kReadChunkFrames);
+    const uint64_t perTrack = (uint64_t)(settings.readSeconds * kSampleRate);
+    LatencySamples latency;
+    const uint64_t start = benchNowNs();
+    for (uint64_t done = 0; done < perTrack; done += kReadChunkFrames) {
+        for (auto& encoder : encoders) {
+            const uint64_t t0 = benchNowNs();
+            encoder->write(block.data(), kReadChunkFrames);
+            latency.add(benchNowNs() - t0);
+        }
+    }
+    for (auto& encoder : encoders) encoder->close();
+    const double elapsed = (double)(benchNowNs() - start);
+    for (const auto& path : paths) fs::remove(path);
+
+    const double frames = (double)perTrack * tracks;
+    BenchResult result = makeResult("record/" + formatName + "/" + std::to_string(tracks), (int)kReadChunkFrames);
+    result.nsPerSample = elapsed / frames;
+    result.realtimeFactor = (frames / kSampleRate) / (elapsed / 1e9);
+    result.iterations = latency.ns.size();
+    result.metrics = {
+        { "MBps", frames * kChannels * bytesPerSample(format) / (elapsed / 1e9) / 1e6 },
+        { "maxWriteUs", latency.max() / 1e3 }
+    };
+    return result;
+}
+
+// Real-time recording through RecordingWriter: does the writer keep the capture rings drained?
+BenchResult measureRecordingPaced(int tracks, const Settings& settings) {
+    std::vector<std::shared_ptr<RecordingStream>> streams;
+    std::vector<std::string> paths;
+    for (int t = 0; t < tracks; ++t) {
+        paths.push_back((settings.dir / ("take_" + std::to_string(t) + ".wav")).string());
+        streams.push_back(RecordingWriter::instance().open(paths.back(), kSampleRate, kChannels, PcmFormat::Int24));
+    }
+
+    TestSignal signal((float)kSampleRate);
+    std::vector<float> block((size_t)kBlockFrames * kChannels);
+    const auto blockDuration = std::chrono::nanoseconds((int64_t)(kBlockFrames * 1e9 / kSampleRate));
+    const int blocks = (int)(settings.pacedSeconds * kSampleRate / kBlockFrames);
+    LatencySamples latency;
+    auto next = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; ++b) {
+        signal.read(block.data(), kBlockFrames);
+        const uint64_t t0 = benchNowNs();
+        for (auto& stream : streams) if (stream) stream->push(block.data(), kBlockFrames);
+        latency.add(benchNowNs() - t0);
+        next += blockDuration;
+        std::this_thread::sleep_until(next);
+    }
+
+    double highWater = 0.0;
+    uint64_t dropped = 0;
+    const uint64_t closeStart = benchNowNs();
+    for (auto& stream : streams) {
+        if (!stream) continue;
+        highWater = (std::max)(highWater, (double)stream->getHighWaterFrames() / (double)stream->getCapacityFrames());
+        dropped += stream->getDroppedFrames();
+        RecordingWriter::instance().close(stream);
+    }
+    const double closeNs = (double)(benchNowNs() - closeStart);
+    for (const auto& path : paths) fs::remove(path);
+
+    BenchResult result = makeResult("record-rt/wav24/" + std::to_string(tracks), kBlockFrames);
+    result.nsPerSample = latency.mean() / (double)(kBlockFrames * tracks);
+    result.iterations = (uint64_t)blocks;
+    result.metrics = {
+        { "ringHighWaterPct", highWater * 100.0 }, { "droppedFrames", (double)dropped },
+        { "maxPushUs", latency.max() / 1e3 }, { "closeMs", closeNs / 1e6 }
+    };
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    options.declare("dir", "DIR", "Corpus directory, reused if it has the files (default: temp)");
+    options.declare("files", "N", "Files per format (default 16)");
+    options.declare("seconds", "S", "Length of each file (default 20, 6 with --quick)");
+    options.declare("paced", "S", "Real-time playback per track count (default 2, 0.5 with --quick)");
+    options.declare("cold", "0|1", "Evict the corpus from the page cache before each read (default 0)");
+    options.declare("keep", "0|1", "Keep the corpus afterwards (default 0)");
+    if (!options.parse(argc, argv)) return 2;
+
+    Settings settings;
+    settings.dir = options.get("dir", (fs::temp_directory_path() / "flux_io_bench").string());
+    settings.files = (std::max)(1, std::atoi(options.get("files", "16").c_str()));
+    settings.fileSeconds = std::atof(options.get("seconds", options.quick ? "6" : "20").c_str());
+    settings.readSeconds = (std::min)(settings.fileSeconds, options.quick ? 2.0 : 5.0);
+    settings.pacedSeconds = std::atof(options.get("paced", options.quick ? "0.5" : "2").c_str());
+    settings.cold = options.get("cold", "0") == "1";
+    settings.trackCounts = options.quick ? std::vector<int>{ 1, 16 } : std::vector<int>{ 1, 4, 16, 64, 256 };
+    const bool keep = options.get("keep", "0") == "1";
+
+    std::cout << "io_bench: corpus in " << settings.dir.string() << ", " << settings.files << " files of "
+              << settings.fileSeconds << " s per format, " << (settings.cold ? "cold" : "warm") << " cache" << std::endl;
+    if (settings.cold && settings.files < settings.trackCounts.back()) {
+        std::cout << "io_bench: fewer files than tracks; tracks beyond " << settings.files << " read warm data" << std::endl;
+    }
+
+    const std::vector<Corpus> corpora = buildCorpus(settings);
+    if (corpora.empty()) return 1;
+
+    BenchReport report("io_bench");
+    auto run = [&](const std::string& name, const std::function<BenchResult()>& measure) {
+        if (options.matches(name)) report.add(measure());
+    };
+
+    for (const Corpus& corpus : corpora) {
+        const bool compressed = TranscodeCache::isCompressed(corpus.paths.front());
+        for (int tracks : settings.trackCounts) {
+            const std::string suffix = corpus.format + "/" + std::to_string(tracks);
+            run("raw/" + suffix, [&]() { return measureRaw(corpus, tracks, settings); });
+            run("read/" + suffix, [&]() {
+                return measureReads<AudioReader>("read/" + suffix, corpus, tracks, settings,
+                    [](AudioReader& r, const std::string& path) { return r.open(path, kChannels); },
+                    [](AudioReader& r, float* out, size_t frames) { return r.readFrames(out, frames, kChannels); });
+            });
+            if (!compressed) {
+                run("wavreader/" + suffix, [&]() {
+                    return measureReads<WavReader>("wavreader/" + suffix, corpus, tracks, settings,
+                        [](WavReader& r, const std::string& path) { return r.open(path); },
+                        [](WavReader& r, float* out, size_t frames) {
+                            std::fill(out, out + frames * kChannels, 0.0f); // readFrames() mixes into the buffer
+                            return r.readFrames(out, frames, kChannels);
+                        });
+                });
+            }
+            run("stream/" + suffix, [&]() { return measureStreaming(corpus, tracks, settings); });
+        }
+        run("seek/" + corpus.format, [&]() { return measureSeeks(corpus, settings); });
+        run("peaks/" + corpus.format, [&]() { return measurePeaks(corpus, settings); });
+        if (compressed) run("import/" + corpus.format, [&]() { return measureImport(corpus, settings); });
+    }
+
+    for (int tracks : settings.trackCounts) {
+        for (PcmFormat format : { PcmFormat::Int16, PcmFormat::Float32 }) {
+            const std::string name = std::string("record/") + (format == PcmFormat::Float32 ? "wav32f/" : "wav16/") + std::to_string(tracks);
+            run(name, [&]() { return measureRecordingThroughput(tracks, format, settings); });
+        }
+        run("record-rt/wav24/" + std::to_string(tracks), [&]() { return measureRecordingPaced(tracks, settings); });
+    }
+
+    const int status = report.finish(options);
+    if (!keep) {
+        std::error_code ec;
+        fs::remove_all(settings.dir, ec);
+    }
+    return status;
+}
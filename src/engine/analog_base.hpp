@@ -66,6 +66,8 @@ public:
             m_rng.seed(std::random_device()());
         }
 
+        void setSampleRate(float sampleRate) { m_sampleRate = sampleRate; }
+
         void setIntensity(float wow, float flutter) {
             m_wowDepth = wow;
             m_flutterDepth = flutter;
@@ -18,9 +18,19 @@ namespace Beam {
 
 class SimpleReverb {
 public:
-    SimpleReverb(float sr) : m_sr(sr) {
-        m_buffer.resize((size_t)(sr * 0.5f), 0.0f);
+    SimpleReverb(float sr) {
+        prepare(sr);
     }
+
+    void prepare(float sr) {
+        m_sr = sr;
+        m_buffer.assign((size_t)(sr * 0.5f), 0.0f);
+        m_writePos = 0;
+        m_readPos = 1000;
+        m_clear = true;
+    }
+
+    void release() { RealtimeBuffer().swap(m_buffer); }
     
     void setParams(float size, float decay, float mix) {
         m_feedback = std::clamp(decay, 0.0f, 0.98f);
@@ -28,25 +38,66 @@ public:
     }
 
     float process(float in) {
+        return in * (1.0f - m_mix) + processWet(in) * m_mix;
+    }
+
+    /** @brief Feeds `in` into the tank and returns only the reverberated signal. */
+    float processWet(float in) {
         float out = m_buffer[m_readPos];
         float newVal = in + out * m_feedback;
         m_buffer[m_writePos] = newVal;
+        m_clear = false;
         
         if (++m_writePos >= m_buffer.size()) m_writePos = 0;
         if (++m_readPos >= m_buffer.size()) m_readPos = 0;
         
-        return in * (1.0f - m_mix) + out * m_mix;
+        return out;
+    }
+
+    /** @brief Empties the tank, so one left idle does not resume with an old tail. */
+    void clear() {
+        if (m_clear) return;
+        std::fill(m_buffer.begin(), m_buffer.end(), 0.0f);
+        m_clear = true;
     }
 
+    float getMix() const { return m_mix; }
+
+    void prefault() { RealtimeThread::prefault(m_buffer); }
+
 private:
     float m_sr;
-    std::vector<float> m_buffer;
+    RealtimeBuffer m_buffer;
     size_t m_writePos = 0;
     size_t m_readPos = 1000; 
     float m_feedback = 0.5f;
     float m_mix = 0.3f;
+    bool m_clear = true;
 };
 
+/**
+ * @brief Runs a reverb pair over an interleaved stereo block. Quality tier 1 feeds the
+ * mono sum through the left tank only and adds its wet signal to both sides, halving the
+ * cost; the dry signal stays stereo. The idle right tank is cleared on the way down, so
+ * it does not replay an old tail when full quality returns.
+ */
+inline void processReverbPair(SimpleReverb& l, SimpleReverb& r, const float* in, float* out, int total, int tier) {
+    if (tier > 0) {
+        r.clear();
+        const float mix = l.getMix();
+        for (int i = 0; i < total/2; ++i) {
+            float wet = mix * l.processWet(0.5f * (in[i*2] + in[i*2+1]));
+            out[i*2] = in[i*2] * (1.0f - mix) + wet;
+            out[i*2+1] = in[i*2+1] * (1.0f - mix) + wet;
+        }
+        return;
+    }
+    for (int i = 0; i < total/2; ++i) {
+        out[i*2] = l.process(in[i*2]);
+        out[i*2+1] = r.process(in[i*2+1]);
+    }
+}
+
 // ============================================================================
 // 1. EQUALIZERS
 // ============================================================================
@@ -74,6 +125,11 @@ public:
         m_highShelf->process(out, total / 2, 2);
         for (int i = 0; i < total; ++i) out[i] = AnalogBase::saturateLangevin(out[i], drive);
     }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_lowShelf->setSampleRate(sampleRate);
+        m_highShelf->setSampleRate(sampleRate);
+    }
 private:
     std::unique_ptr<BiquadFilterNode> m_lowShelf, m_highShelf;
 };
@@ -105,6 +161,13 @@ public:
         m_hmf->process(out, total / 2, 2);
         m_hf->process(out, total / 2, 2);
     }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_lf->setSampleRate(sampleRate);
+        m_lmf->setSampleRate(sampleRate);
+        m_hmf->setSampleRate(sampleRate);
+        m_hf->setSampleRate(sampleRate);
+    }
 private:
     std::unique_ptr<BiquadFilterNode> m_lf, m_lmf, m_hmf, m_hf;
 };
@@ -129,6 +192,12 @@ public:
         m_mid->process(out, total / 2, 2);
         m_high->process(out, total / 2, 2);
     }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_low->setSampleRate(sampleRate);
+        m_mid->setSampleRate(sampleRate);
+        m_high->setSampleRate(sampleRate);
+    }
 private:
     std::unique_ptr<BiquadFilterNode> m_low, m_mid, m_high;
 };
@@ -150,6 +219,11 @@ public:
         std::copy(in, in + total, out);
         for(auto& f : m_filters) f->process(out, total / 2, 2);
     }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        for (auto& f : m_filters) f->setSampleRate(sampleRate);
+    }
+
 private:
     std::vector<std::unique_ptr<BiquadFilterNode>> m_filters;
     std::vector<float> m_freqs;
@@ -170,6 +244,11 @@ public:
         m_lift->process(out, total / 2, 2);
         m_air->process(out, total / 2, 2);
     }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_air->setSampleRate(sampleRate);
+        m_lift->setSampleRate(sampleRate);
+    }
 private:
     std::unique_ptr<BiquadFilterNode> m_air, m_lift;
 };
@@ -283,10 +362,22 @@ public:
     void processBlock(const float* in, float* out, int total) override {
         m_l->setParams(1.0f, getParam("Decay")/5.0f, getParam("Mix"));
         m_r->setParams(1.0f, getParam("Decay")/5.0f, getParam("Mix"));
-        for (int i = 0; i < total/2; ++i) {
-            out[i*2] = m_l->process(in[i*2]);
-            out[i*2+1] = m_r->process(in[i*2+1]);
-        }
+        processReverbPair(*m_l, *m_r, in, out, total, getQualityTier());
+    }
+    int getNumQualityTiers() const override { return 2; } // 1: mono tank
+    void prefault() override {
+        FluxPlugin::prefault();
+        m_l->prefault();
+        m_r->prefault();
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_l->prepare(sampleRate);
+        m_r->prepare(sampleRate);
+    }
+    void onRelease() override {
+        m_l->release();
+        m_r->release();
     }
 private:
     std::unique_ptr<SimpleReverb> m_l, m_r;
@@ -303,10 +394,22 @@ public:
     void processBlock(const float* in, float* out, int total) override {
         m_l->setParams(getParam("Size"), 0.9f, getParam("Mix"));
         m_r->setParams(getParam("Size"), 0.9f, getParam("Mix"));
-        for(int i=0; i<total/2; ++i) {
-            out[i*2] = m_l->process(in[i*2]);
-            out[i*2+1] = m_r->process(in[i*2+1]);
-        }
+        processReverbPair(*m_l, *m_r, in, out, total, getQualityTier());
+    }
+    int getNumQualityTiers() const override { return 2; } // 1: mono tank
+    void prefault() override {
+        FluxPlugin::prefault();
+        m_l->prefault();
+        m_r->prefault();
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_l->prepare(sampleRate);
+        m_r->prepare(sampleRate);
+    }
+    void onRelease() override {
+        m_l->release();
+        m_r->release();
     }
 private:
     std::unique_ptr<SimpleReverb> m_l, m_r;
@@ -323,10 +426,22 @@ public:
     void processBlock(const float* in, float* out, int total) override {
         m_l->setParams(2.0f, 0.8f, getParam("Mix"));
         m_r->setParams(2.0f, 0.8f, getParam("Mix"));
-        for(int i=0; i<total/2; ++i) {
-            out[i*2] = m_l->process(in[i*2]);
-            out[i*2+1] = m_r->process(in[i*2+1]);
-        }
+        processReverbPair(*m_l, *m_r, in, out, total, getQualityTier());
+    }
+    int getNumQualityTiers() const override { return 2; } // 1: mono tank
+    void prefault() override {
+        FluxPlugin::prefault();
+        m_l->prefault();
+        m_r->prefault();
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_l->prepare(sampleRate);
+        m_r->prepare(sampleRate);
+    }
+    void onRelease() override {
+        m_l->release();
+        m_r->release();
     }
 private:
     std::unique_ptr<SimpleReverb> m_l, m_r;
@@ -343,10 +458,22 @@ public:
     void processBlock(const float* in, float* out, int total) override {
         m_l->setParams(10.0f, 0.98f, getParam("Mix"));
         m_r->setParams(10.0f, 0.98f, getParam("Mix"));
-        for(int i=0; i<total/2; ++i) {
-            out[i*2] = m_l->process(in[i*2]);
-            out[i*2+1] = m_r->process(in[i*2+1]);
-        }
+        processReverbPair(*m_l, *m_r, in, out, total, getQualityTier());
+    }
+    int getNumQualityTiers() const override { return 2; } // 1: mono tank
+    void prefault() override {
+        FluxPlugin::prefault();
+        m_l->prefault();
+        m_r->prefault();
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_l->prepare(sampleRate);
+        m_r->prepare(sampleRate);
+    }
+    void onRelease() override {
+        m_l->release();
+        m_r->release();
     }
 private:
     std::unique_ptr<SimpleReverb> m_l, m_r;
@@ -357,21 +484,32 @@ public:
     GrainVerb(int buf, float sr) : FluxPlugin("Grain Verb", buf, sr) {
         addParam("Density", 0.0f, 1.0f, 0.5f);
         addParam("Mix", 0.0f, 1.0f, 0.3f);
-        m_buffer.assign(44100, 0.0f);
+        onPrepare(sr, buf);
     }
     void processBlock(const float* in, float* out, int total) override {
         float mix = getParam("Mix");
         static std::default_random_engine gen;
-        std::uniform_int_distribution<int> dist(100, 44000);
+        const size_t size = m_buffer.size();
+        std::uniform_int_distribution<size_t> dist(100, size - 100);
         for(int i=0; i<total; ++i) {
             m_buffer[m_pos] = in[i];
-            int tap = (m_pos - dist(gen) + 44100) % 44100;
+            size_t tap = (m_pos + size - dist(gen)) % size;
             out[i] = in[i] * (1.0f - mix) + m_buffer[tap] * mix;
-            if (++m_pos >= 44100) m_pos = 0;
+            if (++m_pos >= size) m_pos = 0;
         }
     }
+    void prefault() override {
+        FluxPlugin::prefault();
+        RealtimeThread::prefault(m_buffer);
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_buffer.assign((size_t)sampleRate, 0.0f); // One second of grains
+        m_pos = 0;
+    }
+    void onRelease() override { RealtimeBuffer().swap(m_buffer); }
 private:
-    std::vector<float> m_buffer;
+    RealtimeBuffer m_buffer;
     size_t m_pos = 0;
 };
 
@@ -385,8 +523,8 @@ public:
         addParam("Time", 0.1f, 2.0f, 0.5f);
         addParam("Feedback", 0.0f, 0.95f, 0.4f);
         addParam("Wow", 0.0f, 1.0f, 0.2f);
-        m_buffer.assign((size_t)(sr * 2.0f), 0.0f);
         m_wf = std::make_unique<AnalogBase::WowFlutterGenerator>(sr);
+        onPrepare(sr, buf);
     }
     void processBlock(const float* in, float* out, int total) override {
         float fb = getParam("Feedback");
@@ -401,8 +539,19 @@ public:
             if (++m_pos >= m_buffer.size()) m_pos = 0;
         }
     }
+    void prefault() override {
+        FluxPlugin::prefault();
+        RealtimeThread::prefault(m_buffer);
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_buffer.assign((size_t)(sampleRate * 2.0f), 0.0f);
+        m_pos = 0;
+        m_wf->setSampleRate(sampleRate);
+    }
+    void onRelease() override { RealtimeBuffer().swap(m_buffer); }
 private:
-    std::vector<float> m_buffer;
+    RealtimeBuffer m_buffer;
     size_t m_pos = 0;
     std::unique_ptr<AnalogBase::WowFlutterGenerator> m_wf;
 };
@@ -412,8 +561,8 @@ public:
     BBD_Bucket(int buf, float sr) : FluxPlugin("BBD-Bucket", buf, sr) {
         addParam("Time", 0.01f, 0.5f, 0.1f);
         addParam("Darkness", 0.0f, 1.0f, 0.5f);
-        m_buffer.assign((size_t)(sr * 1.0f), 0.0f);
         m_lpf = std::make_unique<BiquadFilterNode>(FilterType::LowPass, 2000.0f, 0.7f, sr);
+        onPrepare(sr, buf);
     }
     void processBlock(const float* in, float* out, int total) override {
         m_lpf->setCutoff(10000.0f - getParam("Darkness") * 9000.0f);
@@ -426,8 +575,19 @@ public:
             if (++m_pos >= m_buffer.size()) m_pos = 0;
         }
     }
+    void prefault() override {
+        FluxPlugin::prefault();
+        RealtimeThread::prefault(m_buffer);
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_buffer.assign((size_t)(sampleRate * 1.0f), 0.0f);
+        m_pos = 0;
+        m_lpf->setSampleRate(sampleRate);
+    }
+    void onRelease() override { RealtimeBuffer().swap(m_buffer); }
 private:
-    std::vector<float> m_buffer;
+    RealtimeBuffer m_buffer;
     size_t m_pos=0;
     std::unique_ptr<BiquadFilterNode> m_lpf;
 };
@@ -436,7 +596,7 @@ class Reverse_Delay : public FluxPlugin {
 public:
     Reverse_Delay(int buf, float sr) : FluxPlugin("Reverse", buf, sr) {
         addParam("Mix", 0.0f, 1.0f, 0.5f);
-        m_buffer.assign((size_t)sr, 0.0f);
+        onPrepare(sr, buf);
     }
     void processBlock(const float* in, float* out, int total) override {
         float mix = getParam("Mix");
@@ -447,8 +607,18 @@ public:
             if (++m_pos >= m_buffer.size()) m_pos = 0;
         }
     }
+    void prefault() override {
+        FluxPlugin::prefault();
+        RealtimeThread::prefault(m_buffer);
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_buffer.assign((size_t)sampleRate, 0.0f);
+        m_pos = 0;
+    }
+    void onRelease() override { RealtimeBuffer().swap(m_buffer); }
 private:
-    std::vector<float> m_buffer;
+    RealtimeBuffer m_buffer;
     size_t m_pos = 0;
 };
 
@@ -457,8 +627,7 @@ public:
     PingPong_Delay(int buf, float sr) : FluxPlugin("Ping-Pong", buf, sr) {
         addParam("Time", 0.1f, 1.0f, 0.4f);
         addParam("Feedback", 0.0f, 0.9f, 0.5f);
-        m_l.assign((size_t)sr, 0.0f);
-        m_r.assign((size_t)sr, 0.0f);
+        onPrepare(sr, buf);
     }
     void processBlock(const float* in, float* out, int total) override {
         float fb = getParam("Feedback");
@@ -473,8 +642,23 @@ public:
             if (++m_pos >= m_l.size()) m_pos = 0;
         }
     }
+    void prefault() override {
+        FluxPlugin::prefault();
+        RealtimeThread::prefault(m_l);
+        RealtimeThread::prefault(m_r);
+    }
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_l.assign((size_t)sampleRate, 0.0f);
+        m_r.assign((size_t)sampleRate, 0.0f);
+        m_pos = 0;
+    }
+    void onRelease() override {
+        RealtimeBuffer().swap(m_l);
+        RealtimeBuffer().swap(m_r);
+    }
 private:
-    std::vector<float> m_l, m_r;
+    RealtimeBuffer m_l, m_r;
     size_t m_pos = 0;
 };
 
@@ -497,8 +681,12 @@ public:
             if (++m_pos >= m_buffer.size()) m_pos = 0;
         }
     }
+    void prefault() override {
+        FluxPlugin::prefault();
+        RealtimeThread::prefault(m_buffer);
+    }
 private:
-    std::vector<float> m_buffer;
+    RealtimeBuffer m_buffer;
     size_t m_pos = 0;
     float m_phase = 0.0f;
 };
@@ -543,8 +731,13 @@ public:
             m_filters.push_back(std::make_unique<BiquadFilterNode>(FilterType::Peaking, f, 4.0f, sr)); 
         }
     }
+    // 1: analyse every 4th block, 2: paused (pass-through only)
+    int getNumQualityTiers() const override { return 3; }
+
     void processBlock(const float* in, float* out, int total) override {
         std::copy(in, in + total, out);
+        const int tier = getQualityTier();
+        if (tier >= 2 || (tier == 1 && (m_blockCount++ & 3) != 0)) return;
         for(size_t b=0; b<m_filters.size(); ++b) {
             float peak = 0.0f;
             // Use strided processing for performance (check every 4th sample?)
@@ -566,9 +759,15 @@ public:
     std::vector<FluxNode::Port> getInputPorts() const override { return { {"In", 2} }; }
     std::vector<FluxNode::Port> getOutputPorts() const override { return { {"Out", 2} }; }
 
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        for (auto& f : m_filters) f->setSampleRate(sampleRate);
+    }
+
 private:
     std::vector<std::unique_ptr<BiquadFilterNode>> m_filters;
     std::vector<float> m_freqs;
+    uint32_t m_blockCount = 0;
 };
 
 class FluxLoudnessMeter : public FluxPlugin {
@@ -578,8 +777,13 @@ public:
         addParam("ShortTerm", -60.0f, 0.0f, -60.0f);
         addParam("True Peak", -60.0f, 0.0f, -60.0f);
     }
+    // 1: measure every 4th block, 2: paused (pass-through only)
+    int getNumQualityTiers() const override { return 3; }
+
     void processBlock(const float* in, float* out, int total) override {
         std::copy(in, in + total, out);
+        const int tier = getQualityTier();
+        if (tier >= 2 || (tier == 1 && (m_blockCount++ & 3) != 0)) return;
         float sumSq = 0.0f;
         float peak = 0.0f;
         for(int i=0; i<total; ++i) {
@@ -598,6 +802,8 @@ public:
         auto pT = getParameter("True Peak");
         if(pT) pT->setValue((std::max)(pT->getValue() - 0.5f, peakDb)); // Slow decay peak
     }
+private:
+    uint32_t m_blockCount = 0;
 };
 
 } // namespace Beam
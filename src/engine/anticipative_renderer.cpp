@@ -0,0 +1,221 @@
+#include "anticipative_renderer.hpp"
+#include "plan_executor.hpp"
+#include "simd_utils.hpp"
+#include "realtime_thread.hpp"
+#include "trace.hpp"
+#include "rt_checks.hpp"
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+
+namespace Beam {
+
+AnticipativeRenderer::AnticipativeRenderer(const RenderPlan& plan, const std::vector<std::shared_ptr<AutomationLane>>& lanes,
+                                           const std::shared_ptr<FluxNode>& master, int channels, bool enabled)
+    : m_channels(channels) {
+    // 1. Live set: live sources, the master and everything downstream. The plan is in
+    // topological order, so every node's upstream has been classified before it.
+    std::unordered_set<const FluxNode*> live;
+    for (const auto& exec : plan.sequence) {
+        const FluxNode* node = exec.node.get();
+        if (!enabled || exec.node == master || exec.node->isLiveSource()) live.insert(node);
+        if (live.count(node)) {
+            for (const auto& route : exec.outgoingRoutes) live.insert(route.destNode.get());
+        }
+    }
+
+    // 2. Split the execution sequence; routes from the ahead part into live nodes become taps.
+    for (const auto& exec : plan.sequence) {
+        if (live.count(exec.node.get())) {
+            m_livePlan.sequence.push_back(exec);
+            continue;
+        }
+        NodeExecution ahead;
+        ahead.node = exec.node;
+        ahead.name = exec.name;
+        for (const auto& route : exec.outgoingRoutes) {
+            if (live.count(route.destNode.get())) {
+                m_taps.push_back({ route.sourceNode, route.sourcePort, route.destNode, route.destPort, nullptr });
+            } else {
+                ahead.outgoingRoutes.push_back(route);
+            }
+        }
+        m_aheadPlan.sequence.push_back(ahead);
+        int maxFrames = exec.node->getMaxBlockFrames();
+        if (maxFrames > 0) m_blockFrames = (std::min)(m_blockFrames, maxFrames);
+    }
+
+    m_livePlan.latencyFrames = plan.latencyFrames;
+    m_livePlan.numStages = plan.numStages;
+
+    for (const auto& op : plan.clearOps) {
+        (live.count(op.node.get()) ? m_livePlan : m_aheadPlan).clearOps.push_back(op);
+    }
+
+    // 3. Automation is applied by whichever part owns the parameter.
+    std::unordered_set<const Parameter*> aheadParams;
+    for (const auto& exec : m_aheadPlan.sequence) {
+        for (const auto& [name, p] : exec.node->getParameters()) aheadParams.insert(p.get());
+    }
+    for (const auto& lane : lanes) {
+        (aheadParams.count(lane->getParameter().get()) ? m_aheadLanes : m_liveLanes).push_back(lane);
+    }
+
+    for (auto& tap : m_taps) {
+        tap.ring = std::make_unique<LockFreeRing<float>>((size_t)m_blockFrames * kRingBlocks * channels);
+    }
+    m_tapScratch.assign((size_t)kMaxAheadBlockFrames * channels, 0.0f);
+}
+
+AnticipativeRenderer::~AnticipativeRenderer() {
+    stop();
+}
+
+void AnticipativeRenderer::start(size_t playhead, bool playing, const AnticipativeRenderer* previous) {
+    m_playing.store(playing, std::memory_order_release);
+    // Ahead nodes may wait for their data (e.g. a track for its prefetch ring after a
+    // seek) instead of baking silence into the taps; live nodes never wait.
+    for (const auto& exec : m_aheadPlan.sequence) exec.node->setNonRealtime(true);
+    for (const auto& exec : m_livePlan.sequence) exec.node->setNonRealtime(false);
+    if (!previous || !continueFrom(*previous, playhead)) reset(playhead);
+    if (!hasAheadPart() || m_running.exchange(true)) return;
+    m_worker = std::thread(&AnticipativeRenderer::workerLoop, this);
+    // Below the real-time workers: it runs up to a window ahead, so it can wait.
+    RealtimeThread::instance().promote(m_worker, RealtimeThread::kUnpinned, -2);
+}
+
+void AnticipativeRenderer::stop() {
+    m_running.store(false);
+    if (m_worker.joinable()) m_worker.join();
+}
+
+bool AnticipativeRenderer::continueFrom(const AnticipativeRenderer& previous, size_t playhead) {
+    if (!hasAheadPart() || !previous.hasAheadPart() || previous.m_running.load()) return false;
+    if (!m_playing.load(std::memory_order_relaxed) || !previous.m_playing.load(std::memory_order_relaxed)) return false;
+
+    // Only a settled generation that covers the playhead can be continued.
+    if (previous.m_servedGen.load(std::memory_order_acquire) != previous.m_requestGen.load(std::memory_order_acquire)) return false;
+    const size_t end = previous.m_aheadFrame;
+    if (playhead < previous.m_genStartFrame.load(std::memory_order_relaxed) || playhead > end) return false;
+    const size_t samples = (end - playhead) * (size_t)m_channels;
+    for (const auto& tap : m_taps) {
+        if (tap.ring->capacity() < samples) return false;
+    }
+
+    // Copy each source's audio for [playhead, end); taps of one source share it.
+    const uint64_t from = previous.indexFor(playhead);
+    std::vector<float> audio(samples);
+    for (auto& tap : m_taps) {
+        const Tap* match = nullptr;
+        for (const auto& old : previous.m_taps) {
+            if (old.sourceNode == tap.sourceNode && old.sourcePort == tap.sourcePort) match = &old;
+        }
+        const size_t got = match ? match->ring->peek(from, audio.data(), samples) : 0;
+        std::fill(audio.begin() + got, audio.end(), 0.0f);
+        tap.ring->write(audio.data(), samples);
+    }
+
+    m_liveFrame.store(playhead, std::memory_order_relaxed);
+    m_requestFrame.store(playhead, std::memory_order_relaxed);
+    m_aheadFrame = end;
+    m_genStartIndex.store(0, std::memory_order_relaxed); // Fresh rings
+    m_genStartFrame.store(playhead, std::memory_order_relaxed);
+    const uint64_t gen = m_requestGen.fetch_add(1, std::memory_order_acq_rel) + 1;
+    m_servedGen.store(gen, std::memory_order_release);
+    return true;
+}
+
+void AnticipativeRenderer::reset(size_t frame) {
+    m_liveFrame.store(frame, std::memory_order_relaxed);
+    m_requestFrame.store(frame, std::memory_order_relaxed);
+    m_requestGen.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t AnticipativeRenderer::indexFor(size_t frame) const {
+    return m_genStartIndex.load(std::memory_order_relaxed) +
+           (uint64_t)(frame - m_genStartFrame.load(std::memory_order_relaxed)) * m_channels;
+}
+
+bool AnticipativeRenderer::isReady(size_t frame, int frames) {
+    m_liveFrame.store(frame, std::memory_order_relaxed);
+    if (!hasAheadPart()) return true;
+
+    const uint64_t gen = m_requestGen.load(std::memory_order_acquire);
+    const bool settled = m_servedGen.load(std::memory_order_acquire) == gen;
+    bool ready = settled;
+    if (ready && !m_taps.empty()) {
+        ready = frame >= m_genStartFrame.load(std::memory_order_relaxed);
+        const uint64_t end = ready ? indexFor(frame + frames) : 0;
+        for (const auto& tap : m_taps) ready = ready && tap.ring->getWriteIndex() >= end;
+    }
+    if (!ready) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        // Past the first block of a generation the worker has simply fallen behind.
+        if (settled && frame > m_genStartFrame.load(std::memory_order_relaxed)) m_lateBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ready;
+}
+
+void AnticipativeRenderer::readTaps(size_t frame, int frames) {
+    const uint64_t start = indexFor(frame);
+    for (auto& tap : m_taps) {
+        tap.ring->skipTo(start);
+        float* dst = tap.destNode->getInputBuffer(tap.destPort);
+        size_t remaining = (size_t)frames * m_channels;
+        while (remaining > 0) {
+            size_t n = tap.ring->read(m_tapScratch.data(), (std::min)(remaining, m_tapScratch.size()));
+            if (n == 0) break;
+            SIMD::add(m_tapScratch.data(), dst, (int)n);
+            dst += n;
+            remaining -= n;
+        }
+    }
+}
+
+void AnticipativeRenderer::workerLoop() {
+    Tracer::instance().setThreadName("Render Ahead");
+    while (m_running.load(std::memory_order_relaxed)) {
+        bool rendered;
+        {
+            FLUX_RT_SCOPE();
+            rendered = renderBlock();
+        }
+        if (!rendered) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool AnticipativeRenderer::renderBlock() {
+    const uint64_t gen = m_requestGen.load(std::memory_order_acquire);
+    if (gen != m_servedGen.load(std::memory_order_relaxed)) {
+        // New position: drop what was rendered for the old one. Tap rings are written in
+        // lockstep, so they share one start index.
+        for (auto& tap : m_taps) tap.ring->discardTo(tap.ring->getWriteIndex());
+        m_aheadFrame = m_requestFrame.load(std::memory_order_relaxed);
+        m_genStartIndex.store(m_taps.empty() ? 0 : m_taps[0].ring->getWriteIndex(), std::memory_order_relaxed);
+        m_genStartFrame.store(m_aheadFrame, std::memory_order_relaxed);
+        // The ahead nodes belong to this thread, so they are seeked here rather than by the caller.
+        for (const auto& exec : m_aheadPlan.sequence) exec.node->onTransportSeek(m_aheadFrame);
+        m_servedGen.store(gen, std::memory_order_release);
+    }
+
+    if (!m_playing.load(std::memory_order_acquire)) return false;
+
+    const size_t window = (size_t)m_blockFrames * kRingBlocks;
+    if (m_aheadFrame >= m_liveFrame.load(std::memory_order_relaxed) + window) return false;
+    const size_t blockSamples = (size_t)m_blockFrames * m_channels;
+    for (const auto& tap : m_taps) {
+        if (tap.ring->availableToWrite() < blockSamples) return false;
+    }
+
+    for (auto& lane : m_aheadLanes) lane->applyAt(m_aheadFrame);
+    PlanExecutor::clearInputs(m_aheadPlan, m_blockFrames, m_channels);
+    PlanExecutor::run(m_aheadPlan, m_blockFrames, m_channels, m_aheadFrame);
+
+    for (auto& tap : m_taps) {
+        tap.ring->write(tap.sourceNode->getOutputBuffer(tap.sourcePort), blockSamples);
+    }
+    m_aheadFrame += m_blockFrames;
+    return true;
+}
+
+} // namespace Beam
@@ -0,0 +1,145 @@
+#ifndef ANTICIPATIVE_RENDERER_HPP
+#define ANTICIPATIVE_RENDERER_HPP
+
+#include "render_plan.hpp"
+#include "lock_free_ring.hpp"
+#include "midi_event.hpp"
+#include "../session/automation.hpp"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @class AnticipativeRenderer
+ * @brief Splits a compiled plan into a live part and a render-ahead part.
+ *
+ * Live nodes are the live sources (InputNode, MIDI instruments), everything
+ * downstream of them, and the master. All other nodes depend only on disk
+ * playback and automation, so a worker thread renders them ahead of the
+ * playhead in large blocks. Wherever a render-ahead node feeds a live node
+ * the signal is captured into a lock-free ring (a "tap"); the real-time pass
+ * reads the taps back into the live inputs and runs only the live nodes.
+ *
+ * Rendered audio is tied to the timeline position through a generation
+ * protocol: reset() (seek, play) bumps the requested generation, the worker
+ * discards what it had and seeks its own nodes, and the real-time side waits
+ * until audio for the playhead is available rather than playing the wrong
+ * material.
+ *
+ * The ahead part hears parameter changes and drives its meters up to
+ * `kRingBlocks` blocks early; automation for it is applied at the render
+ * position by the worker.
+ *
+ * When a plan is rebuilt during playback, the new renderer continues where the
+ * old one stopped (see start): the nodes that stay in the ahead part have
+ * already processed up to the old render position, so the tap audio between
+ * the playhead and that position is carried over instead of rendered again.
+ */
+class AnticipativeRenderer {
+public:
+    static constexpr int kMaxAheadBlockFrames = 4096;
+    static constexpr int kRingBlocks = 4;
+
+    /**
+     * @param plan Full compiled plan, in execution order.
+     * @param lanes Automation lanes; each is applied by the part that owns its parameter.
+     * @param enabled False keeps the whole plan live (no worker thread).
+     */
+    AnticipativeRenderer(const RenderPlan& plan, const std::vector<std::shared_ptr<AutomationLane>>& lanes,
+                         const std::shared_ptr<FluxNode>& master, int channels, bool enabled);
+    ~AnticipativeRenderer();
+
+    AnticipativeRenderer(const AnticipativeRenderer&) = delete;
+    AnticipativeRenderer& operator=(const AnticipativeRenderer&) = delete;
+
+    /**
+     * @brief Starts the worker (if there is anything to render ahead). UI thread. Ahead nodes
+     * are marked non-real-time (see FluxNode::setNonRealtime), so a track waits for its disk
+     * prefetch after a seek instead of rendering silence into the taps.
+     * @param previous The stopped renderer of the plan this one replaces, or null. If it was
+     * rendering ahead of `playhead`, rendering continues from its position and its tap audio
+     * is reused, so delay lines and reverbs do not process that span twice. Taps with no
+     * counterpart in it (nodes new to the ahead part) are silent for that span.
+     */
+    void start(size_t playhead, bool playing, const AnticipativeRenderer* previous = nullptr);
+    /** @brief Stops and joins the worker. Must happen before another plan uses the same nodes. */
+    void stop();
+
+    /** @brief Restarts rendering ahead from `frame` (seek, transport start). Any thread. */
+    void reset(size_t frame);
+    void setPlaying(bool playing) { m_playing.store(playing, std::memory_order_release); }
+
+    /**
+     * @brief Real-time side: true once audio for [frame, frame + frames) has been rendered ahead.
+     */
+    bool isReady(size_t frame, int frames);
+
+    /**
+     * @brief Real-time side: after the live inputs are cleared, sums the taps for the block into them.
+     * Only valid after isReady() returned true for the same block.
+     */
+    void readTaps(size_t frame, int frames);
+
+    const RenderPlan& getLivePlan() const { return m_livePlan; }
+    const RenderPlan& getAheadPlan() const { return m_aheadPlan; }
+    const std::vector<std::shared_ptr<AutomationLane>>& getLiveLanes() const { return m_liveLanes; }
+    bool hasAheadPart() const { return !m_aheadPlan.sequence.empty(); }
+
+    /** @brief Blocks the real-time side had to wait for because rendering was behind. */
+    uint64_t getMissCount() const { return m_misses.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Real-time side: misses since the last call that happened in the middle of
+     * playback, i.e. the worker could not keep up (not the wait after a seek or start).
+     */
+    uint64_t takeLateBlocks() { return m_lateBlocks.exchange(0, std::memory_order_relaxed); }
+
+private:
+    struct Tap {
+        std::shared_ptr<FluxNode> sourceNode;
+        int sourcePort;
+        std::shared_ptr<FluxNode> destNode;
+        int destPort;
+        std::unique_ptr<LockFreeRing<float>> ring;
+    };
+
+    void workerLoop();
+    bool renderBlock();
+    bool continueFrom(const AnticipativeRenderer& previous, size_t playhead);
+    uint64_t indexFor(size_t frame) const;
+
+    int m_channels;
+    int m_blockFrames = kMaxAheadBlockFrames;
+
+    RenderPlan m_livePlan;
+    RenderPlan m_aheadPlan;
+    std::vector<Tap> m_taps;
+    std::vector<std::shared_ptr<AutomationLane>> m_liveLanes;
+    std::vector<std::shared_ptr<AutomationLane>> m_aheadLanes;
+    std::vector<float> m_tapScratch;
+
+    std::thread m_worker;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_playing{false};
+
+    // Generation protocol (see DiskStreamer): requests come from the UI thread,
+    // the worker publishes where the served generation starts in the tap rings.
+    std::atomic<uint64_t> m_requestGen{0};
+    std::atomic<size_t> m_requestFrame{0};
+    std::atomic<uint64_t> m_servedGen{0};
+    std::atomic<uint64_t> m_genStartIndex{0};
+    std::atomic<size_t> m_genStartFrame{0};
+    size_t m_aheadFrame = 0;                  // Worker: next frame to render
+    std::atomic<size_t> m_liveFrame{0};       // Real-time side: current playhead
+
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_lateBlocks{0};
+};
+
+} // namespace Beam
+
+#endif // ANTICIPATIVE_RENDERER_HPP
@@ -0,0 +1,179 @@
+#ifndef ASYNC_NODE_WRAPPER_HPP
+#define ASYNC_NODE_WRAPPER_HPP
+
+#include "flux_node.hpp"
+#include "simd_utils.hpp"
+#include "trace.hpp"
+#include "rt_checks.hpp"
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @class AsyncNodeWrapper
+ * @brief Runs an expensive node on its own worker thread, one block behind the graph.
+ *
+ * Each process() call hands the current input block to the worker and returns
+ * the output the worker produced for the previous block, so the wrapped node
+ * gets a whole block period of wall-clock time on another core. The wrapper's
+ * port buffers and the inner node's buffers form the two halves of a double
+ * buffer; ownership of the inner buffers passes between the threads through
+ * two atomic counters, so neither side locks.
+ *
+ * The added delay is one block and is reported through getLatencyFrames():
+ * the prepared block size until the first block arrives, then the size of the
+ * blocks actually processed (AudioEngine recompiles the plan when it changes).
+ * If the worker has not finished when the next block arrives, the wrapper
+ * outputs silence for that block instead of waiting, and counts it.
+ * Wrapped nodes do not receive MIDI.
+ */
+class AsyncNodeWrapper : public FluxNode {
+public:
+    explicit AsyncNodeWrapper(std::shared_ptr<FluxNode> inner)
+        : m_inner(std::move(inner)), m_latencyFrames(m_inner->getMaxBlockFrames()) {
+        m_sampleRate = m_inner->getSampleRate();
+        int maxFrames = m_inner->getMaxBlockFrames();
+        setupBuffers((int)m_inner->getInputPorts().size(), m_inner->getNumOutputBuffers(), maxFrames, 2);
+        for (const auto& [name, param] : m_inner->getParameters()) addParameter(param);
+        m_traceName = m_inner->getName();
+        m_worker = std::thread(&AsyncNodeWrapper::workerLoop, this);
+        RealtimeThread::instance().promote(m_worker, RealtimeThread::kUnpinned);
+    }
+
+    ~AsyncNodeWrapper() override {
+        m_stop.store(true, std::memory_order_release);
+        m_submitted.fetch_add(1, std::memory_order_release);
+        m_submitted.notify_one();
+        m_worker.join();
+    }
+
+    void process(int frames) override {
+        const uint64_t submitted = m_submitted.load(std::memory_order_relaxed);
+        if (m_completed.load(std::memory_order_acquire) != submitted) {
+            // The worker overran its block: keep the deadline and drop this one.
+            clearOutputs(frames);
+            m_lateBlocks.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // The inner node is idle: take the previous block's result, then hand over this block.
+        const int ready = m_pendingFrames;
+        for (int i = 0; i < (int)m_outputs.size(); ++i) {
+            float* out = getOutputBuffer(i);
+            if (ready > 0) SIMD::copy(m_inner->getOutputBuffer(i), out, (std::min)(ready, frames) * 2);
+            if (ready < frames) std::fill(out + (size_t)(std::max)(ready, 0) * 2, out + (size_t)frames * 2, 0.0f);
+        }
+        for (int i = 0; i < (int)m_inputs.size(); ++i) {
+            SIMD::copy(getInputBuffer(i), m_inner->getInputBuffer(i), frames * 2);
+        }
+
+        m_inner->setCurrentFrame(m_currentFrame);
+        m_inner->setQualityTier(getQualityTier());
+        m_pendingFrames = frames;
+        m_latencyFrames.store(frames, std::memory_order_relaxed);
+        m_submitted.store(submitted + 1, std::memory_order_release);
+        m_submitted.notify_one();
+    }
+
+    void onTransportStateChanged(bool playing) override { m_inner->onTransportStateChanged(playing); }
+    void onTransportSeek(size_t frame) override {
+        // The inner node may be mid-block on the worker; it seeks before its next block.
+        FluxNode::onTransportSeek(frame);
+        m_pendingSeek.store(frame, std::memory_order_release);
+    }
+
+    /** @brief One block, plus whatever the wrapped node reports itself. */
+    int getLatencyFrames() const override {
+        return m_latencyFrames.load(std::memory_order_relaxed) + m_inner->getLatencyFrames();
+    }
+
+    bool isLiveSource() const override { return m_inner->isLiveSource(); }
+    int getNumQualityTiers() const override { return m_inner->getNumQualityTiers(); }
+
+    void prefault() override {
+        FluxNode::prefault();
+        m_inner->prefault();
+    }
+
+    /** @brief Blocks output as silence because the worker had not finished in time. */
+    uint64_t getLateBlockCount() const { return m_lateBlocks.load(std::memory_order_relaxed); }
+
+    std::shared_ptr<FluxNode> getInner() const { return m_inner; }
+
+    std::string getName() const override { return m_inner->getName(); }
+    std::vector<Port> getInputPorts() const override { return m_inner->getInputPorts(); }
+    std::vector<Port> getOutputPorts() const override { return m_inner->getOutputPorts(); }
+
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        waitForWorker();
+        m_inner->prepare(sampleRate, maxBlockFrames);
+        m_pendingFrames = 0; // The block in flight was rendered at the old settings
+        m_latencyFrames.store(maxBlockFrames, std::memory_order_relaxed);
+    }
+
+    void onRelease() override {
+        waitForWorker();
+        m_inner->release();
+    }
+
+private:
+    /** @brief Waits until the inner node is back with the graph; UI thread only. */
+    void waitForWorker() const {
+        while (m_completed.load(std::memory_order_acquire) != m_submitted.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void clearOutputs(int frames) {
+        for (auto& out : m_outputs) std::fill(out.begin(), out.begin() + (size_t)frames * 2, 0.0f);
+    }
+
+    void workerLoop() {
+        Tracer::instance().setThreadName("Async Node");
+        uint64_t done = 0;
+        while (true) {
+            m_submitted.wait(done, std::memory_order_acquire);
+            if (m_stop.load(std::memory_order_acquire)) return;
+            const uint64_t target = m_submitted.load(std::memory_order_acquire);
+            FLUX_RT_SCOPE();
+            const size_t seek = m_pendingSeek.exchange(kNoSeek, std::memory_order_acq_rel);
+            if (seek != kNoSeek) m_inner->onTransportSeek(seek);
+            FLUX_TRACE_SCOPE(m_traceName.c_str());
+            if (NodeTiming::isEnabled()) {
+                const uint64_t start = NodeTiming::nowNs();
+                m_inner->process(m_pendingFrames);
+                const uint64_t budget = (uint64_t)((double)m_pendingFrames * 1e9 / m_inner->getSampleRate());
+                m_inner->getTiming().record(NodeTiming::nowNs() - start, budget);
+            } else {
+                m_inner->process(m_pendingFrames);
+            }
+            done = target;
+            m_completed.store(done, std::memory_order_release);
+        }
+    }
+
+    std::shared_ptr<FluxNode> m_inner;
+    std::string m_traceName;
+    std::thread m_worker;
+
+    // Block handshake: the graph owns the inner node while completed == submitted.
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_completed{0};
+    std::atomic<bool> m_stop{false};
+    int m_pendingFrames = 0; // Frames in the block handed to the worker; published by m_submitted
+
+    static constexpr size_t kNoSeek = SIZE_MAX;
+    std::atomic<size_t> m_pendingSeek{kNoSeek};
+
+    std::atomic<int> m_latencyFrames;
+    std::atomic<uint64_t> m_lateBlocks{0};
+};
+
+} // namespace Beam
+
+#endif // ASYNC_NODE_WRAPPER_HPP
@@ -2,29 +2,44 @@
 #include "flux_track_node.hpp"
 #include "input_node.hpp"
 #include "simd_utils.hpp"
+#include "plan_executor.hpp"
+#include "realtime_thread.hpp"
+#include "trace.hpp"
+#include "rt_checks.hpp"
 #include <iostream>
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <array>
 
 namespace Beam {
 
 AudioEngine::AudioEngine() : m_sampleRate(44100), m_channels(2), m_stream(nullptr), m_captureStream(nullptr) {
-    m_activePlan.store(nullptr);
+    m_active.store(nullptr);
+    m_latency.configure(m_sampleRate);
 }
 
 AudioEngine::~AudioEngine() {
+    if (auto active = m_active.load()) active->renderer->stop();
     if (m_stream) SDL_DestroyAudioStream(m_stream);
     if (m_captureStream) SDL_DestroyAudioStream(m_captureStream);
+    if (m_monitorStream) SDL_DestroyAudioStream(m_monitorStream);
 }
 
-bool AudioEngine::init(int sampleRate, int channels, const std::string& outputDevice, const std::string& inputDevice) {
+bool AudioEngine::init(int sampleRate, int channels, const std::string& outputDevice, const std::string& inputDevice,
+                       int maxBlockFrames) {
+    // Destroying the streams also stops their callbacks before the rings are resized.
     if (m_stream) SDL_DestroyAudioStream(m_stream);
     if (m_captureStream) SDL_DestroyAudioStream(m_captureStream);
+    if (m_monitorStream) SDL_DestroyAudioStream(m_monitorStream);
+    m_stream = m_captureStream = m_monitorStream = nullptr;
 
-    m_sampleRate = sampleRate;
-    m_channels = channels;
+    prepare(sampleRate, channels, maxBlockFrames);
+
+    // Small device periods keep direct monitoring tight; the graph still renders in large
+    // blocks because the main output stream is fed from a queue.
+    SDL_SetHint(SDL_HINT_AUDIO_DEVICE_SAMPLE_FRAMES, std::to_string(kDevicePeriodFrames).c_str());
 
-    if (!m_masterNode) m_masterNode = std::make_shared<MasterNode>(1024 * 4);
-    if (!m_inputNode) m_inputNode = std::make_shared<InputNode>(1024 * 4);
-    
     SDL_AudioSpec spec;
     spec.format = SDL_AUDIO_F32;
     spec.channels = channels;
@@ -49,7 +64,14 @@ bool AudioEngine::init(int sampleRate, int channels, const std::string& outputDe
         try { inId = (SDL_AudioDeviceID)std::stoul(inputDevice); } catch(...) {}
     }
 
-    m_captureStream = SDL_OpenAudioDeviceStream(inId, &spec, NULL, NULL);
+    // Direct monitor: a second stream on the output device, pulled by SDL once per period
+    m_monitorStream = SDL_OpenAudioDeviceStream(outId, &spec, onMonitorRequest, this);
+    if (!m_monitorStream) {
+        std::cerr << "WARNING: SDL_OpenAudioDeviceStream (Monitor) failed: " << SDL_GetError() << std::endl;
+    }
+
+    // Capture is drained by SDL's callback as soon as each period arrives.
+    m_captureStream = SDL_OpenAudioDeviceStream(inId, &spec, onCaptureAvailable, this);
     if (!m_captureStream) {
         std::cerr << "WARNING: SDL_OpenAudioDeviceStream (Recording) failed: " << SDL_GetError() << std::endl;
     } else {
@@ -57,9 +79,149 @@ bool AudioEngine::init(int sampleRate, int channels, const std::string& outputDe
     }
 
     SDL_ResumeAudioStreamDevice(m_stream);
+    if (m_monitorStream) SDL_ResumeAudioStreamDevice(m_monitorStream);
     return true;
 }
 
+void AudioEngine::prepare(int sampleRate, int channels, int maxBlockFrames) {
+    const bool reconfigured = sampleRate != m_sampleRate || maxBlockFrames != m_maxBlockFrames;
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    m_maxBlockFrames = maxBlockFrames;
+    m_latency.configure(sampleRate); // Queue depth is in frames, so adaptation restarts
+
+    // The render-ahead and pipeline workers must be gone before their nodes are re-prepared.
+    if (reconfigured) {
+        if (auto old = m_active.exchange(nullptr)) {
+            old->renderer->stop();
+            old->pipeline.reset();
+        }
+    }
+
+    if (!m_masterNode) m_masterNode = std::make_shared<MasterNode>(maxBlockFrames);
+    if (!m_inputNode) m_inputNode = std::make_shared<InputNode>(maxBlockFrames, sampleRate);
+    prepareNode(*m_masterNode);
+    prepareNode(*m_inputNode);
+    m_inputNode->setMaxBacklogMs(m_latency.getMaxLatencyMs());
+    if (reconfigured) {
+        // The monitor stream is closed, so its inserts can be prepared as well.
+        if (auto chain = m_monitorChain.load()) {
+            for (auto& node : chain->inserts) prepareNode(*node);
+        }
+        if (m_graph) {
+            for (auto& [id, node] : m_graph->getNodes()) prepareNode(*node);
+            updatePlan();
+        }
+    }
+    m_captureScratch.assign((size_t)maxBlockFrames * channels, 0.0f);
+    m_monitorRing.resize((size_t)sampleRate / 10 * channels);
+    m_monitorScratch.assign((size_t)kDevicePeriodFrames * channels, 0.0f);
+
+    RealtimeThread& rt = RealtimeThread::instance();
+    rt.lockMemory();
+    rt.prefault(m_captureScratch);
+    rt.prefault(m_monitorScratch);
+}
+
+void AudioEngine::setDirectMonitoring(bool enabled) {
+    m_directMonitoring.store(enabled, std::memory_order_relaxed);
+    if (m_inputNode) m_inputNode->setDirectMonitored(enabled);
+}
+
+void AudioEngine::setMonitorInserts(std::vector<std::shared_ptr<FluxNode>> inserts) {
+    auto chain = std::make_shared<MonitorChain>();
+    for (auto& node : inserts) {
+        if (node && !node->getInputPorts().empty() && !node->getOutputPorts().empty()) {
+            prepareNode(*node);
+            node->prefault();
+            chain->inserts.push_back(node);
+        }
+    }
+    // The monitor callback may still hold the previous chain for a block; keeping it here
+    // means its last reference (and its inserts) is always dropped on this thread.
+    m_retiredMonitorChains.push_back(m_monitorChain.exchange(std::move(chain)));
+    m_retiredMonitorChains.erase(std::remove_if(m_retiredMonitorChains.begin(), m_retiredMonitorChains.end(),
+                                                [](const auto& c) { return !c || c.use_count() == 1; }),
+                                 m_retiredMonitorChains.end());
+}
+
+bool AudioEngine::isMonitoringActive() const {
+    return m_directMonitoring.load(std::memory_order_relaxed) && m_inputNode && m_inputNode->getArmedTrackCount() > 0;
+}
+
+void AudioEngine::promoteDeviceThread() {
+    // SDL owns the device threads; promote each the first time it calls us.
+    thread_local bool promoted = false;
+    if (promoted) return;
+    promoted = true;
+    RealtimeThread::instance().promoteCurrentThread(RealtimeThread::kCallbackSlot);
+}
+
+void SDLCALL AudioEngine::onCaptureAvailable(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount) {
+    auto* self = static_cast<AudioEngine*>(userdata);
+    promoteDeviceThread();
+    FLUX_RT_SCOPE();
+    if (!self->m_inputNode) return;
+    FLUX_RT_ALLOW(); // SDL holds its stream lock for the whole callback
+
+    const bool monitoring = self->isMonitoringActive();
+    const int scratchBytes = (int)(self->m_captureScratch.size() * sizeof(float));
+    int available = SDL_GetAudioStreamAvailable(stream);
+    while (available > 0) {
+        int got = SDL_GetAudioStreamData(stream, self->m_captureScratch.data(), (std::min)(available, scratchBytes));
+        if (got <= 0) break;
+        const size_t samples = (size_t)got / sizeof(float);
+        self->m_inputNode->pushData(self->m_captureScratch.data(), (int)samples);
+        if (monitoring) self->m_monitorRing.write(self->m_captureScratch.data(), samples);
+        available -= got;
+    }
+}
+
+void SDLCALL AudioEngine::onMonitorRequest(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount) {
+    auto* self = static_cast<AudioEngine*>(userdata);
+    promoteDeviceThread();
+    FLUX_RT_SCOPE();
+    self->renderMonitor(stream, additionalAmount / (int)(sizeof(float) * self->m_channels));
+}
+
+void AudioEngine::renderMonitor(SDL_AudioStream* stream, int frames) {
+    if (!isMonitoringActive()) {
+        // Nothing queued means this stream contributes silence to the device mix.
+        m_monitorRing.clear();
+        return;
+    }
+
+    // Keep at most one period beyond this request so latency cannot creep up with clock drift.
+    const size_t channels = (size_t)m_channels;
+    size_t buffered = m_monitorRing.availableToRead() / channels;
+    size_t limit = (size_t)frames + kDevicePeriodFrames;
+    if (buffered > limit) m_monitorRing.skipTo(m_monitorRing.getReadIndex() + (buffered - limit) * channels);
+
+    std::shared_ptr<MonitorChain> chain = m_monitorChain.load();
+    float* buf = m_monitorScratch.data();
+    while (frames > 0) {
+        int n = (std::min)(frames, kDevicePeriodFrames);
+        size_t samples = (size_t)n * channels;
+        size_t got = m_monitorRing.read(buf, samples);
+        std::fill(buf + got, buf + samples, 0.0f);
+
+        if (chain) {
+            for (auto& node : chain->inserts) {
+                if (node->isBypassed()) continue;
+                SIMD::copy(buf, node->getInputBuffer(0), (int)samples);
+                node->process(n);
+                SIMD::copy(node->getOutputBuffer(0), buf, (int)samples);
+            }
+        }
+
+        {
+            FLUX_RT_ALLOW();
+            SDL_PutAudioStreamData(stream, buf, (int)(samples * sizeof(float)));
+        }
+        frames -= n;
+    }
+}
+
 void AudioEngine::setGraph(std::shared_ptr<FluxGraph> graph) {
     if (m_graph == graph) return;
     
@@ -72,16 +234,120 @@ void AudioEngine::setGraph(std::shared_ptr<FluxGraph> graph) {
 
 void AudioEngine::updatePlan() {
     if (m_graph) {
-        auto newPlan = m_graph->compile(1024, m_channels);
-        m_activePlan.store(newPlan);
+        FLUX_TRACE_SCOPE("Plan Compile");
+        // Pipeline latency is counted in blocks, so the plan is compiled for the block size in use.
+        m_planBlockFrames = getBlockFrames();
+        auto newPlan = m_graph->compile(m_planBlockFrames, m_channels, m_pipelineStages);
+        // Armed tracks read the capture block directly, so the input runs before anything else.
+        std::stable_partition(newPlan->sequence.begin(), newPlan->sequence.end(), [](const NodeExecution& exec) {
+            return std::dynamic_pointer_cast<InputNode>(exec.node) != nullptr;
+        });
+        // Tracks with something cabled into "Stereo In" record that signal, not the capture block.
+        std::unordered_set<const FluxNode*> wired;
+        for (const auto& exec : newPlan->sequence) {
+            for (const auto& route : exec.outgoingRoutes) {
+                if (route.destPort == 0) wired.insert(route.destNode.get());
+            }
+        }
+        for (const auto& exec : newPlan->sequence) {
+            if (auto* track = dynamic_cast<FluxTrackNode*>(exec.node.get())) track->setInputWired(wired.count(track) > 0);
+        }
+
+        // Nodes added since the last plan are not running yet, so they can be prepared here;
+        // nodes already in the plan were prepared when they were added or by init().
+        // Then fault in every buffer the new plan touches before the audio thread first does.
+        int maxQualityTier = 0;
+        for (const auto& exec : newPlan->sequence) {
+            prepareNode(*exec.node);
+            exec.node->prefault();
+            maxQualityTier = (std::max)(maxQualityTier, exec.node->getNumQualityTiers() - 1);
+        }
+
+        auto active = std::make_shared<ActivePlan>();
+        active->maxQualityTier = maxQualityTier;
+        for (const auto& exec : newPlan->sequence) active->latencies.emplace_back(exec.node.get(), exec.node->getLatencyFrames());
+        const bool pipelined = newPlan->numStages > 1;
+        active->renderer = std::make_shared<AnticipativeRenderer>(*newPlan, m_automationLanes, m_masterNode, m_channels,
+                                                                  m_renderAhead && !pipelined);
+        if (pipelined) {
+            active->pipeline = std::make_shared<PipelineExecutor>(active->renderer->getLivePlan(), m_channels, m_maxBlockFrames,
+                                                                  active->renderer->getLiveLanes());
+        }
+
+        // The old workers must be gone before the new ones touch the same nodes.
+        std::shared_ptr<ActivePlan> old = m_active.exchange(nullptr);
+        if (old) {
+            old->renderer->stop();
+            old->pipeline.reset();
+            releaseRemovedNodes(*old, *newPlan);
+        }
+        m_active.store(active);
+        // Continue from the old render position: its ahead nodes already processed past the playhead.
+        active->renderer->start(m_transport.read().frame, m_isPlaying, old ? old->renderer.get() : nullptr);
     }
 }
 
+void AudioEngine::prepareNode(FluxNode& node) const {
+    if (!node.isPreparedFor((float)m_sampleRate, m_maxBlockFrames)) node.prepare((float)m_sampleRate, m_maxBlockFrames);
+}
+
+void AudioEngine::releaseRemovedNodes(const ActivePlan& old, const RenderPlan& current) {
+    // Called once the old plan's workers have stopped: nodes that left the graph free their state.
+    std::unordered_set<const FluxNode*> kept;
+    for (const auto& exec : current.sequence) kept.insert(exec.node.get());
+    if (auto chain = m_monitorChain.load()) {
+        for (const auto& node : chain->inserts) kept.insert(node.get());
+    }
+    for (const RenderPlan* plan : { &old.renderer->getLivePlan(), &old.renderer->getAheadPlan() }) {
+        for (const auto& exec : plan->sequence) {
+            if (kept.insert(exec.node.get()).second) exec.node->release();
+        }
+    }
+}
+
+NodeTimingStats AudioEngine::getNodeTiming(const FluxNode& node) const {
+    // Compared as fractions of real time: render-ahead nodes run larger blocks than the
+    // device callback, so their time per block is not comparable with the engine's.
+    NodeTimingStats stats = node.getTiming().getStats();
+    const double engineLoad = m_latency.getStats().dspLoad;
+    stats.share = engineLoad > 0.0 ? stats.load / engineLoad : 0.0;
+    return stats;
+}
+
+std::vector<AudioEngine::NodeTimingReport> AudioEngine::getNodeTimings() const {
+    std::vector<NodeTimingReport> reports;
+    if (!m_graph) return reports;
+    for (const auto& [id, node] : m_graph->getNodes()) reports.push_back({ node, getNodeTiming(*node) });
+    std::sort(reports.begin(), reports.end(), [](const NodeTimingReport& a, const NodeTimingReport& b) {
+        return a.stats.load > b.stats.load;
+    });
+    return reports;
+}
+
+bool AudioEngine::commit(GraphTransaction& transaction) {
+    const uint64_t version = transaction.getGraph().getVersion();
+    if (!transaction.commit()) return false;
+    // Parameter-only batches leave the topology, and so the plan, as it was.
+    if (&transaction.getGraph() == m_graph.get() && m_graph->getVersion() != version) updatePlan();
+    return true;
+}
+
+void AudioEngine::setRenderAhead(bool enabled) {
+    m_renderAhead = enabled;
+    updatePlan();
+}
+
+void AudioEngine::setPipelineStages(int stages) {
+    m_pipelineStages = (std::max)(1, stages);
+    updatePlan();
+}
+
 void AudioEngine::setPlaying(bool playing) {
     m_isPlaying = playing;
-    if (m_graph) {
-        m_graph->setTransportState(playing);
-    }
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetPlaying;
+    command.flag = playing;
+    postCommand(command);
 }
 
 void AudioEngine::rewind() {
@@ -89,76 +355,218 @@ void AudioEngine::rewind() {
 }
 
 void AudioEngine::seek(size_t frame) {
-    if (m_graph) {
-        m_currentFrame = frame;
-        for (auto const& [id, node] : m_graph->getNodes()) {
-            node->onTransportSeek(frame);
+    EngineCommand command;
+    command.type = EngineCommand::Type::Seek;
+    command.frame = frame;
+    postCommand(command);
+}
+
+void AudioEngine::setBypass(const std::shared_ptr<FluxNode>& node, bool bypass) {
+    if (!node) return;
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetBypass;
+    command.flag = bypass;
+    command.node = node.get();
+    postCommand(command, node);
+}
+
+bool AudioEngine::setArmed(const std::shared_ptr<FluxTrackNode>& track, bool armed, const std::string& takePath, PcmFormat format) {
+    if (!track) return false;
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetArmed;
+    command.flag = armed;
+    command.node = track.get();
+
+    if (armed) {
+        if (!track->openTake(takePath, m_sampleRate, format)) return false;
+        if (!postCommand(command, track)) {
+            track->closeTake();
+            return false;
         }
+        updatePlan(); // Armed tracks read the capture block in the real-time pass
+        return true;
     }
+
+    // The take stays open until the audio thread has stopped pushing into it.
+    return postCommand(command, track, [this, track]() {
+        track->closeTake();
+        updatePlan();
+    });
 }
-    
-void AudioEngine::process(float* output, int frames, const MIDIBuffer& midi) {
-    // 1. Capture Input
-    if (m_captureStream && m_inputNode) {
-        int available = SDL_GetAudioStreamAvailable(m_captureStream);
-        if (available > 0) {
-            std::vector<float> captureBuf(available / sizeof(float));
-            SDL_GetAudioStreamData(m_captureStream, captureBuf.data(), available);
-            m_inputNode->pushData(captureBuf.data(), (int)captureBuf.size());
-        }
+
+bool AudioEngine::postCommand(const EngineCommand& command, std::shared_ptr<FluxNode> node, std::function<void()> onApplied) {
+    pollCommands();
+    EngineCommand queued = command;
+    queued.sequence = ++m_nextSequence;
+    if (m_commands.write(&queued, 1) != 1) {
+        --m_nextSequence;
+        std::cerr << "WARNING: AudioEngine command queue full, command dropped." << std::endl;
+        return false;
     }
+    if (node || onApplied) m_pendingCommands.push_back({ queued.sequence, std::move(node), std::move(onApplied) });
+    return true;
+}
 
-    if (!m_isPlaying || !m_stream) {
-        return;
+void AudioEngine::pollCommands() {
+    const uint64_t applied = m_appliedSequence.load(std::memory_order_acquire);
+    while (!m_pendingCommands.empty() && m_pendingCommands.front().sequence <= applied) {
+        PendingCommand done = std::move(m_pendingCommands.front());
+        m_pendingCommands.pop_front();
+        if (done.onApplied) done.onApplied();
     }
+    if (isPlanStale()) updatePlan();
+}
 
-    for (auto& lane : m_automationLanes) {
-        lane->applyAt(m_currentFrame);
+bool AudioEngine::isPlanStale() const {
+    if (!m_graph) return false;
+    if (getBlockFrames() != m_planBlockFrames) return true;
+    // Plan latency (delay compensation, pipeline reporting) is fixed when the plan is compiled.
+    std::shared_ptr<ActivePlan> active = m_active.load();
+    if (!active) return false;
+    for (const auto& [node, latency] : active->latencies) {
+        if (node->getLatencyFrames() != latency) return true;
     }
+    return false;
+}
 
-    const int MAX_QUEUED_BYTES = 20000; 
-    if (SDL_GetAudioStreamQueued(m_stream) > MAX_QUEUED_BYTES) {
-        return;
+void AudioEngine::applyCommands(const ActivePlan* active) {
+    EngineCommand command;
+    bool changed = false;
+    while (m_commands.read(&command, 1) == 1) {
+        switch (command.type) {
+            case EngineCommand::Type::SetPlaying:
+                applyPlaying(active, command.flag);
+                break;
+            case EngineCommand::Type::Seek:
+                applySeek(active, command.frame);
+                break;
+            case EngineCommand::Type::SetBypass:
+                command.node->setBypass(command.flag);
+                break;
+            case EngineCommand::Type::SetArmed:
+                static_cast<FluxTrackNode*>(command.node)->setRecording(command.flag, m_transportPlaying);
+                break;
+        }
+        m_appliedSequence.store(command.sequence, std::memory_order_release);
+        changed = true;
     }
+    if (changed) publishTransport();
+}
 
-    std::shared_ptr<RenderPlan> plan = m_activePlan.load();
+void AudioEngine::applyPlaying(const ActivePlan* active, bool playing) {
+    m_transportPlaying = playing;
+    if (!active) return;
+    for (const RenderPlan* plan : { &active->renderer->getLivePlan(), &active->renderer->getAheadPlan() }) {
+        for (const auto& exec : plan->sequence) exec.node->onTransportStateChanged(playing);
+    }
+    // Re-render from the playhead so edits made while stopped are heard.
+    if (playing) active->renderer->reset(m_currentFrame);
+    active->renderer->setPlaying(playing);
+}
+
+void AudioEngine::applySeek(const ActivePlan* active, size_t frame) {
+    m_currentFrame = frame;
+    if (!active) return;
+    // The render-ahead worker seeks its own nodes when it picks up the reset.
+    for (const auto& exec : active->renderer->getLivePlan().sequence) exec.node->onTransportSeek(frame);
+    active->renderer->reset(frame);
+    if (active->pipeline) active->pipeline->reset();
+}
 
-    if (plan) {
-        for (const auto& op : plan->clearOps) {
-            float* buf = op.node->getInputBuffer(op.portIdx);
-            std::fill(buf, buf + frames * m_channels, 0.0f);
+void AudioEngine::publishTransport() {
+    m_transport.publish({ m_currentFrame, TransportSnapshot::nowNs(), m_transportPlaying,
+                          (size_t)m_blockFrames.load(std::memory_order_relaxed) });
+}
+    
+void AudioEngine::process(float* output, int frames, const MIDIBuffer& midi) {
+    FLUX_TRACE_SCOPE("AudioEngine::process");
+    FLUX_RT_SCOPE();
+    std::shared_ptr<ActivePlan> active = m_active.load();
+    applyCommands(active.get());
+
+    // Capture arrives through onCaptureAvailable; InputNode hands it to the plan.
+    if (!m_transportPlaying || !m_stream) {
+        m_latency.onIdle();
+        return;
+    }
+
+    // Keep the device queue at the depth the latency controller currently targets.
+    int queuedBytes = 0;
+    {
+        FLUX_RT_ALLOW(); // SDL locks the stream internally
+        queuedBytes = SDL_GetAudioStreamQueued(m_stream);
+    }
+    const size_t queuedFrames = queuedBytes > 0 ? (size_t)queuedBytes / (sizeof(float) * m_channels) : 0;
+    const bool render = m_latency.shouldRender(queuedFrames);
+    if (m_latency.getUnderrunCount() != m_tracedUnderruns) {
+        m_tracedUnderruns = m_latency.getUnderrunCount();
+        Tracer::instance().notifyXrun();
+    }
+    if (!render) {
+        return;
+    }
+    const uint64_t blockStart = LatencyController::nowNs();
+    const bool rendered = renderPlan(active.get(), output, frames, midi);
+    double load = 0.0;
+    if (rendered) {
+        {
+            FLUX_RT_ALLOW();
+            SDL_PutAudioStreamData(m_stream, output, frames * m_channels * sizeof(float));
         }
+        load = m_latency.endBlock(blockStart, frames);
+        if (load > 1.0) Tracer::instance().notifyXrun();
+    }
+    if (active) {
+        // The render-ahead worker's time is not in this thread's DSP time; a block it kept
+        // the real-time side waiting for counts as late all the same.
+        const bool aheadLate = active->renderer->takeLateBlocks() > 0;
+        if (aheadLate) load = (std::max)(load, LoadGovernor::kLateLoad);
+        if (rendered || aheadLate) {
+            const std::array<const RenderPlan*, 2> plans = { &active->renderer->getLivePlan(), &active->renderer->getAheadPlan() };
+            m_governor.update(load, active.get(), active->maxQualityTier, plans);
+        }
+    }
+    if (!rendered) return;
 
-        for (auto& exec : plan->sequence) {
-            exec.node->setCurrentFrame(m_currentFrame);
-            
-            if (!midi.getEvents().empty()) {
-                exec.node->processMIDI(midi);
-            }
+    m_currentFrame += frames;
+    publishTransport();
+}
 
-            if (!exec.node->isBypassed()) {
-                exec.node->process(frames);
-            } else {
-                for (int i = 0; i < (int)exec.node->getOutputPorts().size(); ++i) {
-                    float* buf = exec.node->getOutputBuffer(i);
-                    std::fill(buf, buf + frames * m_channels, 0.0f);
-                }
-            }
+bool AudioEngine::renderBlock(float* output, int frames, const MIDIBuffer& midi) {
+    FLUX_RT_SCOPE();
+    std::shared_ptr<ActivePlan> active = m_active.load();
+    applyCommands(active.get());
+    if (!m_transportPlaying || !renderPlan(active.get(), output, frames, midi)) return false;
+
+    m_currentFrame += frames;
+    publishTransport();
+    return true;
+}
 
-            for (auto& route : exec.outgoingRoutes) {
-                float* src = route.sourceNode->getOutputBuffer(route.sourcePort);
-                float* dst = route.destNode->getInputBuffer(route.destPort);
-                SIMD::add(src, dst, frames * m_channels);
+bool AudioEngine::renderPlan(ActivePlan* active, float* output, int frames, const MIDIBuffer& midi) {
+    m_blockFrames.store(frames, std::memory_order_relaxed); // The UI side recompiles if this changes
+    if (active) {
+        AnticipativeRenderer& renderer = *active->renderer;
+        // Wait (without blocking) until the render-ahead part has reached the playhead.
+        if (!renderer.isReady(m_currentFrame, frames)) return false;
+
+        if (active->pipeline) {
+            // Each stage applies its own lanes at the frame it renders.
+            active->pipeline->process(frames, m_currentFrame, &midi);
+        } else {
+            for (auto& lane : renderer.getLiveLanes()) {
+                lane->applyAt(m_currentFrame);
             }
+            const RenderPlan& plan = renderer.getLivePlan();
+            PlanExecutor::clearInputs(plan, frames, m_channels);
+            renderer.readTaps(m_currentFrame, frames);
+            PlanExecutor::run(plan, frames, m_channels, m_currentFrame, &midi);
         }
     }
 
     float* masterIn = m_masterNode->getInputBuffer(0);
     SIMD::copy(masterIn, output, frames * m_channels);
-
-    SDL_PutAudioStreamData(m_stream, output, frames * m_channels * sizeof(float));
-
-    m_currentFrame += frames;
+    return true;
 }
 
 } // namespace Beam
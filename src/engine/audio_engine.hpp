@@ -4,65 +4,304 @@
 #include "audio_node.hpp"
 #include "flux_graph.hpp"
 #include "render_plan.hpp"
+#include "anticipative_renderer.hpp"
+#include "pipeline_executor.hpp"
 #include "master_node.hpp"
 #include "input_node.hpp"
+#include "lock_free_ring.hpp"
+#include "engine_command.hpp"
+#include "latency_controller.hpp"
+#include "load_governor.hpp"
+#include "pcm_encoder.hpp"
 #include "../session/automation.hpp"
 #include <SDL3/SDL.h>
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <deque>
+#include <functional>
 
 namespace Beam {
 
+class FluxTrackNode;
+
 class AudioEngine {
 public:
     AudioEngine();
     ~AudioEngine();
 
-    bool init(int sampleRate, int channels, const std::string& outputDevice = "", const std::string& inputDevice = "");
+    /**
+     * @brief Opens (or reopens) the devices. A new sample rate or maximum block size
+     * re-prepares every node of the current graph in place (FluxNode::prepare).
+     */
+    bool init(int sampleRate, int channels, const std::string& outputDevice = "", const std::string& inputDevice = "",
+              int maxBlockFrames = kDefaultMaxBlockFrames);
     
+    /**
+     * @brief Sets the rate, channel count and block size and prepares every node, without
+     * opening a device. init() calls it; tests and benchmarks use it with renderBlock().
+     */
+    void prepare(int sampleRate, int channels, int maxBlockFrames = kDefaultMaxBlockFrames);
+
     // Called from audio thread (or main loop), lock-free
     void process(float* output, int frames, const MIDIBuffer& midi = MIDIBuffer());
 
+    /**
+     * @brief Renders the next block into `output` without a device and without output
+     * pacing: commands are applied and the transport advances as in process().
+     * @return False if the transport is stopped or render-ahead has not caught up.
+     */
+    bool renderBlock(float* output, int frames, const MIDIBuffer& midi = MIDIBuffer());
+
     // Called from UI thread to update the active processing plan
     void setGraph(std::shared_ptr<FluxGraph> graph);
     void updatePlan();
+
+    /**
+     * @brief Commits a batch of graph edits and rebuilds the plan once for all of them, or
+     * not at all if the batch only sets parameters.
+     * @return False if the transaction was rejected (see GraphTransaction::getError()).
+     */
+    bool commit(GraphTransaction& transaction);
     
     std::shared_ptr<FluxGraph> getGraph() { return m_graph; }
     std::shared_ptr<MasterNode> getMasterNode() { return m_masterNode; }
 
+    // Transport and node state changes from the UI thread. They are queued as
+    // EngineCommands and take effect at the start of the next block.
     void setPlaying(bool playing);
-    bool isPlaying() const { return m_isPlaying; }
+    bool isPlaying() const { return m_isPlaying; } // Last requested state
     void rewind();
     void seek(size_t frame);
+    void setBypass(const std::shared_ptr<FluxNode>& node, bool bypass);
+
+    /**
+     * @brief Arms a track with a new take at the engine's sample rate, or disarms it. The
+     * take is opened here and finalized once the audio thread has stopped recording into it.
+     */
+    bool setArmed(const std::shared_ptr<FluxTrackNode>& track, bool armed, const std::string& takePath = "",
+                  PcmFormat format = PcmFormat::Int16);
 
-    size_t getCurrentFrame() const { return m_currentFrame; }
+    /**
+     * @brief Releases node references held by applied commands and finishes their UI-side
+     * work (e.g. closing takes), and rebuilds the plan if the engine is now driven with a
+     * different block size than it was compiled for or a node's latency changed (e.g. an
+     * AsyncNodeWrapper adopting the block size). Call once per UI frame.
+     */
+    void pollCommands();
+
+    /** @brief Position and play state as of the last processed block. Any thread. */
+    TransportSnapshot getTransport() const { return m_transport.read(); }
+    size_t getCurrentFrame() const { return m_transport.read().frame; }
+
+    /** @brief Playhead extrapolated to now (by at most one block), for drawing. */
+    size_t getPlayheadFrame() const {
+        const TransportSnapshot transport = m_transport.read();
+        const size_t maxAhead = transport.blockFrames ? transport.blockFrames : (size_t)m_maxBlockFrames;
+        return transport.frameAt(TransportSnapshot::nowNs(), m_sampleRate, maxAhead);
+    }
+
+    int getSampleRate() const { return m_sampleRate; }
+    int getMaxBlockFrames() const { return m_maxBlockFrames; }
+
+    /**
+     * @brief Frames per process() or renderBlock() call, i.e. the device block size, as last
+     * seen by the audio thread; getMaxBlockFrames() before the first block. Any thread.
+     */
+    int getBlockFrames() const {
+        const int frames = m_blockFrames.load(std::memory_order_relaxed);
+        return frames > 0 ? frames : m_maxBlockFrames;
+    }
 
     void addAutomationLane(std::shared_ptr<AutomationLane> lane) {
         m_automationLanes.push_back(lane);
+        updatePlan(); // Lanes are split between the live and render-ahead parts
+    }
+
+    /** @brief Adds several lanes with a single plan rebuild. */
+    void addAutomationLanes(const std::vector<std::shared_ptr<AutomationLane>>& lanes) {
+        m_automationLanes.insert(m_automationLanes.end(), lanes.begin(), lanes.end());
+        updatePlan();
     }
 
+    /**
+     * @brief Renders the parts of the graph that do not depend on live input ahead of
+     * the playhead on a worker thread (see AnticipativeRenderer). On by default.
+     */
+    void setRenderAhead(bool enabled);
+    bool isRenderAhead() const { return m_renderAhead; }
+
+    /** @brief Graph latency reported by the active plan (see FluxNode::getLatencyFrames). */
+    int getLatencyFrames() const {
+        auto active = m_active.load();
+        return active ? active->renderer->getLivePlan().latencyFrames : 0;
+    }
+
+    /** @brief Current live/render-ahead split, e.g. for statistics. */
+    std::shared_ptr<AnticipativeRenderer> getRenderer() const {
+        auto active = m_active.load();
+        return active ? active->renderer : nullptr;
+    }
+
+    /**
+     * @brief Splits the graph into `stages` pipeline stages on their own cores (see
+     * PipelineExecutor); 1 turns pipelining off. Each extra stage adds one block of
+     * latency. Pipelined plans run fully live, without render-ahead.
+     */
+    void setPipelineStages(int stages);
+    int getPipelineStages() const { return m_pipelineStages; }
+
     std::shared_ptr<InputNode> getInputNode() { return m_inputNode; }
 
+    /**
+     * @brief Direct monitoring: while a track is armed, the live input is mixed into a
+     * separate output stream at the device period, bypassing the graph and the queued
+     * playback backlog. Armed tracks then stop passing their input through the graph.
+     */
+    void setDirectMonitoring(bool enabled);
+    bool isDirectMonitoring() const { return m_directMonitoring.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Sets the inserts applied to the direct monitor signal, in order. Called from
+     * the UI thread; the nodes must not also be part of the main graph.
+     */
+    void setMonitorInserts(std::vector<std::shared_ptr<FluxNode>> inserts);
+
+    /**
+     * @brief Output latency, underrun counts and block timing percentiles. Any thread.
+     */
+    LatencyStats getLatencyStats() const { return m_latency.getStats(); }
+
+    /**
+     * @brief Bounds within which the output queue depth adapts to this machine. The capture
+     * backlog follows the upper bound, so input is not skipped while output catches up.
+     */
+    void setLatencyBounds(double minMs, double maxMs) {
+        m_latency.setBounds(minMs, maxMs);
+        if (m_inputNode) m_inputNode->setMaxBacklogMs(m_latency.getMaxLatencyMs());
+    }
+    void resetLatencyStats() { m_latency.resetStats(); }
+
+    /**
+     * @brief Per-node timing (see NodeTiming); switching it off removes the clock reads.
+     */
+    void setProfiling(bool enabled) { NodeTiming::setEnabled(enabled); }
+    bool isProfiling() const { return NodeTiming::isEnabled(); }
+
+    /**
+     * @brief Timing of one node, with its share of the engine's DSP load (both relative to
+     * real time, so nodes rendered ahead in larger blocks compare fairly).
+     */
+    NodeTimingStats getNodeTiming(const FluxNode& node) const;
+
+    struct NodeTimingReport {
+        std::shared_ptr<FluxNode> node;
+        NodeTimingStats stats;
+    };
+
+    /**
+     * @brief Timing of every node in the graph, highest load first. UI thread.
+     */
+    std::vector<NodeTimingReport> getNodeTimings() const;
+
+    /** @brief Mean DSP time per block relative to the block duration, for the global meter. */
+    double getDspLoad() const { return m_latency.getStats().dspLoad; }
+
+    /**
+     * @brief Lets the LoadGovernor lower node quality tiers when blocks near their
+     * deadline (on by default). Disabling returns every node to full quality.
+     */
+    void setLoadShedding(bool enabled) { m_governor.setEnabled(enabled); }
+    bool isLoadShedding() const { return m_governor.isEnabled(); }
+    int getQualityLevel() const { return m_governor.getLevel(); }
+    uint64_t getQualityStepDownCount() const { return m_governor.getStepDownCount(); }
+
+    /** @brief Device period requested from SDL, which bounds direct monitoring latency. */
+    static constexpr int kDevicePeriodFrames = 128;
+
+    /** @brief Largest block process() may be called with unless init() is given another. */
+    static constexpr int kDefaultMaxBlockFrames = 4096;
+
 private:
-    size_t m_currentFrame = 0;
+    // Live/render-ahead split of a compiled plan and, when pipelined, the stage executor
+    struct ActivePlan {
+        std::shared_ptr<AnticipativeRenderer> renderer;
+        std::shared_ptr<PipelineExecutor> pipeline;
+        int maxQualityTier = 0; // Highest tier any node in the plan offers
+        std::vector<std::pair<const FluxNode*, int>> latencies; // Node latencies the plan was compiled with
+    };
+
+    struct MonitorChain {
+        std::vector<std::shared_ptr<FluxNode>> inserts;
+    };
+
+    static void SDLCALL onCaptureAvailable(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount);
+    static void SDLCALL onMonitorRequest(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount);
+    static void promoteDeviceThread();
+
+    bool postCommand(const EngineCommand& command, std::shared_ptr<FluxNode> node = nullptr,
+                     std::function<void()> onApplied = nullptr);
+    void applyCommands(const ActivePlan* active);
+    // Runs the plan for one block at m_currentFrame and copies the master input to output.
+    bool renderPlan(ActivePlan* active, float* output, int frames, const MIDIBuffer& midi);
+    void applyPlaying(const ActivePlan* active, bool playing);
+    void applySeek(const ActivePlan* active, size_t frame);
+    void publishTransport();
+    void prepareNode(FluxNode& node) const;
+    void releaseRemovedNodes(const ActivePlan& old, const RenderPlan& current);
+    bool isMonitoringActive() const;
+    bool isPlanStale() const;
+    void renderMonitor(SDL_AudioStream* stream, int frames);
+
+    size_t m_currentFrame = 0;      // Audio thread; the UI reads m_transport
+    bool m_transportPlaying = false; // Audio thread
     std::vector<std::shared_ptr<AutomationLane>> m_automationLanes;
     
     int m_sampleRate;
     int m_channels;
+    int m_maxBlockFrames = kDefaultMaxBlockFrames;
+    std::atomic<int> m_blockFrames{0}; // Written by the audio thread each block
+    int m_planBlockFrames = 0;         // Block size the active plan was compiled for (UI thread)
     
     std::shared_ptr<FluxGraph> m_graph; // "Model" graph (UI thread)
     size_t m_masterNodeId;
     std::shared_ptr<MasterNode> m_masterNode;
     std::shared_ptr<InputNode> m_inputNode;
 
-    // The active plan used by the audio thread. 
-    // Atomic shared_ptr allows lock-free swapping.
-    std::atomic<std::shared_ptr<RenderPlan>> m_activePlan;
+    // The active plan used by the audio thread. Atomic shared_ptr allows lock-free swapping.
+    std::atomic<std::shared_ptr<ActivePlan>> m_active;
+    bool m_renderAhead = true;
+    int m_pipelineStages = 1;
     
     SDL_AudioStream* m_stream;
     SDL_AudioStream* m_captureStream;
+    std::vector<float> m_captureScratch; // Sized in init(); capture never allocates
+
+    // Direct monitoring: capture callback -> m_monitorRing -> monitor stream callback
+    SDL_AudioStream* m_monitorStream = nullptr;
+    LockFreeRing<float> m_monitorRing;
+    std::vector<float> m_monitorScratch;
+    std::atomic<std::shared_ptr<MonitorChain>> m_monitorChain;
+    std::vector<std::shared_ptr<MonitorChain>> m_retiredMonitorChains; // Released on the UI thread only
+    std::atomic<bool> m_directMonitoring{false};
     std::atomic<bool> m_isPlaying{false};
+
+    // UI -> audio command queue. The UI thread keeps each command's node alive (and its
+    // follow-up pending) until the audio thread reports the sequence number as applied.
+    struct PendingCommand {
+        uint64_t sequence;
+        std::shared_ptr<FluxNode> node;
+        std::function<void()> onApplied;
+    };
+    static constexpr size_t kCommandQueueSize = 256;
+    LockFreeRing<EngineCommand> m_commands{kCommandQueueSize};
+    std::deque<PendingCommand> m_pendingCommands;
+    uint64_t m_nextSequence = 0;
+    std::atomic<uint64_t> m_appliedSequence{0};
+    TransportSeqlock m_transport;
+    LatencyController m_latency;
+    LoadGovernor m_governor;
+    uint64_t m_tracedUnderruns = 0; // Audio thread: underruns already reported to the Tracer
 };
 
 } // namespace Beam
@@ -28,10 +28,39 @@ public:
         
         if (result != MA_SUCCESS) return false;
 
+        m_filePath = filePath;
+        m_targetChannels = targetChannels;
         m_isInitialized = true;
         return true;
     }
 
+    /**
+     * @brief Replaces the underlying file with an equivalent one (e.g. a transcoded PCM copy)
+     * while keeping the current read position. Falls back to the old file on failure.
+     */
+    bool swapSource(const std::string& filePath) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_isInitialized) return false;
+
+        ma_uint64 cursor = 0;
+        ma_decoder_get_cursor_in_pcm_frames(&m_decoder, &cursor);
+        ma_decoder_uninit(&m_decoder);
+
+        ma_decoder_config config = ma_decoder_config_init(ma_format_f32, (ma_uint32)m_targetChannels, 0);
+        bool swapped = ma_decoder_init_file(filePath.c_str(), &config, &m_decoder) == MA_SUCCESS;
+        if (swapped) {
+            m_filePath = filePath;
+        } else if (ma_decoder_init_file(m_filePath.c_str(), &config, &m_decoder) != MA_SUCCESS) {
+            m_isInitialized = false;
+            return false;
+        }
+
+        ma_decoder_seek_to_pcm_frame(&m_decoder, cursor);
+        return swapped;
+    }
+
+    const std::string& getFilePath() const { return m_filePath; }
+
     void close() {
         if (m_isInitialized) {
             ma_decoder_uninit(&m_decoder);
@@ -110,6 +139,8 @@ public:
 private:
     ma_decoder m_decoder;
     bool m_isInitialized;
+    std::string m_filePath;
+    int m_targetChannels = 2;
     std::mutex m_mutex;
 };
 
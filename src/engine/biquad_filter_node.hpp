@@ -20,15 +20,30 @@ public:
     BiquadFilterNode(FilterType type, float frequency, float q, float sampleRate) 
         : m_type(type), m_frequency(frequency), m_q(q), m_sampleRate(sampleRate), m_gain(0.0f) {
         calculateCoefficients();
+        reset(2);
+    }
+
+    /**
+     * @brief Recalculates the coefficients for a new rate and clears the filter state.
+     */
+    void setSampleRate(float sampleRate) {
+        m_sampleRate = sampleRate;
+        calculateCoefficients();
+        reset((int)m_x1.size());
+    }
+
+    /**
+     * @brief Clears the state and sizes it for `channels`, so process() does not have to.
+     */
+    void reset(int channels) {
+        m_x1.assign(channels, 0.0f);
+        m_x2.assign(channels, 0.0f);
+        m_y1.assign(channels, 0.0f);
+        m_y2.assign(channels, 0.0f);
     }
 
     void process(float* buffer, int frames, int channels, size_t startFrame = 0) override {
-        if (m_x1.size() != (size_t)channels) {
-            m_x1.assign(channels, 0.0f);
-            m_x2.assign(channels, 0.0f);
-            m_y1.assign(channels, 0.0f);
-            m_y2.assign(channels, 0.0f);
-        }
+        if (m_x1.size() < (size_t)channels) reset(channels);
 
         for (int i = 0; i < frames; ++i) {
             for (int c = 0; c < channels; ++c) {
@@ -51,7 +66,6 @@ public:
     // Single sample processing for mono/legacy use (assumes channel 0)
     // WARN: Use with caution on interleaved data
     float process(float input) {
-        if (m_x1.empty()) { m_x1.resize(1,0); m_x2.resize(1,0); m_y1.resize(1,0); m_y2.resize(1,0); }
         float x = input;
         float y = (m_b0 / m_a0) * x + (m_b1 / m_a0) * m_x1[0] + (m_b2 / m_a0) * m_x2[0]
                   - (m_a1 / m_a0) * m_y1[0] - (m_a2 / m_a0) * m_y2[0];
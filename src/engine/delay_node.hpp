@@ -3,6 +3,7 @@
 
 #include "audio_node.hpp"
 #include "dsp_utils.hpp"
+#include "realtime_thread.hpp"
 #include <vector>
 
 namespace Beam {
@@ -10,14 +11,31 @@ namespace Beam {
 class DelayNode : public AudioNode {
 public:
     DelayNode(float maxDelaySeconds, float feedback, float sampleRate) 
-        : m_feedback(feedback), m_sampleRate(sampleRate), m_writePtr(0) {
-        size_t maxSamples = static_cast<size_t>(maxDelaySeconds * sampleRate);
+        : m_feedback(feedback), m_maxDelaySeconds(maxDelaySeconds), m_delaySeconds(maxDelaySeconds * 0.5f) { // Default to half max
+        prepare(sampleRate);
+    }
+
+    /**
+     * @brief Reallocates the line for `sampleRate` and clears it. Not while processing.
+     */
+    void prepare(float sampleRate) {
+        m_sampleRate = sampleRate;
+        m_writePtr = 0;
+        size_t maxSamples = static_cast<size_t>(m_maxDelaySeconds * sampleRate);
         // Ensure buffer is large enough and multiple of channels (2 for stereo)
-        m_buffer.resize(maxSamples * 2, 0.0f); 
-        setDelayTime(maxDelaySeconds * 0.5f); // Default to half max
+        m_buffer.assign(maxSamples * 2, 0.0f);
+        setDelayTime(m_delaySeconds);
+    }
+
+    /**
+     * @brief Frees the line; prepare() must be called before the next process().
+     */
+    void release() {
+        RealtimeBuffer().swap(m_buffer);
     }
 
     void setDelayTime(float seconds) {
+        m_delaySeconds = seconds;
         m_delaySamples = static_cast<size_t>(seconds * m_sampleRate);
         size_t maxDelay = m_buffer.size() / 2;
         if (m_delaySamples >= maxDelay) m_delaySamples = maxDelay - 1;
@@ -69,9 +87,13 @@ public:
 
     std::string getName() const override { return "Delay"; }
 
+    void prefault() { RealtimeThread::prefault(m_buffer); }
+
 private:
-    std::vector<float> m_buffer;
+    RealtimeBuffer m_buffer;
     float m_feedback;
+    float m_maxDelaySeconds;
+    float m_delaySeconds;
     float m_sampleRate;
     size_t m_writePtr;
     size_t m_delaySamples;
@@ -1,21 +1,150 @@
 #include "disk_streamer.hpp"
+#include "transcode_cache.hpp"
+#include "trace.hpp"
 #include <iostream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 namespace Beam {
 
-DiskStreamer::DiskStreamer(size_t bufferSize) 
-    : m_bufferSize(bufferSize), m_reader(std::make_unique<AudioReader>()) {}
+namespace {
+
+const size_t PREFETCH_CHUNK_FRAMES = 4096;
+const size_t PREFETCH_MIN_FRAMES = 1024;
+
+/**
+ * Single background thread that keeps every open streamer's prefetch ring topped up.
+ */
+class DiskIOThread {
+public:
+    static DiskIOThread& instance() {
+        static DiskIOThread inst;
+        return inst;
+    }
+
+    ~DiskIOThread() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    void add(DiskStreamer* streamer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_thread.joinable()) m_thread = std::thread(&DiskIOThread::run, this);
+        m_streamers.push_back(streamer);
+        ++m_listVersion;
+    }
+
+    // Blocks until the streamer is no longer being serviced.
+    void remove(DiskStreamer* streamer) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_streamers.erase(std::remove(m_streamers.begin(), m_streamers.end(), streamer), m_streamers.end());
+        ++m_listVersion;
+        m_idle.wait(lock, [&]() { return m_current != streamer; });
+    }
+
+private:
+    DiskIOThread() = default;
+
+    // The list is copied under the lock and the disk reads run outside it, so add()
+    // and remove() from the UI thread never wait behind a refill of other streamers.
+    void run() {
+        Tracer::instance().setThreadName("Disk I/O");
+        std::vector<DiskStreamer*> pass;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            pass.assign(m_streamers.begin(), m_streamers.end());
+            const uint64_t version = m_listVersion;
+            for (auto* streamer : pass) {
+                if (m_stop) break;
+                // Skip anything removed since the copy
+                if (m_listVersion != version &&
+                    std::find(m_streamers.begin(), m_streamers.end(), streamer) == m_streamers.end()) continue;
+                m_current = streamer;
+                lock.unlock();
+                streamer->serviceIO();
+                lock.lock();
+                m_current = nullptr;
+                m_idle.notify_all();
+            }
+            m_cv.wait_for(lock, std::chrono::milliseconds(2));
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idle;
+    std::vector<DiskStreamer*> m_streamers;
+    uint64_t m_listVersion = 0;
+    DiskStreamer* m_current = nullptr; // Being serviced outside the lock
+    std::thread m_thread;
+    bool m_stop = false;
+};
+
+} // namespace
+
+DiskStreamer::DiskStreamer(size_t bufferSize)
+    : m_bufferSize(bufferSize), m_reader(std::make_shared<AudioReader>()) {}
 
 DiskStreamer::~DiskStreamer() {
     close();
 }
 
 bool DiskStreamer::open(const std::string& filePath, int channels) {
+    close();
     m_filePath = filePath;
-    return m_reader->open(filePath, channels);
+    m_channels = channels;
+    bool compressed = TranscodeCache::isCompressed(filePath);
+    m_servingPCM = std::make_shared<std::atomic<bool>>(!compressed);
+
+    if (!m_reader->open(filePath, channels)) return false;
+
+    // The timeline is only ever served from the prefetch ring, so it needs its own reader.
+    m_prefetchReader = std::make_shared<AudioReader>();
+    if (!m_prefetchReader->open(filePath, channels)) {
+        std::cerr << "DiskStreamer: cannot open a prefetch reader for " << filePath << std::endl;
+        m_prefetchReader.reset();
+        m_reader->close();
+        return false;
+    }
+
+    if (compressed) {
+        // Decode once in the background, then swap the readers onto the PCM copy.
+        // The callback may outlive this streamer, so it only holds weak references.
+        std::weak_ptr<AudioReader> weakReader = m_reader;
+        std::weak_ptr<AudioReader> weakPrefetch = m_prefetchReader;
+        auto flag = m_servingPCM;
+        TranscodeCache::instance().request(filePath, [weakReader, weakPrefetch, flag](const std::string& cachedPath) {
+            if (auto prefetch = weakPrefetch.lock()) prefetch->swapSource(cachedPath);
+            if (auto reader = weakReader.lock()) {
+                if (reader->swapSource(cachedPath)) flag->store(true);
+            }
+        });
+    }
+
+    m_ring.resize(m_bufferSize * channels);
+    m_fillScratch.assign(PREFETCH_CHUNK_FRAMES * channels, 0.0f);
+    m_fillGen = UINT32_MAX;
+    m_fillReaderPos = 0;
+    m_syncedGen = UINT32_MAX;
+    m_playFrame = 0;
+    DiskIOThread::instance().add(this);
+    m_registered = true;
+    return true;
 }
 
 void DiskStreamer::close() {
+    if (m_registered) {
+        DiskIOThread::instance().remove(this);
+        m_registered = false;
+    }
+    if (m_prefetchReader) m_prefetchReader->close();
     if (m_reader) m_reader->close();
 }
 
@@ -24,17 +153,143 @@ size_t DiskStreamer::read(float* output, size_t frames, int channels) {
     return m_reader->readFrames(output, frames, channels);
 }
 
+size_t DiskStreamer::readTimeline(float* output, size_t frames, int channels, uint64_t timelineFrame, bool wait) {
+    if (!m_registered || channels != m_channels) {
+        std::fill(output, output + frames * channels, 0.0f);
+        return frames;
+    }
+
+    // A jump the prefetcher was already told about (via seek) needs no new request.
+    bool jumped = timelineFrame != m_playFrame && m_requestFrame.load(std::memory_order_acquire) != timelineFrame;
+    if (m_mapDirty.exchange(false, std::memory_order_acq_rel) || jumped) {
+        requestPrefetch(timelineFrame);
+    }
+    m_playFrame = timelineFrame + frames;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait ? kMaxWaitMs : 0);
+    for (;;) {
+        // Adopt the I/O thread's answer to the latest request once it has started on it.
+        uint32_t gen = m_requestGen.load(std::memory_order_acquire);
+        if (m_syncedGen != gen && m_servedGen.load(std::memory_order_acquire) == gen) {
+            uint64_t startIndex = m_genStartIndex.load(std::memory_order_acquire);
+            uint64_t startFrame = m_genStartFrame.load(std::memory_order_acquire);
+            if (m_servedGen.load(std::memory_order_acquire) == gen) {
+                m_ring.skipTo(startIndex);
+                m_ringFrame = startFrame;
+                m_syncedGen = gen;
+            }
+        }
+
+        if (m_syncedGen == gen && m_ringFrame <= timelineFrame) {
+            // Drop anything prefetched for blocks that were already served (as silence).
+            uint64_t behind = (timelineFrame - m_ringFrame) * channels;
+            if (behind > 0) {
+                size_t available = m_ring.availableToRead();
+                size_t skip = (size_t)(std::min)(behind, (uint64_t)(available - available % channels));
+                m_ring.skipTo(m_ring.getReadIndex() + skip);
+                m_ringFrame += skip / channels;
+            }
+
+            size_t needed = frames * channels;
+            if (m_ringFrame == timelineFrame && m_ring.availableToRead() >= needed) {
+                m_ring.read(output, needed);
+                m_ringFrame += frames;
+                return frames;
+            }
+        }
+
+        // Non-real-time callers give the I/O thread (one pass every 2 ms) time to catch up.
+        if (!wait || std::chrono::steady_clock::now() >= deadline) break;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    // The ring is behind (e.g. just after a seek or a new region map): play silence
+    // rather than reading from disk here, and count the underrun.
+    m_underruns.fetch_add(1, std::memory_order_relaxed);
+    std::fill(output, output + frames * channels, 0.0f);
+    return frames;
+}
+
 void DiskStreamer::seek(size_t frame) {
-    if (m_reader) m_reader->seek(frame);
+    requestPrefetch(frame);
 }
 
-std::vector<std::vector<float>> DiskStreamer::getPeakData(int numPoints) {
-    if (m_reader) return m_reader->getPeakData(numPoints);
-    return {};
+void DiskStreamer::requestPrefetch(uint64_t timelineFrame) {
+    m_requestFrame.store(timelineFrame, std::memory_order_release);
+    m_requestGen.fetch_add(1, std::memory_order_acq_rel);
 }
 
-} // namespace Beam
+void DiskStreamer::setRegionMap(std::shared_ptr<const RegionMap> map) {
+    // Previous maps may still be held by the audio or I/O thread for a block;
+    // keeping them here means the last reference is always dropped on this thread.
+    m_retiredMaps.push_back(m_regionMap.exchange(std::move(map), std::memory_order_acq_rel));
+    m_retiredMaps.erase(std::remove_if(m_retiredMaps.begin(), m_retiredMaps.end(),
+                                       [](const auto& m) { return !m || m.use_count() == 1; }),
+                        m_retiredMaps.end());
+    m_mapDirty.store(true, std::memory_order_release);
+}
+
+void DiskStreamer::serviceIO() {
+    if (!m_prefetchReader) return;
+
+    const size_t channels = (size_t)m_channels;
+    for (int chunk = 0; chunk < 8; ++chunk) {
+        uint32_t gen = m_requestGen.load(std::memory_order_acquire);
+        if (gen != m_fillGen) {
+            m_fillGen = gen;
+            m_fillFrame = m_requestFrame.load(std::memory_order_acquire);
+            m_ring.discardTo(m_ring.getWriteIndex()); // Make room for the new position
+            m_genStartIndex.store(m_ring.getWriteIndex(), std::memory_order_relaxed);
+            m_genStartFrame.store(m_fillFrame, std::memory_order_relaxed);
+            m_servedGen.store(gen, std::memory_order_release);
+        }
 
+        size_t frames = (std::min)(PREFETCH_CHUNK_FRAMES, m_ring.availableToWrite() / channels);
+        if (frames < PREFETCH_MIN_FRAMES) break;
 
+        FLUX_TRACE_SCOPE("Disk Refill");
+        auto map = m_regionMap.load(std::memory_order_acquire);
+        renderRange(*m_prefetchReader, map.get(), m_fillCursor, m_fillReaderPos, m_fillScratch.data(), frames, m_fillFrame);
+        m_ring.write(m_fillScratch.data(), frames * channels);
+        m_fillFrame += frames;
+    }
+}
+
+size_t DiskStreamer::renderRange(AudioReader& reader, const RegionMap* map, RegionMap::Cursor& cursor, uint64_t& readerPos,
+                                 float* out, size_t frames, uint64_t timelineFrame) {
+    const size_t channels = (size_t)m_channels;
+    size_t done = 0;
+    while (done < frames) {
+        size_t remaining = frames - done;
+        float* dst = out + done * channels;
+
+        // Without a region map the timeline plays the source from frame 0.
+        RegionMap::Span span = map ? map->spanAt(cursor, timelineFrame + done)
+                                   : RegionMap::Span{ UINT64_MAX, true, timelineFrame + done };
+        size_t n = (size_t)(std::min)((uint64_t)remaining, span.frames);
+
+        if (!span.audible) {
+            std::fill(dst, dst + n * channels, 0.0f);
+        } else {
+            if (readerPos != span.sourceFrame) {
+                reader.seek((size_t)span.sourceFrame);
+                readerPos = span.sourceFrame;
+            }
+            size_t got = reader.readFrames(dst, n, (int)channels);
+            readerPos += got;
+            if (got < n) {
+                std::fill(dst + got * channels, dst + n * channels, 0.0f);
+                readerPos = UINT64_MAX; // End of source: re-seek next time
+            }
+        }
+        done += n;
+    }
+    return frames;
+}
 
+std::vector<std::vector<float>> DiskStreamer::getPeakData(int numPoints) {
+    if (m_reader) return m_reader->getPeakData(numPoints);
+    return {};
+}
 
+} // namespace Beam
@@ -6,44 +6,122 @@
 #include <memory>
 #include <atomic>
 #include "audio_reader.hpp"
+#include "lock_free_ring.hpp"
+#include "region_scheduler.hpp"
 
 namespace Beam {
 
 /**
  * @class DiskStreamer
  * @brief Manages audio data retrieval from disk using AudioReader.
+ *
+ * Compressed sources are handed to the TranscodeCache on open; once the PCM copy
+ * is ready the reader is switched over to it in place.
+ *
+ * Playback is addressed in timeline frames. A shared I/O thread renders ahead of
+ * the playhead through the track's RegionMap (or linearly if none is set) into a
+ * lock-free ring, using its own reader so region boundaries are read from disk
+ * before the audio thread reaches them. If the ring cannot serve a block (e.g.
+ * right after a seek), the block is silent and the underrun is counted; the
+ * audio thread never reads from disk. Callers off the real-time path (render-ahead,
+ * offline export) ask readTimeline() to wait for the ring instead.
  */
 class DiskStreamer {
 public:
     DiskStreamer(size_t bufferSize = 44100 * 2);
     ~DiskStreamer();
 
+    /**
+     * @brief Opens a file for streaming. Compressed formats play from the source
+     * until the transcoded PCM cache file becomes available.
+     */
     bool open(const std::string& filePath, int channels = 2);
     void close();
 
+    /**
+     * @brief Reads source frames linearly from the current source position.
+     */
     size_t read(float* output, size_t frames, int channels);
-    
+
+    /**
+     * @brief Fills `frames` frames of timeline audio starting at `timelineFrame`. Gaps between
+     * regions and the area past the end of the source are silent.
+     * @param wait False on the audio thread: a block the ring cannot serve is silent. True
+     * for non-real-time callers: waits (up to kMaxWaitMs) for the I/O thread to serve it.
+     */
+    size_t readTimeline(float* output, size_t frames, int channels, uint64_t timelineFrame, bool wait = false);
+
+    static constexpr int kMaxWaitMs = 1000;
+
     /**
-     * @brief Seeks to an absolute frame position in the source file.
+     * @brief Restarts prefetching at a timeline frame (safe from any thread).
      */
     void seek(size_t frame);
 
+    /**
+     * @brief Publishes a new region layout. Call from the UI thread; prefetch restarts at the playhead.
+     */
+    void setRegionMap(std::shared_ptr<const RegionMap> map);
+
+    /**
+     * @brief I/O thread: tops up the prefetch ring.
+     */
+    void serviceIO();
+
     std::vector<std::vector<float>> getPeakData(int numPoints);
 
     uint64_t getTotalFrames() const { return m_reader ? m_reader->getTotalFrames() : 0; }
 
+    /**
+     * @brief True once playback is served from an uncompressed PCM file.
+     */
+    bool isServingPCM() const { return m_servingPCM && m_servingPCM->load(); }
+
+    /**
+     * @brief Number of blocks the prefetcher could not supply in time.
+     */
+    uint64_t getUnderrunCount() const { return m_underruns.load(std::memory_order_relaxed); }
+
 private:
+    void requestPrefetch(uint64_t timelineFrame);
+    size_t renderRange(AudioReader& reader, const RegionMap* map, RegionMap::Cursor& cursor, uint64_t& readerPos,
+                       float* out, size_t frames, uint64_t timelineFrame);
+
     std::string m_filePath;
-    std::unique_ptr<AudioReader> m_reader;
     size_t m_bufferSize;
+    int m_channels = 2;
+    std::shared_ptr<AudioReader> m_reader;          // Linear reads and file info
+    std::shared_ptr<AudioReader> m_prefetchReader;  // I/O thread reads
+    std::shared_ptr<std::atomic<bool>> m_servingPCM; // Shared with the transcode callback
+    bool m_registered = false;
+
+    std::atomic<std::shared_ptr<const RegionMap>> m_regionMap;
+    std::vector<std::shared_ptr<const RegionMap>> m_retiredMaps; // Released on the UI thread only
+    std::atomic<bool> m_mapDirty{false};
+
+    LockFreeRing<float> m_ring;
+
+    // Prefetch requests (any thread) and their acknowledgement (I/O thread)
+    std::atomic<uint64_t> m_requestFrame{0};
+    std::atomic<uint32_t> m_requestGen{0};
+    std::atomic<uint32_t> m_servedGen{0};
+    std::atomic<uint64_t> m_genStartIndex{0};
+    std::atomic<uint64_t> m_genStartFrame{0};
+
+    // Audio thread state
+    uint64_t m_playFrame = 0;
+    uint64_t m_ringFrame = 0;
+    uint32_t m_syncedGen = UINT32_MAX;
+    std::atomic<uint64_t> m_underruns{0};
+
+    // I/O thread state
+    uint32_t m_fillGen = UINT32_MAX;
+    uint64_t m_fillFrame = 0;
+    RegionMap::Cursor m_fillCursor;
+    uint64_t m_fillReaderPos = 0;
+    std::vector<float> m_fillScratch;
 };
 
 } // namespace Beam
 
 #endif // DISK_STREAMER_HPP
-
-
-
-
-
-
@@ -0,0 +1,106 @@
+#ifndef ENGINE_COMMAND_HPP
+#define ENGINE_COMMAND_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace Beam {
+
+class FluxNode;
+
+/**
+ * @struct EngineCommand
+ * @brief A state change sent from the UI thread to the audio thread.
+ *
+ * Commands travel through a preallocated LockFreeRing and are applied by
+ * AudioEngine::process() at the start of a block, so nodes never see a seek
+ * or transport change in the middle of processing. The node pointer is kept
+ * alive by the sender until the audio thread reports the command as applied,
+ * which means the last reference is always released on the UI thread.
+ */
+struct EngineCommand {
+    enum class Type : uint8_t {
+        SetPlaying, // flag
+        Seek,       // frame
+        SetBypass,  // node, flag
+        SetArmed,   // node (FluxTrackNode), flag: switch between recording and playback
+    };
+
+    Type type = Type::SetPlaying;
+    uint64_t sequence = 0;   // Assigned by the sender, in order
+    size_t frame = 0;
+    bool flag = false;
+    FluxNode* node = nullptr;
+};
+
+/**
+ * @struct TransportSnapshot
+ * @brief Transport position as published by the audio thread after each block.
+ */
+struct TransportSnapshot {
+    size_t frame = 0;        // Playhead at the end of the last processed block
+    uint64_t timestampNs = 0; // steady_clock time the block finished
+    bool playing = false;
+    size_t blockFrames = 0;   // Length of the last processed block; 0 before the first
+
+    /**
+     * @brief Playhead extrapolated to `nowNs` for smooth drawing. Never runs more than
+     * `maxAheadFrames` past the published frame, so it stops if the engine stalls.
+     */
+    size_t frameAt(uint64_t nowNs, int sampleRate, size_t maxAheadFrames) const {
+        if (!playing || nowNs <= timestampNs) return frame;
+        const uint64_t elapsed = (nowNs - timestampNs) * (uint64_t)sampleRate / 1000000000ull;
+        return frame + (std::min)((size_t)elapsed, maxAheadFrames);
+    }
+
+    static uint64_t nowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+/**
+ * @class TransportSeqlock
+ * @brief Single-writer seqlock around a TransportSnapshot.
+ *
+ * The audio thread publishes without ever waiting; readers retry in the rare
+ * case they overlap a write.
+ */
+class TransportSeqlock {
+public:
+    void publish(const TransportSnapshot& snapshot) {
+        const uint32_t seq = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_frame.store(snapshot.frame, std::memory_order_relaxed);
+        m_timestampNs.store(snapshot.timestampNs, std::memory_order_relaxed);
+        m_playing.store(snapshot.playing, std::memory_order_relaxed);
+        m_sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    TransportSnapshot read() const {
+        TransportSnapshot snapshot;
+        while (true) {
+            const uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1) continue; // Write in progress
+            snapshot.frame = m_frame.load(std::memory_order_relaxed);
+            snapshot.timestampNs = m_timestampNs.load(std::memory_order_relaxed);
+            snapshot.playing = m_playing.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) return snapshot;
+        }
+    }
+
+private:
+    std::atomic<uint32_t> m_sequence{0};
+    std::atomic<size_t> m_frame{0};
+    std::atomic<uint64_t> m_timestampNs{0};
+    std::atomic<bool> m_playing{false};
+};
+
+} // namespace Beam
+
+#endif // ENGINE_COMMAND_HPP
@@ -10,7 +10,7 @@ namespace Beam {
 // --- Standard Gain Plugin ---
 class FluxGainNode : public FluxPlugin {
 public:
-    FluxGainNode(int bufferSize) : FluxPlugin("Gain", bufferSize, 44100.0f) {
+    FluxGainNode(int bufferSize, float sampleRate = 44100.0f) : FluxPlugin("Gain", bufferSize, sampleRate) {
         addParam("Gain", 0.0f, 2.0f, 1.0f);
     }
     
@@ -47,6 +47,11 @@ public:
 
     BiquadFilterNode* getInternalFilter() { return m_filter.get(); }
 
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_filter->setSampleRate(sampleRate);
+    }
+
 private:
     std::unique_ptr<BiquadFilterNode> m_filter;
 };
@@ -71,6 +76,20 @@ public:
         m_delay->process(output, totalSamples / 2, 2);
     }
 
+    void prefault() override {
+        FluxPlugin::prefault();
+        m_delay->prefault();
+    }
+
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_delay->prepare(sampleRate);
+    }
+
+    void onRelease() override {
+        m_delay->release();
+    }
+
 private:
     std::unique_ptr<DelayNode> m_delay;
 };
@@ -4,10 +4,14 @@
 #include "flux_node.hpp"
 #include "render_plan.hpp"
 #include <map>
+#include <vector>
 #include <set>
 #include <algorithm>
 #include <iostream>
 #include <mutex>
+#include <string>
+#include <cstdint>
+#include <limits>
 
 namespace Beam {
 
@@ -25,80 +29,137 @@ struct FluxConnection {
     }
 };
 
+/**
+ * @struct GraphEdit
+ * @brief One change recorded by a GraphTransaction.
+ */
+struct GraphEdit {
+    enum class Type { AddNode, RemoveNode, Connect, Disconnect, SetParameter };
+    Type type;
+    size_t nodeId = 0;
+    std::shared_ptr<FluxNode> node;
+    FluxConnection connection{};
+    std::string parameter;
+    float value = 0.0f;
+};
+
 class FluxGraph {
 public:
+    // Single edits are one-edit transactions (see apply), validated against the graph in place.
     size_t addNode(std::shared_ptr<FluxNode> node) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        size_t id = m_nextId++;
-        m_nodes[id] = node;
-        m_needsRebuild = true;
-        return id;
+        GraphEdit edit{ GraphEdit::Type::AddNode, reserveId(), std::move(node) };
+        std::string error;
+        apply({ edit }, error);
+        return edit.nodeId;
     }
 
-    void removeNode(size_t id) {
+    bool removeNode(size_t id) {
+        std::string error;
+        return apply({ { GraphEdit::Type::RemoveNode, id } }, error);
+    }
+
+    /**
+     * @brief Adds a connection. Fails (and logs) if a node or port does not exist or the
+     * connection would close a cycle.
+     */
+    bool connect(size_t srcNodeId, int srcPort, size_t dstNodeId, int dstPort) {
+        GraphEdit edit{ GraphEdit::Type::Connect };
+        edit.connection = { srcNodeId, srcPort, dstNodeId, dstPort };
+        std::string error;
+        return apply({ edit }, error);
+    }
+
+    bool disconnect(size_t srcNodeId, int srcPort, size_t dstNodeId, int dstPort) {
+        GraphEdit edit{ GraphEdit::Type::Disconnect };
+        edit.connection = { srcNodeId, srcPort, dstNodeId, dstPort };
+        std::string error;
+        return apply({ edit }, error);
+    }
+
+    /**
+     * @brief Validates and applies a batch of edits as one change: either all of them take
+     * effect or none does, and readers never observe a partial state.
+     * Only node and connection edits bump getVersion(); parameter edits leave the plan valid.
+     * @param error Set to the reason when the batch is rejected.
+     */
+    bool apply(const std::vector<GraphEdit>& edits, std::string& error) {
+        if (edits.empty()) return true;
         std::lock_guard<std::mutex> lock(m_mutex);
-        m_nodes.erase(id);
-        // Remove associated connections
-        for (auto it = m_connections.begin(); it != m_connections.end(); ) {
-            if (it->srcNodeId == id || it->dstNodeId == id) {
-                it = m_connections.erase(it);
-            } else {
-                ++it;
+        // A single edit is checked against the graph in place, and so is a batch of parameter
+        // changes. Any other batch may pass through invalid states (e.g. a connection that is
+        // removed again), so it is staged on a copy and the result is sorted as a whole.
+        if (edits.size() == 1) return applyEdit(edits.front(), error);
+        const bool topology = std::any_of(edits.begin(), edits.end(), [](const GraphEdit& edit) {
+            return edit.type != GraphEdit::Type::SetParameter;
+        });
+        if (!topology) return applyParameters(edits, error);
+
+        auto nodes = m_nodes;
+        auto connections = m_connections;
+        std::vector<std::pair<std::shared_ptr<Parameter>, float>> parameters;
+
+        for (const auto& edit : edits) {
+            switch (edit.type) {
+                case GraphEdit::Type::AddNode:
+                    if (!edit.node) return reject(error, "null node");
+                    nodes[edit.nodeId] = edit.node;
+                    break;
+                case GraphEdit::Type::RemoveNode:
+                    if (!nodes.erase(edit.nodeId)) return reject(error, "unknown node " + std::to_string(edit.nodeId));
+                    eraseConnectionsOf(connections, edit.nodeId);
+                    break;
+                case GraphEdit::Type::Connect: {
+                    std::string reason = connectionError(nodes, edit.connection);
+                    if (!reason.empty()) return reject(error, reason);
+                    connections.insert(edit.connection);
+                    break;
+                }
+                case GraphEdit::Type::Disconnect:
+                    connections.erase(edit.connection);
+                    break;
+                case GraphEdit::Type::SetParameter: {
+                    auto param = findParameter(nodes, edit);
+                    if (!param) return reject(error, "unknown parameter " + edit.parameter);
+                    parameters.push_back({ param, edit.value });
+                    break;
+                }
             }
         }
-        m_needsRebuild = true;
-    }
 
-    void connect(size_t srcNodeId, int srcPort, size_t dstNodeId, int dstPort) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_connections.insert({srcNodeId, srcPort, dstNodeId, dstPort});
-        m_needsRebuild = true;
+        if (topologicalOrder(nodes, outgoingConnections(connections)).size() != nodes.size()) {
+            return reject(error, "connection would create a cycle");
+        }
+
+        // Replaced nodes are released here, on the editing thread.
+        m_nodes.swap(nodes);
+        m_connections.swap(connections);
+        for (auto& [param, value] : parameters) param->setValue(value);
+        markChanged();
+        return true;
     }
 
-    void disconnect(size_t srcNodeId, int srcPort, size_t dstNodeId, int dstPort) {
+    /** @brief Reserves a node id for a pending transaction. */
+    size_t reserveId() {
         std::lock_guard<std::mutex> lock(m_mutex);
-        m_connections.erase({srcNodeId, srcPort, dstNodeId, dstPort});
-        m_needsRebuild = true;
+        return m_nextId++;
     }
 
     // Compiles the current graph topology into an optimized, flat execution plan.
     // This method is O(N + C) and should be called from the UI thread when the graph changes.
-    std::shared_ptr<RenderPlan> compile(int bufferSizeFrames, int channels = 2) {
+    // With stages > 1 the plan is also split into pipeline stages (see PipelineExecutor).
+    std::shared_ptr<RenderPlan> compile(int bufferSizeFrames, int channels = 2, int stages = 1) {
         std::lock_guard<std::mutex> lock(m_mutex);
         auto plan = std::make_shared<RenderPlan>();
         
         // 1. Topological Sort
-        std::vector<size_t> schedule;
-        std::map<size_t, int> inDegree;
-        for (auto const& [id, node] : m_nodes) inDegree[id] = 0;
-
-        for (const auto& conn : m_connections) {
-            inDegree[conn.dstNodeId]++;
-        }
-
-        std::vector<size_t> queue;
-        for (auto const& [id, degree] : inDegree) {
-            if (degree == 0) queue.push_back(id);
-        }
-
-        while (!queue.empty()) {
-            size_t u = queue.back();
-            queue.pop_back();
-            schedule.push_back(u);
-
-            for (const auto& conn : m_connections) {
-                if (conn.srcNodeId == u) {
-                    inDegree[conn.dstNodeId]--;
-                    if (inDegree[conn.dstNodeId] == 0) {
-                        queue.push_back(conn.dstNodeId);
-                    }
-                }
-            }
+        const auto outgoing = outgoingConnections(m_connections);
+        std::vector<size_t> schedule = topologicalOrder(m_nodes, outgoing);
+        if (schedule.size() != m_nodes.size()) {
+            // apply() rejects cycles, so nothing should ever be left out here.
+            std::cerr << "FluxGraph: " << (m_nodes.size() - schedule.size()) << " node(s) in a cycle were not scheduled." << std::endl;
         }
 
         // 2. Build Execution Plan
-        size_t bufSizeFloats = bufferSizeFrames * channels;
-
         // Identify all input buffers that need clearing
         for (const auto& [id, node] : m_nodes) {
             for (int i = 0; i < (int)node->getInputPorts().size(); ++i) {
@@ -106,62 +167,326 @@ public:
             }
         }
 
-        // Map ID to Node Ptr for quick lookup
-        std::map<size_t, std::shared_ptr<FluxNode>> nodeLookup = m_nodes;
+        // Latency accumulated at each node's inputs along the slowest upstream path
+        std::map<size_t, int> inputLatency;
 
         for (size_t nodeId : schedule) {
-            auto node = nodeLookup[nodeId];
+            auto node = m_nodes.at(nodeId);
             NodeExecution exec;
             exec.node = node;
+            exec.name = node->getName();
+
+            const int outputLatency = inputLatency[nodeId] + node->getLatencyFrames();
+            plan->latencyFrames = (std::max)(plan->latencyFrames, outputLatency);
 
             // Pre-calculate routing for this node's outputs
-            for (const auto& conn : m_connections) {
-                if (conn.srcNodeId == nodeId) {
-                    auto dstNode = nodeLookup[conn.dstNodeId];
-                    if (dstNode) {
-                        exec.outgoingRoutes.push_back({
-                            node,
-                            conn.srcPortIdx,
-                            dstNode,
-                            conn.dstPortIdx
-                        });
-                    }
+            auto out = outgoing.find(nodeId);
+            if (out != outgoing.end()) {
+                for (const auto& conn : out->second) {
+                    inputLatency[conn.dstNodeId] = (std::max)(inputLatency[conn.dstNodeId], outputLatency);
+                    exec.outgoingRoutes.push_back({
+                        node,
+                        conn.srcPortIdx,
+                        m_nodes.at(conn.dstNodeId),
+                        conn.dstPortIdx
+                    });
                 }
             }
             plan->sequence.push_back(exec);
         }
 
+        // 3. Pipeline stages
+        if (stages > 1) assignStages(*plan, stages, bufferSizeFrames);
+
         m_needsRebuild = false;
         return plan;
     }
 
-    void setTransportState(bool playing) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        for (auto& pair : m_nodes) {
-            pair.second->onTransportStateChanged(playing);
-        }
-    }
-
     std::shared_ptr<FluxNode> getNode(size_t id) {
         std::lock_guard<std::mutex> lock(m_mutex);
         auto it = m_nodes.find(id);
         return (it != m_nodes.end()) ? it->second : nullptr;
     }
 
-    const std::map<size_t, std::shared_ptr<FluxNode>>& getNodes() const {
+    // Snapshots, so callers can iterate while other threads edit the graph.
+    std::map<size_t, std::shared_ptr<FluxNode>> getNodes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
         return m_nodes;
     }
 
-    const std::set<FluxConnection>& getConnections() const {
+    std::set<FluxConnection> getConnections() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
         return m_connections;
     }
 
+    /** @brief Incremented by every applied edit or transaction. */
+    uint64_t getVersion() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_version;
+    }
+
 private:
+    using NodeMap = std::map<size_t, std::shared_ptr<FluxNode>>;
+    using Adjacency = std::map<size_t, std::vector<FluxConnection>>;
+
+    // Applies one edit to the graph itself, without copying it. Adding a node or removing
+    // anything cannot close a cycle; a connection closes one only if its destination already
+    // reaches its source. Caller holds m_mutex.
+    bool applyEdit(const GraphEdit& edit, std::string& error) {
+        switch (edit.type) {
+            case GraphEdit::Type::AddNode:
+                if (!edit.node) return reject(error, "null node");
+                m_nodes[edit.nodeId] = edit.node;
+                break;
+            case GraphEdit::Type::RemoveNode:
+                if (!m_nodes.erase(edit.nodeId)) return reject(error, "unknown node " + std::to_string(edit.nodeId));
+                eraseConnectionsOf(m_connections, edit.nodeId);
+                break;
+            case GraphEdit::Type::Connect: {
+                const FluxConnection& c = edit.connection;
+                std::string reason = connectionError(m_nodes, c);
+                if (!reason.empty()) return reject(error, reason);
+                if (reaches(c.dstNodeId, c.srcNodeId)) return reject(error, "connection would create a cycle");
+                m_connections.insert(c);
+                break;
+            }
+            case GraphEdit::Type::Disconnect:
+                m_connections.erase(edit.connection);
+                break;
+            case GraphEdit::Type::SetParameter: {
+                auto param = findParameter(m_nodes, edit);
+                if (!param) return reject(error, "unknown parameter " + edit.parameter);
+                param->setValue(edit.value);
+                return true; // The topology, and so the plan, is unchanged
+            }
+        }
+        markChanged();
+        return true;
+    }
+
+    // Sets a batch of parameters, all or none; no topology changes. Caller holds m_mutex.
+    bool applyParameters(const std::vector<GraphEdit>& edits, std::string& error) {
+        std::vector<std::pair<std::shared_ptr<Parameter>, float>> parameters;
+        parameters.reserve(edits.size());
+        for (const auto& edit : edits) {
+            auto param = findParameter(m_nodes, edit);
+            if (!param) return reject(error, "unknown parameter " + edit.parameter);
+            parameters.push_back({ param, edit.value });
+        }
+        for (auto& [param, value] : parameters) param->setValue(value);
+        return true;
+    }
+
+    void markChanged() {
+        m_needsRebuild = true;
+        ++m_version;
+    }
+
+    static bool reject(std::string& error, const std::string& reason) {
+        error = reason;
+        std::cerr << "FluxGraph: edit rejected: " << reason << std::endl;
+        return false;
+    }
+
+    // Returns why `c` cannot be made in `nodes` (unknown node or port), or an empty string.
+    static std::string connectionError(const NodeMap& nodes, const FluxConnection& c) {
+        auto src = nodes.find(c.srcNodeId);
+        auto dst = nodes.find(c.dstNodeId);
+        if (src == nodes.end() || dst == nodes.end()) return "connection to an unknown node";
+        if (c.srcPortIdx < 0 || c.srcPortIdx >= (int)src->second->getOutputPorts().size() ||
+            c.dstPortIdx < 0 || c.dstPortIdx >= (int)dst->second->getInputPorts().size()) {
+            return "connection to a missing port of " + dst->second->getName();
+        }
+        return {};
+    }
+
+    static std::shared_ptr<Parameter> findParameter(const NodeMap& nodes, const GraphEdit& edit) {
+        auto it = nodes.find(edit.nodeId);
+        return it != nodes.end() ? it->second->getParameter(edit.parameter) : nullptr;
+    }
+
+    static void eraseConnectionsOf(std::set<FluxConnection>& connections, size_t nodeId) {
+        for (auto it = connections.begin(); it != connections.end(); ) {
+            if (it->srcNodeId == nodeId || it->dstNodeId == nodeId) it = connections.erase(it);
+            else ++it;
+        }
+    }
+
+    // Depth-first search along m_connections, which are ordered by source node, so each
+    // node's outgoing connections are one contiguous range. Visits only what `from` reaches.
+    bool reaches(size_t from, size_t to) const {
+        std::vector<size_t> pending{ from };
+        std::set<size_t> visited{ from };
+        while (!pending.empty()) {
+            size_t u = pending.back();
+            pending.pop_back();
+            if (u == to) return true;
+            const FluxConnection first{ u, (std::numeric_limits<int>::min)(), 0, (std::numeric_limits<int>::min)() };
+            for (auto it = m_connections.lower_bound(first); it != m_connections.end() && it->srcNodeId == u; ++it) {
+                if (visited.insert(it->dstNodeId).second) pending.push_back(it->dstNodeId);
+            }
+        }
+        return false;
+    }
+
+    static Adjacency outgoingConnections(const std::set<FluxConnection>& connections) {
+        Adjacency outgoing;
+        for (const auto& conn : connections) outgoing[conn.srcNodeId].push_back(conn);
+        return outgoing;
+    }
+
+    // Kahn's algorithm over adjacency lists, O(N + C). Nodes on a cycle are left out.
+    static std::vector<size_t> topologicalOrder(const NodeMap& nodes,
+                                                const Adjacency& outgoing) {
+        std::map<size_t, int> inDegree;
+        for (auto const& [id, node] : nodes) inDegree[id] = 0;
+        for (const auto& [src, conns] : outgoing) {
+            for (const auto& conn : conns) inDegree[conn.dstNodeId]++;
+        }
+
+        std::vector<size_t> queue;
+        for (auto const& [id, degree] : inDegree) {
+            if (degree == 0) queue.push_back(id);
+        }
+
+        std::vector<size_t> schedule;
+        while (!queue.empty()) {
+            size_t u = queue.back();
+            queue.pop_back();
+            schedule.push_back(u);
+
+            auto it = outgoing.find(u);
+            if (it == outgoing.end()) continue;
+            for (const auto& conn : it->second) {
+                if (--inDegree[conn.dstNodeId] == 0) queue.push_back(conn.dstNodeId);
+            }
+        }
+        return schedule;
+    }
+
+    // Splits the schedule by dependency depth into up to `stages` groups with roughly equal
+    // node counts, so routes only go from a stage to the same or a later one. Each stage
+    // boundary adds one block of latency.
+    static void assignStages(RenderPlan& plan, int stages, int bufferSizeFrames) {
+        const size_t n = plan.sequence.size();
+        if (n == 0) return;
+
+        std::map<const FluxNode*, size_t> index;
+        for (size_t i = 0; i < n; ++i) index[plan.sequence[i].node.get()] = i;
+
+        std::vector<int> level(n, 0);
+        std::vector<std::vector<size_t>> upstream(n);
+        int maxLevel = 0;
+        for (size_t i = 0; i < n; ++i) {
+            maxLevel = (std::max)(maxLevel, level[i]);
+            for (const auto& route : plan.sequence[i].outgoingRoutes) {
+                size_t j = index[route.destNode.get()];
+                level[j] = (std::max)(level[j], level[i] + 1);
+                upstream[j].push_back(i);
+            }
+        }
+
+        std::vector<int> nodesAtLevel(maxLevel + 1, 0);
+        for (int l : level) nodesAtLevel[l]++;
+        std::vector<int> stageOfLevel(maxLevel + 1, 0);
+        size_t before = 0;
+        for (int l = 0; l <= maxLevel; ++l) {
+            stageOfLevel[l] = (int)(std::min)((size_t)stages - 1, before * stages / n);
+            before += nodesAtLevel[l];
+        }
+        for (size_t i = 0; i < n; ++i) plan.sequence[i].stage = stageOfLevel[level[i]];
+
+        // Live sources (and armed tracks reading them directly) share buffers outside the
+        // routes, so they and everything upstream of them stay in the first stage.
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < n; ++i) {
+            if (plan.sequence[i].node->isLiveSource()) pending.push_back(i);
+        }
+        while (!pending.empty()) {
+            size_t i = pending.back();
+            pending.pop_back();
+            plan.sequence[i].stage = 0;
+            for (size_t u : upstream[i]) {
+                if (plan.sequence[u].stage != 0) pending.push_back(u);
+            }
+        }
+
+        plan.numStages = 1;
+        for (const auto& exec : plan.sequence) plan.numStages = (std::max)(plan.numStages, exec.stage + 1);
+        plan.latencyFrames += (plan.numStages - 1) * bufferSizeFrames;
+    }
+
     std::map<size_t, std::shared_ptr<FluxNode>> m_nodes;
     std::set<FluxConnection> m_connections;
     size_t m_nextId = 0;
     bool m_needsRebuild = true;
-    std::mutex m_mutex;
+    uint64_t m_version = 0;
+    mutable std::mutex m_mutex;
+};
+
+/**
+ * @class GraphTransaction
+ * @brief Collects node, connection and parameter edits and commits them as one change.
+ *
+ * Nothing is visible until commit(), which validates the whole batch (unknown
+ * nodes or ports, cycles) against the graph as it is then and applies all of
+ * it or none of it. Node ids are reserved up front, so edits can refer to
+ * nodes added earlier in the same transaction. Use AudioEngine::commit() to
+ * also rebuild the plan once for the whole batch (or not at all if it only
+ * sets parameters).
+ */
+class GraphTransaction {
+public:
+    explicit GraphTransaction(FluxGraph& graph) : m_graph(graph) {}
+
+    size_t addNode(std::shared_ptr<FluxNode> node) {
+        size_t id = m_graph.reserveId();
+        m_edits.push_back({ GraphEdit::Type::AddNode, id, std::move(node) });
+        return id;
+    }
+
+    void removeNode(size_t id) {
+        m_edits.push_back({ GraphEdit::Type::RemoveNode, id });
+    }
+
+    void connect(size_t srcNodeId, int srcPort, size_t dstNodeId, int dstPort) {
+        GraphEdit edit{ GraphEdit::Type::Connect };
+        edit.connection = { srcNodeId, srcPort, dstNodeId, dstPort };
+        m_edits.push_back(edit);
+    }
+
+    void disconnect(size_t srcNodeId, int srcPort, size_t dstNodeId, int dstPort) {
+        GraphEdit edit{ GraphEdit::Type::Disconnect };
+        edit.connection = { srcNodeId, srcPort, dstNodeId, dstPort };
+        m_edits.push_back(edit);
+    }
+
+    void setParameter(size_t nodeId, const std::string& name, float value) {
+        GraphEdit edit{ GraphEdit::Type::SetParameter, nodeId };
+        edit.parameter = name;
+        edit.value = value;
+        m_edits.push_back(edit);
+    }
+
+    /**
+     * @brief Applies every edit, or none if any is invalid (see getError()). The
+     * transaction is empty afterwards either way.
+     */
+    bool commit() {
+        m_error.clear();
+        bool ok = m_graph.apply(m_edits, m_error);
+        m_edits.clear();
+        return ok;
+    }
+
+    bool empty() const { return m_edits.empty(); }
+    const std::string& getError() const { return m_error; }
+    FluxGraph& getGraph() { return m_graph; }
+
+private:
+    FluxGraph& m_graph;
+    std::vector<GraphEdit> m_edits;
+    std::string m_error;
 };
 
 } // namespace Beam
@@ -6,8 +6,11 @@
 #include <memory>
 #include <atomic>
 #include <map>
+#include <algorithm>
 #include "../session/parameter.hpp"
 #include "midi_event.hpp"
+#include "realtime_thread.hpp"
+#include "node_timing.hpp"
 
 namespace Beam {
 
@@ -60,10 +63,94 @@ public:
 
     float* getInputBuffer(int portIdx) { return m_inputs[portIdx].data(); }
     float* getOutputBuffer(int portIdx) { return m_outputs[portIdx].data(); }
+    int getNumOutputBuffers() const { return (int)m_outputs.size(); }
+
+    /**
+     * @brief Largest block the preallocated port buffers can hold, in stereo frames.
+     */
+    int getMaxBlockFrames() const {
+        size_t samples = 0;
+        for (const auto& buf : m_inputs) samples = samples ? (std::min)(samples, buf.size()) : buf.size();
+        for (const auto& buf : m_outputs) samples = samples ? (std::min)(samples, buf.size()) : buf.size();
+        return (int)(samples / 2);
+    }
+
+    /**
+     * @brief Prepares the node for a sample rate and a maximum block size, like
+     * AudioProcessor::prepareToPlay(). Resizes the port buffers and lets the node
+     * (re)allocate its internal state in onPrepare(), so process() never allocates.
+     * Called from the UI thread while the node is not being processed; calling it
+     * again re-prepares the node in place, e.g. after a device change.
+     */
+    void prepare(float sampleRate, int maxBlockFrames) {
+        m_sampleRate = sampleRate;
+        m_maxBlockFrames = maxBlockFrames;
+        const size_t samples = (size_t)maxBlockFrames * m_bufferChannels;
+        for (auto& buf : m_inputs) buf.assign(samples, 0.0f);
+        for (auto& buf : m_outputs) buf.assign(samples, 0.0f);
+        onPrepare(sampleRate, maxBlockFrames);
+    }
+
+    /**
+     * @brief Frees the internal state allocated by onPrepare(), e.g. when the node
+     * leaves the graph. The node must be prepared again before it is processed.
+     */
+    void release() {
+        onRelease();
+        m_maxBlockFrames = 0;
+    }
+
+    bool isPreparedFor(float sampleRate, int maxBlockFrames) const {
+        return m_sampleRate == sampleRate && m_maxBlockFrames == maxBlockFrames;
+    }
+
+    float getSampleRate() const { return m_sampleRate; }
+
+    /**
+     * @brief True if this node's output depends on real-time input (audio capture or
+     * incoming MIDI). Such nodes, and everything downstream of them, always run in the
+     * real-time pass; the rest of the graph may be rendered ahead of the playhead.
+     */
+    virtual bool isLiveSource() const { return false; }
+
+    /**
+     * @brief Delay this node adds to its signal, in frames (e.g. lookahead or asynchronous processing).
+     */
+    virtual int getLatencyFrames() const { return 0; }
+
+    /**
+     * @brief Faults in (and locks) every buffer process() touches. Called when a plan is
+     * installed; nodes with delay lines or other large state extend it.
+     */
+    virtual void prefault() {
+        for (auto& buf : m_inputs) RealtimeThread::prefault(buf);
+        for (auto& buf : m_outputs) RealtimeThread::prefault(buf);
+    }
+
+    /**
+     * @brief Set while the node is processed off the real-time path (render-ahead worker,
+     * offline export), like AudioProcessor::setNonRealtime(). Such a node may wait for its
+     * data (e.g. disk reads) instead of dropping it. Safe from any thread.
+     */
+    void setNonRealtime(bool nonRealtime) { m_nonRealtime.store(nonRealtime, std::memory_order_relaxed); }
+    bool isNonRealtime() const { return m_nonRealtime.load(std::memory_order_relaxed); }
 
     void setBypass(bool bypass) { m_bypassed = bypass; }
     bool isBypassed() const { return m_bypassed; }
 
+    /**
+     * @brief Number of quality tiers the node offers. Tier 0 is full quality; each higher
+     * tier is cheaper (a simpler topology, analysis every Nth block, ...). The engine's
+     * LoadGovernor moves nodes between tiers when blocks approach their deadline.
+     */
+    virtual int getNumQualityTiers() const { return 1; }
+
+    /** @brief Takes effect from the next block; safe from any thread. */
+    void setQualityTier(int tier) {
+        m_qualityTier.store(std::clamp(tier, 0, getNumQualityTiers() - 1), std::memory_order_relaxed);
+    }
+    int getQualityTier() const { return m_qualityTier.load(std::memory_order_relaxed); }
+
     void addParameter(std::shared_ptr<Parameter> param) {
         m_parameters[param->getName()] = param;
     }
@@ -77,6 +164,10 @@ public:
         return m_parameters;
     }
 
+    /** @brief Per-block processing time, recorded by the executors while profiling is on. */
+    NodeTiming& getTiming() { return m_timing; }
+    const NodeTiming& getTiming() const { return m_timing; }
+
 protected:
     /**
      * @brief Pre-allocates buffers for inputs and outputs.
@@ -84,13 +175,32 @@ protected:
     void setupBuffers(int numInputs, int numOutputs, int bufferSize, int channels) {
         m_inputs.assign(numInputs, std::vector<float>(bufferSize * channels, 0.0f));
         m_outputs.assign(numOutputs, std::vector<float>(bufferSize * channels, 0.0f));
+        m_bufferChannels = channels;
+        m_maxBlockFrames = bufferSize;
     }
 
+    /**
+     * @brief Allocates everything that depends on the sample rate or block size
+     * (delay lines, filter coefficients, ...). getSampleRate() already returns the new rate.
+     */
+    virtual void onPrepare(float sampleRate, int maxBlockFrames) {}
+
+    /**
+     * @brief Frees what onPrepare() allocated.
+     */
+    virtual void onRelease() {}
+
     std::vector<std::vector<float>> m_inputs;
     std::vector<std::vector<float>> m_outputs;
     std::map<std::string, std::shared_ptr<Parameter>> m_parameters;
     std::atomic<bool> m_bypassed{false};
+    std::atomic<bool> m_nonRealtime{false};
+    std::atomic<int> m_qualityTier{0};
+    NodeTiming m_timing;
     size_t m_currentFrame = 0;
+    float m_sampleRate = 44100.0f;
+    int m_maxBlockFrames = 0;
+    int m_bufferChannels = 2;
 };
 
 } // namespace Beam
@@ -23,14 +23,13 @@ public:
 
     // Implement AudioProcessor interface
     void prepareToPlay(double sampleRate, int samplesPerBlock) override {
-        // Forward to the wrapped node if it has a prepare method
-        // For now, we'll just store the values
         m_sampleRate = sampleRate;
         m_blockSize = samplesPerBlock;
+        if (m_fluxNode) m_fluxNode->prepare((float)sampleRate, samplesPerBlock);
     }
 
     void releaseResources() override {
-        // Forward to the wrapped node if needed
+        if (m_fluxNode) m_fluxNode->release();
     }
 
     void processBlock(float** audioInputOutput, int numInputChannels, int numOutputChannels, int numSamples, const MIDIBuffer& midiMessages) override {
@@ -14,8 +14,9 @@ namespace Beam {
 class FluxPlugin : public FluxNode {
 public:
     FluxPlugin(const std::string& name, int bufferSize, float sampleRate) 
-        : m_pluginName(name), m_sampleRate(sampleRate) 
+        : m_pluginName(name)
     {
+        m_sampleRate = sampleRate;
         // Default to 1 Stereo Input and 1 Stereo Output
         setupBuffers(1, 1, bufferSize, 2);
     }
@@ -28,6 +29,8 @@ public:
     /**
      * @brief Handle MIDI events in your plugin.
      * @param midi The buffer containing all MIDI events for the current block.
+     * Plugins that respond to MIDI should also override isLiveSource() to return true,
+     * otherwise they may be rendered ahead of the playhead without events.
      */
     virtual void processEvents(const MIDIBuffer& midi) {}
 
@@ -66,11 +69,8 @@ protected:
         return p ? p->getValue() : 0.0f;
     }
 
-    float getSampleRate() const { return m_sampleRate; }
-
 private:
     std::string m_pluginName;
-    float m_sampleRate;
 };
 
 } // namespace Beam
@@ -10,8 +10,8 @@ namespace Beam {
 class FluxScriptNode : public FluxNode {
 public:
     FluxScriptNode(const std::string& scriptPath, int bufferSize, float sr) 
-        : m_sr(sr) 
     {
+        m_sampleRate = sr;
         std::ifstream file(scriptPath);
         if (file.is_open()) {
             std::stringstream buffer;
@@ -22,6 +22,7 @@ public:
                 }
             }
         }
+        m_paramValues.reserve(getParameters().size());
         setupBuffers(1, 1, bufferSize, 2);
     }
 
@@ -29,11 +30,12 @@ public:
         float* in = getInputBuffer(0);
         float* out = getOutputBuffer(0);
         
-        std::vector<float> pVals;
-        for(auto const& p : getParameters()) pVals.push_back(p.second->getValue());
+        // Capacity reserved in the constructor, so this never allocates.
+        m_paramValues.clear();
+        for(auto const& p : getParameters()) m_paramValues.push_back(p.second->getValue());
 
         for (int i = 0; i < frames * 2; ++i) {
-            m_engine.process(in[i], out[i], pVals, m_sr);
+            m_engine.process(in[i], out[i], m_paramValues, m_sampleRate);
         }
     }
 
@@ -44,7 +46,7 @@ public:
 
 private:
     FluxScriptEngine m_engine;
-    float m_sr;
+    std::vector<float> m_paramValues;
 };
 
 } // namespace Beam
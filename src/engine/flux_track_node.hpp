@@ -3,31 +3,73 @@
 
 #include "flux_node.hpp"
 #include "track_node.hpp"
+#include "input_node.hpp"
+#include <atomic>
 
 namespace Beam {
 
 class FluxTrackNode : public FluxNode {
 public:
-    FluxTrackNode(const std::string& name, int bufferSize) : m_name(name) {
-        m_track = std::make_shared<TrackNode>(name);
+    FluxTrackNode(const std::string& name, int bufferSize, float sampleRate = 44100.0f) : m_name(name) {
+        m_sampleRate = sampleRate;
+        m_track = std::make_shared<TrackNode>(name, sampleRate);
         setupBuffers(1, 1, bufferSize, 2); // 1 Stereo Input, 1 Stereo Output
         
         addParameter(std::make_shared<Parameter>("Tape Drive", 0.0f, 2.0f, 0.0f));
         addParameter(std::make_shared<Parameter>("Tape Age", 0.0f, 1.0f, 0.0f));
     }
 
+    ~FluxTrackNode() {
+        setArmed(false);
+    }
+
     bool load(const std::string& filePath) {
         return m_track->load(filePath);
     }
 
-    bool startRecording(const std::string& filePath, int sampleRate) {
-        return m_track->startRecording(filePath, sampleRate, 2);
+    /**
+     * @brief Arms the track with a new take; recording starts once the engine applies
+     * setRecording(true) at a block boundary (see AudioEngine::setArmed). UI thread.
+     */
+    bool openTake(const std::string& filePath, int sampleRate, PcmFormat format = PcmFormat::Int16) {
+        bool ok = m_track->openTake(filePath, sampleRate, 2, format);
+        setArmed(ok);
+        return ok;
+    }
+
+    /** @brief Finalizes the take and disarms; call after setRecording(false) took effect. UI thread. */
+    void closeTake() {
+        m_track->closeTake();
+        setArmed(false);
     }
 
-    void stopRecording() {
-        m_track->stopRecording();
+    /** @brief Audio thread: switches between recording and following the transport. */
+    void setRecording(bool recording, bool playing) {
+        m_track->setState(recording ? TrackState::Recording : playing ? TrackState::Playing : TrackState::Idle);
     }
 
+    bool isArmed() const { return m_armed; }
+
+    /**
+     * @brief Records straight from the capture block of `input` while nothing is cabled into
+     * the "Stereo In" port (see setInputWired). The input node must run earlier in the plan
+     * (AudioEngine::updatePlan puts it first).
+     */
+    void setInputSource(std::shared_ptr<InputNode> input) {
+        bool armed = m_armed;
+        setArmed(false);
+        m_inputSource = input;
+        m_activeInput.store(input.get(), std::memory_order_release);
+        setArmed(armed);
+    }
+
+    /**
+     * @brief Set by AudioEngine::updatePlan: true if a cable feeds "Stereo In", which is then
+     * recorded instead of the shared capture block.
+     */
+    void setInputWired(bool wired) { m_inputWired.store(wired, std::memory_order_relaxed); }
+    bool isInputWired() const { return m_inputWired.load(std::memory_order_relaxed); }
+
     void process(int frames) override {
         float* in = getInputBuffer(0);
         float* out = getOutputBuffer(0);
@@ -35,11 +77,17 @@ public:
         // Update tape params from UI
         m_track->setTapeParams(getParameter("Tape Drive")->getValue(), 
                                getParameter("Tape Age")->getValue());
+        m_track->setNonRealtime(isNonRealtime());
 
         if (m_track->getState() == TrackState::Recording) {
-            // Process recording: write 'in' to disk, and pass through to 'out' for monitoring
-            m_track->process(in, frames, 2, m_currentFrame);
+            // Process recording: the source may be shared by other armed tracks, so it is
+            // processed in 'out', which is both written to disk and passed on for monitoring.
+            InputNode* input = isInputWired() ? nullptr : m_activeInput.load(std::memory_order_acquire);
+            if (input) in = input->getOutputBuffer(0);
             std::copy(in, in + frames * 2, out);
+            m_track->process(out, frames, 2, m_currentFrame);
+            // With direct monitoring the performer already hears the input without the graph's delay.
+            if (input && input->isDirectMonitored()) std::fill(out, out + frames * 2, 0.0f);
         } else {
             // Process playback: read from disk into 'out'
             std::fill(out, out + frames * 2, 0.0f);
@@ -65,6 +113,13 @@ public:
         m_track->setState(state);
     }
 
+    /**
+     * @brief Publishes the clip layout used for playback (see RegionMap).
+     */
+    void setRegions(const std::vector<RegionSegment>& regions) {
+        m_track->setRegions(regions);
+    }
+
     TrackState getState() const {
         return m_track->getState();
     }
@@ -75,6 +130,12 @@ public:
 
     std::shared_ptr<TrackNode> getInternalNode() { return m_track; }
 
+    /**
+     * @brief An armed track reads the capture block directly, so it must run in the real-time pass.
+     * The engine's plan has to be rebuilt after arming for this to take effect.
+     */
+    bool isLiveSource() const override { return m_armed && m_inputSource; }
+
     std::string getName() const override { return m_name; }
 
     std::vector<Port> getInputPorts() const override {
@@ -85,10 +146,27 @@ public:
         return { {"Stereo Out", 2} };
     }
 
+protected:
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_track->prepare(sampleRate);
+    }
 
 private:
+    void setArmed(bool armed) {
+        if (armed == m_armed) return;
+        m_armed = armed;
+        if (m_inputSource) {
+            if (armed) m_inputSource->addArmedTrack();
+            else m_inputSource->removeArmedTrack();
+        }
+    }
+
     std::string m_name;
     std::shared_ptr<TrackNode> m_track;
+    bool m_armed = false;
+    std::shared_ptr<InputNode> m_inputSource;          // Owned by the UI thread
+    std::atomic<InputNode*> m_activeInput{nullptr};    // What the audio thread records from
+    std::atomic<bool> m_inputWired{false};             // "Stereo In" is cabled
 };
 
 } // namespace Beam
@@ -2,75 +2,148 @@
 #define INPUT_NODE_HPP
 
 #include "flux_node.hpp"
-#include <mutex>
-#include <vector>
+#include "lock_free_ring.hpp"
+#include "simd_utils.hpp"
+#include <atomic>
+#include <cstdint>
 
 namespace Beam {
 
 /**
  * @class InputNode
  * @brief Provides real-time audio input from the hardware to the Flux Graph.
+ *
+ * Captured samples travel through a fixed-capacity lock-free ring from the
+ * capture side (pushData) to the graph (process); neither side locks or
+ * allocates. Each block is read once into the node's output buffer, which
+ * armed tracks read directly (see FluxTrackNode::setInputSource), so one
+ * capture stream feeds any number of tracks without further copies.
+ *
+ * Because the capture and playback devices run on separate clocks, the fill
+ * level drifts: the node keeps at most `frames + backlog` frames buffered by
+ * skipping the oldest audio, and outputs silence (counted as an underrun)
+ * when less than a block is available. The backlog bound follows the output
+ * latency ceiling (setMaxBacklogMs), so a late block is caught up rather than
+ * skipped. While any track is armed nothing is skipped at all: a take keeps
+ * every captured frame, even across a UI stall, up to the ring's capacity.
  */
 class InputNode : public FluxNode {
 public:
-    InputNode(int bufferSize) : m_peak(0.0f) {
-        setupBuffers(0, 1, bufferSize, 2); 
+    InputNode(int bufferSize, int sampleRate = 44100) : m_peak(0.0f) {
+        setupBuffers(0, 1, bufferSize, 2);
         addParameter(std::make_shared<Parameter>("Source", 0.0f, 2.0f, 0.0f)); // 0: Audio L/R, 1: Mono L, 2: MIDI
+        prepare((float)sampleRate, bufferSize);
     }
 
     void process(int frames) override {
         float* out = getOutputBuffer(0);
+        const size_t samples = (size_t)frames * 2;
+        size_t available = m_ring.availableToRead() / 2;
+        const size_t maxBacklog = m_maxBacklogFrames.load(std::memory_order_relaxed);
+
+        if (available > (size_t)frames + maxBacklog && m_armedTracks.load(std::memory_order_relaxed) == 0) {
+            // Capture is running ahead of playback: drop the oldest audio to bound latency.
+            size_t excess = available - (size_t)frames - maxBacklog;
+            m_ring.skipTo(m_ring.getReadIndex() + excess * 2);
+            m_driftFrames.fetch_add(excess, std::memory_order_relaxed);
+        }
+
         float currentPeak = 0.0f;
-        
-        std::lock_guard<std::mutex> lock(m_bufferMutex);
-        
-        // If we have enough data, copy it out and calculate peak
-        if (m_capturedData.size() >= (size_t)(frames * 2)) {
-            for(int i = 0; i < frames * 2; ++i) {
-                float s = m_capturedData[i];
-                float absS = std::abs(s);
-                if (absS > currentPeak) currentPeak = absS;
-                out[i] = s;
-            }
-            m_capturedData.erase(m_capturedData.begin(), m_capturedData.begin() + frames * 2);
+        if (available >= (size_t)frames) {
+            m_ring.read(out, samples);
+            float mn[2] = { 0.0f, 0.0f };
+            float mx[2] = { 0.0f, 0.0f };
+            SIMD::minMax(out, frames, 2, mn, mx);
+            for (int c = 0; c < 2; ++c) currentPeak = (std::max)(currentPeak, (std::max)(-mn[c], mx[c]));
         } else {
-            std::fill(out, out + frames * 2, 0.0f);
+            // Not enough for a whole block: wait for the ring to refill rather than splice in a gap.
+            std::fill(out, out + samples, 0.0f);
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
         }
 
         // Apply visual decay to the reported peak
         float prev = m_peak.load();
-        if (currentPeak < prev) currentPeak = prev * 0.92f; 
+        if (currentPeak < prev) currentPeak = prev * 0.92f;
         m_peak.store(currentPeak);
     }
 
     float getPeakLevel() const { return m_peak.load(); }
 
+    /**
+     * @brief Capture side: queues interleaved stereo samples. When the ring is full the
+     * oldest audio is discarded so the newest always fits.
+     */
     void pushData(const float* data, int samples) {
-        std::lock_guard<std::mutex> lock(m_bufferMutex);
-        m_capturedData.insert(m_capturedData.end(), data, data + samples);
-        
-        // Safety limit: 1 second of buffer
-        const size_t maxSamples = 44100 * 2;
-        if (m_capturedData.size() > maxSamples) {
-            m_capturedData.erase(m_capturedData.begin(), m_capturedData.begin() + (m_capturedData.size() - maxSamples));
-        }
+        size_t count = (std::min)((size_t)samples, m_ring.capacity());
+        data += (size_t)samples - count;
+
+        size_t free = m_ring.availableToWrite();
+        if ((size_t)samples > free) m_overflowFrames.fetch_add(((size_t)samples - free) / 2, std::memory_order_relaxed);
+        if (count > free) m_ring.discardTo(m_ring.getReadIndex() + (count - free));
+        m_ring.write(data, count);
     }
 
+    /** @brief Blocks that were output as silence because capture had not delivered enough audio. */
+    uint64_t getUnderrunCount() const { return m_underruns.load(std::memory_order_relaxed); }
+    /** @brief Frames discarded because the ring was full (e.g. while the transport is stopped). */
+    uint64_t getOverflowFrames() const { return m_overflowFrames.load(std::memory_order_relaxed); }
+    /** @brief Frames skipped to compensate for capture running ahead of playback. */
+    uint64_t getDriftCorrectionFrames() const { return m_driftFrames.load(std::memory_order_relaxed); }
+    size_t getBufferedFrames() const { return m_ring.availableToRead() / 2; }
+
+    /**
+     * @brief Capture backlog kept beyond the current block before the oldest audio is
+     * skipped; AudioEngine sets it to the latency controller's maximum. Any thread.
+     */
+    void setMaxBacklogMs(double ms) {
+        m_maxBacklogMs.store(ms, std::memory_order_relaxed);
+        m_maxBacklogFrames.store((size_t)(ms * getSampleRate() / 1000.0), std::memory_order_relaxed);
+    }
+
+    /** @brief Armed tracks recording from this input register here (see FluxTrackNode). */
+    void addArmedTrack() { m_armedTracks.fetch_add(1, std::memory_order_relaxed); }
+    void removeArmedTrack() { m_armedTracks.fetch_sub(1, std::memory_order_relaxed); }
+    int getArmedTrackCount() const { return m_armedTracks.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set by AudioEngine while direct monitoring is on: armed tracks then leave the
+     * input out of the graph mix, since the performer already hears it directly.
+     */
+    void setDirectMonitored(bool directMonitored) { m_directMonitored.store(directMonitored, std::memory_order_relaxed); }
+    bool isDirectMonitored() const { return m_directMonitored.load(std::memory_order_relaxed); }
+
+    bool isLiveSource() const override { return true; }
+
     std::string getName() const override { return "Audio Input"; }
     std::vector<FluxNode::Port> getInputPorts() const override { return {}; }
     std::vector<FluxNode::Port> getOutputPorts() const override { return {{"Stereo Out", 2}}; }
 
+protected:
+    /**
+     * @brief Sizes the ring for `sampleRate` and resets the statistics.
+     * Not thread-safe: call while neither side is running.
+     */
+    void onPrepare(float sampleRate, int maxBlockFrames) override {
+        m_ring.resize((size_t)sampleRate * 2 * 2); // Two seconds of stereo audio
+        setMaxBacklogMs(m_maxBacklogMs.load(std::memory_order_relaxed));
+        m_underruns = 0;
+        m_overflowFrames = 0;
+        m_driftFrames = 0;
+    }
+
 private:
-    std::mutex m_bufferMutex;
-    std::vector<float> m_capturedData;
+    LockFreeRing<float> m_ring;
+    std::atomic<double> m_maxBacklogMs{200.0};
+    std::atomic<size_t> m_maxBacklogFrames{0};
     std::atomic<float> m_peak;
+
+    std::atomic<uint64_t> m_underruns{0};
+    std::atomic<uint64_t> m_overflowFrames{0};
+    std::atomic<uint64_t> m_driftFrames{0};
+    std::atomic<int> m_armedTracks{0};
+    std::atomic<bool> m_directMonitored{false};
 };
 
 } // namespace Beam
 
 #endif // INPUT_NODE_HPP
-
-
-
-
-
@@ -0,0 +1,126 @@
+#include "latency_controller.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace Beam {
+
+uint64_t LatencyController::nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyController::configure(int sampleRate) {
+    m_sampleRate = sampleRate;
+    const double initial = std::clamp(kInitialLatencyMs, getMinLatencyMs(), getMaxLatencyMs());
+    m_targetFrames.store(msToFrames(initial), std::memory_order_relaxed);
+    m_blocksSinceAdapt = 0;
+    onIdle();
+}
+
+void LatencyController::setBounds(double minMs, double maxMs) {
+    minMs = (std::max)(0.0, minMs);
+    maxMs = (std::max)(minMs, maxMs);
+    m_minMs.store(minMs, std::memory_order_relaxed);
+    m_maxMs.store(maxMs, std::memory_order_relaxed);
+    // The audio thread may adapt concurrently; the next adaptation step clamps again.
+    const size_t target = m_targetFrames.load(std::memory_order_relaxed);
+    m_targetFrames.store(std::clamp(target, msToFrames(minMs), msToFrames(maxMs)), std::memory_order_relaxed);
+}
+
+bool LatencyController::shouldRender(size_t queuedFrames) {
+    const uint64_t now = nowNs();
+    if (m_lastCallNs != 0) {
+        const uint64_t intervalUs = (now - m_lastCallNs) / 1000;
+        m_lastIntervalUs = (std::max)(m_lastIntervalUs, (uint32_t)(std::min)(intervalUs, (uint64_t)UINT32_MAX));
+    }
+    m_lastCallNs = now;
+    m_queuedFrames.store(queuedFrames, std::memory_order_relaxed);
+
+    if (m_wasQueued && queuedFrames == 0) {
+        // The device consumed everything we gave it: back off straight away.
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        const size_t target = m_targetFrames.load(std::memory_order_relaxed);
+        const size_t step = (std::max)(msToFrames(1.0), target / 4);
+        m_targetFrames.store((std::min)(target + step, msToFrames(getMaxLatencyMs())), std::memory_order_relaxed);
+        m_blocksSinceAdapt = 0;
+    }
+    m_wasQueued = queuedFrames > 0;
+    return queuedFrames < m_targetFrames.load(std::memory_order_relaxed);
+}
+
+double LatencyController::endBlock(uint64_t startNs, int frames) {
+    const uint64_t dspNs = nowNs() - startNs;
+    const uint64_t blockNs = (uint64_t)frames * 1000000000ull / (uint64_t)m_sampleRate;
+    if (dspNs > blockNs) m_lateBlocks.fetch_add(1, std::memory_order_relaxed);
+    m_blockFrames.store(frames, std::memory_order_relaxed);
+
+    const uint64_t index = m_blocks.load(std::memory_order_relaxed);
+    m_intervalUs[index % kWindow].store(m_lastIntervalUs, std::memory_order_relaxed);
+    m_dspUs[index % kWindow].store((uint32_t)(std::min)(dspNs / 1000, (uint64_t)UINT32_MAX), std::memory_order_relaxed);
+    m_blocks.store(index + 1, std::memory_order_release);
+    m_lastIntervalUs = 0;
+    m_wasQueued = true;
+
+    if (++m_blocksSinceAdapt >= kAdaptBlocks) {
+        m_blocksSinceAdapt = 0;
+        adapt(frames);
+    }
+    return blockNs ? (double)dspNs / (double)blockNs : 0.0;
+}
+
+void LatencyController::adapt(int blockFrames) {
+    const size_t count = (size_t)(std::min)(m_blocks.load(std::memory_order_relaxed), (uint64_t)kWindow);
+    if (count == 0) return;
+    const double demandMs = (percentileMs(m_intervalUs, count, 0.99) + percentileMs(m_dspUs, count, 0.99)) * kSafetyFactor;
+
+    const size_t lo = msToFrames(getMinLatencyMs());
+    const size_t hi = msToFrames(getMaxLatencyMs());
+    const size_t demand = std::clamp(msToFrames(demandMs), lo, hi);
+    const size_t target = m_targetFrames.load(std::memory_order_relaxed);
+
+    size_t next = target;
+    if (demand > target) next = demand;
+    else if (demand < target) next = (std::max)(demand, target - (std::min)(target, (size_t)blockFrames / 4));
+    m_targetFrames.store(std::clamp(next, lo, hi), std::memory_order_relaxed);
+}
+
+double LatencyController::percentileMs(const std::array<std::atomic<uint32_t>, kWindow>& window, size_t count, double p) {
+    std::array<uint32_t, kWindow> values;
+    for (size_t i = 0; i < count; ++i) values[i] = window[i].load(std::memory_order_relaxed);
+    const size_t rank = (std::min)(count - 1, (size_t)(p * (double)count));
+    std::nth_element(values.begin(), values.begin() + rank, values.begin() + count);
+    return values[rank] / 1000.0;
+}
+
+LatencyStats LatencyController::getStats() const {
+    LatencyStats stats;
+    stats.targetFrames = getTargetFrames();
+    stats.latencyMs = stats.targetFrames * 1000.0 / m_sampleRate;
+    stats.queuedFrames = m_queuedFrames.load(std::memory_order_relaxed);
+    stats.blocks = m_blocks.load(std::memory_order_acquire);
+    stats.underruns = m_underruns.load(std::memory_order_relaxed);
+    stats.lateBlocks = m_lateBlocks.load(std::memory_order_relaxed);
+
+    const size_t count = (size_t)(std::min)(stats.blocks, (uint64_t)kWindow);
+    if (count > 0) {
+        stats.intervalP50Ms = percentileMs(m_intervalUs, count, 0.50);
+        stats.intervalP95Ms = percentileMs(m_intervalUs, count, 0.95);
+        stats.intervalP99Ms = percentileMs(m_intervalUs, count, 0.99);
+        stats.dspP50Ms = percentileMs(m_dspUs, count, 0.50);
+        stats.dspP95Ms = percentileMs(m_dspUs, count, 0.95);
+        stats.dspP99Ms = percentileMs(m_dspUs, count, 0.99);
+        uint64_t sumUs = 0;
+        for (size_t i = 0; i < count; ++i) sumUs += m_dspUs[i].load(std::memory_order_relaxed);
+        stats.dspMeanMs = (double)sumUs / (double)count / 1000.0;
+        const double blockMs = m_blockFrames.load(std::memory_order_relaxed) * 1000.0 / m_sampleRate;
+        stats.dspLoad = blockMs > 0.0 ? stats.dspMeanMs / blockMs : 0.0;
+    }
+    return stats;
+}
+
+void LatencyController::resetStats() {
+    m_underruns.store(0, std::memory_order_relaxed);
+    m_lateBlocks.store(0, std::memory_order_relaxed);
+}
+
+} // namespace Beam
@@ -0,0 +1,126 @@
+#ifndef LATENCY_CONTROLLER_HPP
+#define LATENCY_CONTROLLER_HPP
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace Beam {
+
+/**
+ * @struct LatencyStats
+ * @brief Snapshot of the output queue and block timing, for the UI and tests.
+ */
+struct LatencyStats {
+    size_t targetFrames = 0;  // Queue depth the engine currently keeps
+    double latencyMs = 0.0;   // targetFrames at the current sample rate
+    size_t queuedFrames = 0;  // Queue depth seen by the last block
+    uint64_t blocks = 0;      // Blocks rendered
+    uint64_t underruns = 0;   // The device drained the queue completely
+    uint64_t lateBlocks = 0;  // DSP time exceeded the block's own duration
+
+    // Interval between process() calls (callback jitter) and DSP time per block, in ms,
+    // over the last LatencyController::kWindow blocks.
+    double intervalP50Ms = 0.0, intervalP95Ms = 0.0, intervalP99Ms = 0.0;
+    double dspP50Ms = 0.0, dspP95Ms = 0.0, dspP99Ms = 0.0;
+    double dspMeanMs = 0.0;
+    double dspLoad = 0.0;     // dspMeanMs relative to the block duration (the global DSP meter)
+};
+
+/**
+ * @class LatencyController
+ * @brief Paces the output queue at the lowest depth the machine sustains.
+ *
+ * The engine asks shouldRender() before every block with the number of frames
+ * still queued for the device, and reports the block's DSP time through
+ * endBlock(). The controller records how far apart the calls arrive and how
+ * long each block takes, and counts underruns (the queue ran dry) and late
+ * blocks (DSP slower than real time).
+ *
+ * The target depth is raised by a quarter on every underrun. Every kAdaptBlocks
+ * blocks it is moved towards the demand measured over the window, which is
+ * (p99 interval + p99 DSP time) plus a safety margin. Raises take effect at
+ * once; decreases step down a quarter block at a time. The target always stays
+ * within the bounds set with setBounds().
+ *
+ * The audio thread is the only writer. Every field the UI reads is atomic, and
+ * the percentile windows are preallocated, so nothing here allocates or locks.
+ */
+class LatencyController {
+public:
+    static constexpr size_t kWindow = 512;      // Blocks kept for percentiles
+    static constexpr int kAdaptBlocks = 256;    // Blocks between adaptation steps
+    static constexpr double kInitialLatencyMs = 50.0;
+    static constexpr double kSafetyFactor = 1.25;
+
+    /**
+     * @brief Sets the sample rate and restarts adaptation from the initial latency.
+     * Call while the audio thread is not running (AudioEngine::init).
+     */
+    void configure(int sampleRate);
+
+    /** @brief User bounds for the target latency. UI thread. */
+    void setBounds(double minMs, double maxMs);
+    double getMinLatencyMs() const { return m_minMs.load(std::memory_order_relaxed); }
+    double getMaxLatencyMs() const { return m_maxMs.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Called at the start of every process() while playing. Records the interval
+     * since the previous call and detects underruns.
+     * @return True if the queue is below the target and a block should be rendered.
+     */
+    bool shouldRender(size_t queuedFrames);
+
+    /**
+     * @brief Called after a block of `frames` frames was rendered and queued.
+     * @return The block's load: DSP time divided by the block's duration.
+     */
+    double endBlock(uint64_t startNs, int frames);
+
+    /** @brief Called when the transport stops, so the pause is not taken for jitter. */
+    void onIdle() { m_lastCallNs = 0; m_wasQueued = false; }
+
+    size_t getTargetFrames() const { return m_targetFrames.load(std::memory_order_relaxed); }
+    uint64_t getUnderrunCount() const { return m_underruns.load(std::memory_order_relaxed); }
+
+    /** @brief Safe from any thread. */
+    LatencyStats getStats() const;
+
+    /** @brief Clears the underrun and late block counts; the target latency is kept. */
+    void resetStats();
+
+    static uint64_t nowNs();
+
+private:
+    size_t msToFrames(double ms) const { return (size_t)(ms * m_sampleRate / 1000.0); }
+    void adapt(int blockFrames);
+
+    // Nearest-rank percentile over a copy of `window`, in ms.
+    static double percentileMs(const std::array<std::atomic<uint32_t>, kWindow>& window, size_t count, double p);
+
+    int m_sampleRate = 44100;
+    std::atomic<double> m_minMs{5.0};
+    std::atomic<double> m_maxMs{200.0};
+    std::atomic<size_t> m_targetFrames{0};
+    std::atomic<size_t> m_queuedFrames{0};
+    std::atomic<int> m_blockFrames{0};
+
+    std::atomic<uint64_t> m_blocks{0};
+    std::atomic<uint64_t> m_underruns{0};
+    std::atomic<uint64_t> m_lateBlocks{0};
+
+    // Ring windows in microseconds, indexed by m_blocks
+    std::array<std::atomic<uint32_t>, kWindow> m_intervalUs{};
+    std::array<std::atomic<uint32_t>, kWindow> m_dspUs{};
+
+    // Audio thread only
+    uint64_t m_lastCallNs = 0;
+    uint32_t m_lastIntervalUs = 0;
+    bool m_wasQueued = false;
+    int m_blocksSinceAdapt = 0;
+};
+
+} // namespace Beam
+
+#endif // LATENCY_CONTROLLER_HPP
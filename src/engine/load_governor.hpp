@@ -0,0 +1,114 @@
+#ifndef LOAD_GOVERNOR_HPP
+#define LOAD_GOVERNOR_HPP
+
+#include "render_plan.hpp"
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @class LoadGovernor
+ * @brief Sheds DSP quality before the engine misses its deadline, and restores it after.
+ *
+ * After every block the engine reports the block's load (DSP time divided by
+ * the block's duration). The governor keeps one global quality level and sets
+ * every node to min(level, its last tier) through FluxNode::setQualityTier():
+ *
+ * - A late block, or kStepDownBlocks blocks in a row above kHighWater, steps
+ *   the level down (cheaper) at once.
+ * - A run of blocks below kLowWater steps it back up. If that turns out to be
+ *   too early (the next step down follows straight away), the run required
+ *   doubles, up to kMaxHoldFactor times, so the level does not oscillate.
+ *
+ * The engine also reports a block as late (kLateLoad) when the render-ahead
+ * worker fell behind the playhead, since that thread's time is not part of
+ * the audio thread's load.
+ *
+ * All state is owned by the audio thread; the level and counters are atomics
+ * the UI may read. Offline rendering does not go through the governor.
+ */
+class LoadGovernor {
+public:
+    static constexpr double kHighWater = 0.8;  // Load that starts shedding
+    static constexpr double kLowWater = 0.5;   // Load below which quality may return
+    static constexpr double kLateLoad = 2.0;   // Reported for a block that missed its deadline elsewhere
+    static constexpr int kStepDownBlocks = 3;
+    static constexpr int kStepUpBlocks = 100;
+    static constexpr int kMaxHoldFactor = 16;
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /** @brief Current level: 0 is full quality. */
+    int getLevel() const { return m_level.load(std::memory_order_relaxed); }
+
+    /** @brief Number of times quality was stepped down. */
+    uint64_t getStepDownCount() const { return m_stepDowns.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Reports a block and applies a level change to the nodes of `plans`.
+     * A new plan (detected by `planKey`) gets the current level applied once.
+     * Audio thread.
+     */
+    template<typename Plans>
+    void update(double load, const void* planKey, int maxTier, const Plans& plans) {
+        int level = m_level.load(std::memory_order_relaxed);
+        if (!isEnabled()) {
+            if (level != 0 || planKey != m_planKey) apply(0, planKey, plans);
+            return;
+        }
+
+        const int previous = level;
+        if (load > 1.0 || (load > kHighWater && ++m_overBlocks >= kStepDownBlocks)) {
+            m_overBlocks = 0;
+            m_underBlocks = 0;
+            if (level < maxTier) {
+                // Stepping down right after stepping up means the step up was premature.
+                if (m_blocksSinceStepUp < kStepUpBlocks) m_holdFactor = (std::min)(m_holdFactor * 2, kMaxHoldFactor);
+                ++level;
+                m_stepDowns.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (load < kLowWater) {
+            m_overBlocks = 0;
+            if (level > 0 && ++m_underBlocks >= kStepUpBlocks * m_holdFactor) {
+                m_underBlocks = 0;
+                m_blocksSinceStepUp = 0;
+                --level;
+            }
+        } else {
+            m_overBlocks = load > kHighWater ? m_overBlocks : 0;
+            m_underBlocks = 0;
+        }
+        if (m_blocksSinceStepUp < kStepUpBlocks) ++m_blocksSinceStepUp;
+
+        level = (std::min)(level, maxTier);
+        if (level != previous || planKey != m_planKey) apply(level, planKey, plans);
+    }
+
+private:
+    template<typename Plans>
+    void apply(int level, const void* planKey, const Plans& plans) {
+        m_level.store(level, std::memory_order_relaxed);
+        m_planKey = planKey;
+        for (const RenderPlan* plan : plans) {
+            for (const auto& exec : plan->sequence) exec.node->setQualityTier(level);
+        }
+    }
+
+    std::atomic<bool> m_enabled{true};
+    std::atomic<int> m_level{0};
+    std::atomic<uint64_t> m_stepDowns{0};
+
+    // Audio thread only
+    const void* m_planKey = nullptr;
+    int m_overBlocks = 0;
+    int m_underBlocks = 0;
+    int m_blocksSinceStepUp = kStepUpBlocks;
+    int m_holdFactor = 1;
+};
+
+} // namespace Beam
+
+#endif // LOAD_GOVERNOR_HPP
@@ -0,0 +1,135 @@
+#ifndef LOCK_FREE_RING_HPP
+#define LOCK_FREE_RING_HPP
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace Beam {
+
+/**
+ * @class LockFreeRing
+ * @brief Lock-free single-producer/single-consumer ring buffer.
+ *
+ * Read and write positions are monotonically increasing 64-bit counters, so
+ * either side can reason about absolute positions in the stream (e.g. to
+ * discard everything written before a known index). Storage is allocated once
+ * in the constructor; `write` and `read` never allocate or block.
+ *
+ * The read position is advanced with compare-and-swap so the producer may also
+ * discard stale data (`discardTo`); a read that races with a discard is retried.
+ */
+template <typename T>
+class LockFreeRing {
+public:
+    explicit LockFreeRing(size_t capacity = 0) { resize(capacity); }
+
+    /**
+     * @brief Reallocates storage and empties the ring. Not thread-safe: call before use.
+     */
+    void resize(size_t capacity) {
+        m_buffer.assign(capacity, T());
+        m_readIndex.store(0, std::memory_order_relaxed);
+        m_writeIndex.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return m_buffer.size(); }
+
+    size_t availableToRead() const {
+        return (size_t)(m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_relaxed));
+    }
+
+    size_t availableToWrite() const {
+        return m_buffer.size() - (size_t)(m_writeIndex.load(std::memory_order_relaxed) - m_readIndex.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Producer side. Writes up to `count` items and returns how many fit.
+     */
+    size_t write(const T* src, size_t count) {
+        const uint64_t w = m_writeIndex.load(std::memory_order_relaxed);
+        const uint64_t r = m_readIndex.load(std::memory_order_acquire);
+        count = (std::min)(count, m_buffer.size() - (size_t)(w - r));
+        if (count == 0) return 0;
+
+        const size_t start = (size_t)(w % m_buffer.size());
+        const size_t first = (std::min)(count, m_buffer.size() - start);
+        std::copy(src, src + first, m_buffer.begin() + start);
+        std::copy(src + first, src + count, m_buffer.begin());
+        m_writeIndex.store(w + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Consumer side. Reads up to `count` items and returns how many were available.
+     */
+    size_t read(T* dst, size_t count) {
+        const size_t requested = count;
+        while (true) {
+            uint64_t r = m_readIndex.load(std::memory_order_acquire);
+            const uint64_t w = m_writeIndex.load(std::memory_order_acquire);
+            count = (std::min)(requested, (size_t)(w - r));
+            if (count == 0) return 0;
+
+            const size_t start = (size_t)(r % m_buffer.size());
+            const size_t first = (std::min)(count, m_buffer.size() - start);
+            std::copy(m_buffer.begin() + start, m_buffer.begin() + start + first, dst);
+            std::copy(m_buffer.begin(), m_buffer.begin() + (count - first), dst + first);
+            if (m_readIndex.compare_exchange_strong(r, r + count, std::memory_order_acq_rel)) return count;
+        }
+    }
+
+    /**
+     * @brief Copies up to `count` items starting at absolute position `index` without
+     * consuming them. Only valid while the producer is stopped; returns 0 if `index`
+     * has already been read.
+     */
+    size_t peek(uint64_t index, T* dst, size_t count) const {
+        const uint64_t w = m_writeIndex.load(std::memory_order_acquire);
+        if (index < m_readIndex.load(std::memory_order_acquire) || index >= w) return 0;
+        count = (std::min)(count, (size_t)(w - index));
+
+        const size_t start = (size_t)(index % m_buffer.size());
+        const size_t first = (std::min)(count, m_buffer.size() - start);
+        std::copy(m_buffer.begin() + start, m_buffer.begin() + start + first, dst);
+        std::copy(m_buffer.begin(), m_buffer.begin() + (count - first), dst + first);
+        return count;
+    }
+
+    /**
+     * @brief Consumer side. Drops unread items up to absolute position `index`.
+     */
+    void skipTo(uint64_t index) { advanceReadTo(index); }
+
+    /**
+     * @brief Producer side. Drops unread items up to absolute position `index`,
+     * e.g. everything written before a seek.
+     */
+    void discardTo(uint64_t index) { advanceReadTo(index); }
+
+    /**
+     * @brief Consumer side. Drops everything currently readable.
+     */
+    void clear() { skipTo(m_writeIndex.load(std::memory_order_acquire)); }
+
+    uint64_t getReadIndex() const { return m_readIndex.load(std::memory_order_acquire); }
+    uint64_t getWriteIndex() const { return m_writeIndex.load(std::memory_order_acquire); }
+
+private:
+    void advanceReadTo(uint64_t index) {
+        const uint64_t w = m_writeIndex.load(std::memory_order_acquire);
+        index = (std::min)(index, w);
+        uint64_t r = m_readIndex.load(std::memory_order_acquire);
+        while (r < index && !m_readIndex.compare_exchange_weak(r, index, std::memory_order_acq_rel)) {}
+    }
+
+    std::vector<T> m_buffer;
+    alignas(64) std::atomic<uint64_t> m_readIndex{0};
+    alignas(64) std::atomic<uint64_t> m_writeIndex{0};
+};
+
+} // namespace Beam
+
+#endif // LOCK_FREE_RING_HPP
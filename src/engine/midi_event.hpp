@@ -1,8 +1,10 @@
 #ifndef MIDI_EVENT_HPP
 #define MIDI_EVENT_HPP
 
-#include <vector>
+#include <array>
+#include <span>
 #include <cstdint>
+#include <cstddef>
 
 namespace Beam {
 
@@ -31,21 +33,30 @@ struct MIDIEvent {
 /**
  * @class MIDIBuffer
  * @brief Container for MIDI events within a single processing block.
+ *
+ * Storage is a fixed array, so filling a buffer on the audio thread never
+ * allocates; events beyond kCapacity in one block are dropped.
  */
 class MIDIBuffer {
 public:
-    void addEvent(const MIDIEvent& event) {
-        m_events.push_back(event);
+    static constexpr size_t kCapacity = 256;
+
+    /** @return False if the buffer is full and the event was dropped. */
+    bool addEvent(const MIDIEvent& event) {
+        if (m_count == kCapacity) return false;
+        m_events[m_count++] = event;
+        return true;
     }
 
     void clear() {
-        m_events.clear();
+        m_count = 0;
     }
 
-    const std::vector<MIDIEvent>& getEvents() const { return m_events; }
+    std::span<const MIDIEvent> getEvents() const { return { m_events.data(), m_count }; }
 
 private:
-    std::vector<MIDIEvent> m_events;
+    std::array<MIDIEvent, kCapacity> m_events;
+    size_t m_count = 0;
 };
 
 } // namespace Beam
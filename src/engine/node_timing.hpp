@@ -0,0 +1,90 @@
+#ifndef NODE_TIMING_HPP
+#define NODE_TIMING_HPP
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace Beam {
+
+/**
+ * @struct NodeTimingStats
+ * @brief Processing time of one node over its recent blocks.
+ */
+struct NodeTimingStats {
+    uint64_t blocks = 0;   // Blocks timed since the last reset
+    double minNs = 0.0, meanNs = 0.0, maxNs = 0.0, p99Ns = 0.0; // Per block, over the window
+    double load = 0.0;     // meanNs relative to the block's real-time duration
+    double share = 0.0;    // load relative to the engine's DSP load (AudioEngine::getNodeTiming)
+};
+
+/**
+ * @class NodeTiming
+ * @brief Lock-free per-node block timing, filled in by PlanExecutor.
+ *
+ * Only the thread processing the node writes; any thread may read. The last
+ * kWindow block times are kept in a ring of atomics, so recording is two
+ * relaxed stores and reading never blocks the audio thread. With profiling
+ * disabled the executor skips the clock reads entirely.
+ */
+class NodeTiming {
+public:
+    static constexpr size_t kWindow = 256;
+
+    static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    static uint64_t nowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** @brief Records one block that took `ns` out of a real-time budget of `budgetNs`. */
+    void record(uint64_t ns, uint64_t budgetNs) {
+        const uint64_t index = m_blocks.load(std::memory_order_relaxed);
+        m_ns[index % kWindow].store((uint32_t)(std::min)(ns, (uint64_t)UINT32_MAX), std::memory_order_relaxed);
+        m_budgetNs.store(budgetNs, std::memory_order_relaxed);
+        m_blocks.store(index + 1, std::memory_order_release);
+    }
+
+    NodeTimingStats getStats() const {
+        NodeTimingStats stats;
+        stats.blocks = m_blocks.load(std::memory_order_acquire);
+        const size_t count = (size_t)(std::min)(stats.blocks, (uint64_t)kWindow);
+        if (count == 0) return stats;
+
+        std::array<uint32_t, kWindow> values;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = m_ns[i].load(std::memory_order_relaxed);
+            sum += values[i];
+        }
+        const auto [mn, mx] = std::minmax_element(values.begin(), values.begin() + count);
+        stats.minNs = *mn;
+        stats.maxNs = *mx;
+        stats.meanNs = (double)sum / (double)count;
+        const size_t rank = (std::min)(count - 1, (size_t)(0.99 * (double)count));
+        std::nth_element(values.begin(), values.begin() + rank, values.begin() + count);
+        stats.p99Ns = values[rank];
+        const uint64_t budget = m_budgetNs.load(std::memory_order_relaxed);
+        stats.load = budget ? stats.meanNs / (double)budget : 0.0;
+        return stats;
+    }
+
+    /** @brief Forgets the window; the next blocks start a fresh one. */
+    void reset() { m_blocks.store(0, std::memory_order_release); }
+
+private:
+    static inline std::atomic<bool> s_enabled{true};
+
+    std::array<std::atomic<uint32_t>, kWindow> m_ns{};
+    std::atomic<uint64_t> m_blocks{0};
+    std::atomic<uint64_t> m_budgetNs{0};
+};
+
+} // namespace Beam
+
+#endif // NODE_TIMING_HPP
@@ -2,7 +2,9 @@
 #define OFFLINE_RENDERER_HPP
 
 #include "flux_graph.hpp"
-#include "../../third_party/dr_wav.h"
+#include "master_node.hpp"
+#include "flux_track_node.hpp"
+#include "pcm_encoder.hpp"
 #include <string>
 #include <vector>
 #include <iostream>
@@ -15,30 +17,58 @@ namespace Beam {
  */
 class OfflineRenderer {
 public:
-    static bool renderToWav(const std::string& filePath, std::shared_ptr<FluxGraph> graph, size_t totalFrames, int sampleRate = 44100) {
+    static bool renderToWav(const std::string& filePath, std::shared_ptr<FluxGraph> graph, size_t totalFrames, int sampleRate = 44100,
+                            PcmFormat format = PcmFormat::Int16, bool dither = true) {
         if (!graph) return false;
 
-        drwav_data_format format;
-        format.container = drwav_container_riff;
-        format.format = DR_WAVE_FORMAT_PCM;
-        format.channels = 2;
-        format.sampleRate = (drwav_uint32)sampleRate;
-        format.bitsPerSample = 16;
+        // Render in the largest block every node was prepared for.
+        int maxBlockFrames = 0;
+        for (const auto& [id, node] : graph->getNodes()) {
+            const int frames = node->getMaxBlockFrames();
+            if (frames > 0) maxBlockFrames = maxBlockFrames > 0 ? (std::min)(maxBlockFrames, frames) : frames;
+        }
+        if (maxBlockFrames <= 0) return false;
 
-        drwav wav;
-        if (!drwav_init_file_write(&wav, filePath.c_str(), &format, nullptr)) {
+        // Encoding and disk writes run on the encoder's I/O thread while the next blocks render.
+        PcmEncoder::Options options;
+        options.dither = dither;
+        PcmEncoder encoder;
+        if (!encoder.open(filePath, sampleRate, 2, format, options)) {
             return false;
         }
 
-        auto plan = graph->compile(1024, 2);
-        std::vector<float> renderBuf(1024 * 2);
+        auto plan = graph->compile(maxBlockFrames, 2);
         size_t framesRemaining = totalFrames;
         size_t currentFrame = 0;
 
+        std::shared_ptr<MasterNode> master;
+        for (auto& exec : plan->sequence) {
+            if (auto m = std::dynamic_pointer_cast<MasterNode>(exec.node)) {
+                master = m; break;
+            }
+        }
+
+        // Exports always render at full quality from the start of the timeline, and tracks
+        // wait for the disk instead of dropping blocks. The live settings are restored afterwards.
+        std::vector<int> liveTiers;
+        std::vector<bool> liveNonRealtime;
+        std::vector<std::pair<std::shared_ptr<FluxTrackNode>, TrackState>> liveTracks;
+        for (auto& exec : plan->sequence) {
+            liveTiers.push_back(exec.node->getQualityTier());
+            liveNonRealtime.push_back(exec.node->isNonRealtime());
+            exec.node->setQualityTier(0);
+            exec.node->setNonRealtime(true);
+            exec.node->onTransportSeek(0);
+            if (auto track = std::dynamic_pointer_cast<FluxTrackNode>(exec.node)) {
+                liveTracks.emplace_back(track, track->getState());
+                track->setState(TrackState::Playing);
+            }
+        }
+
         std::cout << "Starting Offline Render: " << totalFrames << " frames..." << std::endl;
 
         while (framesRemaining > 0) {
-            int blockFrames = (int)(std::min)((size_t)1024, framesRemaining);
+            int blockFrames = (int)(std::min)((size_t)maxBlockFrames, framesRemaining);
             
             // 1. Clear inputs
             for (auto& op : plan->clearOps) {
@@ -57,32 +87,22 @@ public:
                 }
             }
 
-            // 3. Extract Master Output (Assuming Master is the last node or find it)
-            // For now, assume we find the MasterNode in the plan
-            std::shared_ptr<MasterNode> master;
-            for(auto& exec : plan->sequence) {
-                if (auto m = std::dynamic_pointer_cast<MasterNode>(exec.node)) {
-                    master = m; break;
-                }
-            }
-
+            // 3. Extract Master Output (Master sums into its input)
             if (master) {
-                float* masterOut = master->getInputBuffer(0); // Master sums into its input
-                std::vector<int16_t> pcm(blockFrames * 2);
-                for (int i = 0; i < blockFrames * 2; ++i) {
-                    float s = masterOut[i];
-                    if (s > 1.0f) s = 1.0f;
-                    if (s < -1.0f) s = -1.0f;
-                    pcm[i] = (int16_t)(s * 32767.0f);
-                }
-                drwav_write_pcm_frames(&wav, (drwav_uint64)blockFrames, pcm.data());
+                encoder.write(master->getInputBuffer(0), (size_t)blockFrames);
             }
 
             framesRemaining -= blockFrames;
             currentFrame += blockFrames;
         }
 
-        drwav_uninit(&wav);
+        for (size_t i = 0; i < liveTiers.size(); ++i) {
+            plan->sequence[i].node->setQualityTier(liveTiers[i]);
+            plan->sequence[i].node->setNonRealtime(liveNonRealtime[i]);
+        }
+        for (auto& [track, state] : liveTracks) track->setState(state);
+
+        if (!encoder.close()) return false;
         std::cout << "Offline Render Complete: " << filePath << std::endl;
         return true;
     }
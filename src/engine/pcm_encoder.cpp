@@ -0,0 +1,162 @@
+#include "pcm_encoder.hpp"
+#include "simd_utils.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace Beam {
+
+namespace {
+
+const size_t DITHER_BLOCK_SAMPLES = 4096;
+
+} // namespace
+
+PcmEncoder::~PcmEncoder() {
+    close();
+}
+
+bool PcmEncoder::open(const std::string& filePath, int sampleRate, int channels, PcmFormat format, const Options& options) {
+    close();
+    if (!m_file.open(filePath, sampleRate, channels, format)) return false;
+
+    m_format = format;
+    m_channels = channels;
+    m_options = options;
+    m_framesWritten = 0;
+
+    const size_t frameBytes = (size_t)channels * bytesPerSample(format);
+    const size_t bufferBytes = (std::max)(options.bufferBytes / frameBytes, (size_t)1) * frameBytes;
+    m_buffers[0].resize(bufferBytes);
+    m_buffers[1].resize(options.async ? bufferBytes : 0);
+    m_fill = 0;
+    m_active = 0;
+    m_ditherScratch.resize(options.dither ? DITHER_BLOCK_SAMPLES : 0);
+
+    m_pending = -1;
+    m_ioOk = true;
+    m_ioStop = false;
+    if (options.async) m_ioThread = std::thread(&PcmEncoder::ioLoop, this);
+    return true;
+}
+
+void PcmEncoder::encode(const float* src, uint8_t* dst, size_t samples, PcmFormat format,
+                        uint32_t* ditherState, float* scratch) {
+    if (ditherState && scratch && format != PcmFormat::Float32) {
+        const float lsb = (format == PcmFormat::Int16) ? 1.0f / 32767.0f : 1.0f / 8388607.0f;
+        SIMD::addTpdfDither(src, scratch, (int)samples, lsb, ditherState);
+        src = scratch;
+    }
+
+    switch (format) {
+        case PcmFormat::Int16:
+            SIMD::floatToInt16(src, reinterpret_cast<int16_t*>(dst), (int)samples);
+            break;
+        case PcmFormat::Int24:
+            SIMD::floatToInt24(src, dst, (int)samples);
+            break;
+        case PcmFormat::Float32:
+            SIMD::clamp(src, reinterpret_cast<float*>(dst), (int)samples);
+            break;
+    }
+}
+
+bool PcmEncoder::write(const float* interleaved, size_t frames) {
+    if (!m_file.isOpen()) return false;
+
+    const size_t sampleBytes = (size_t)bytesPerSample(m_format);
+    const size_t capacity = m_buffers[m_active].size();
+    size_t samples = frames * m_channels;
+    bool ok = true;
+
+    while (samples > 0) {
+        size_t room = (capacity - m_fill) / sampleBytes;
+        size_t n = (std::min)(samples, room);
+        if (m_options.dither) n = (std::min)(n, DITHER_BLOCK_SAMPLES);
+
+        encode(interleaved, m_buffers[m_active].data() + m_fill, n, m_format,
+               m_options.dither ? m_ditherState : nullptr, m_ditherScratch.data());
+        m_fill += n * sampleBytes;
+        interleaved += n;
+        samples -= n;
+
+        if (m_fill == capacity) ok = submit() && ok;
+    }
+    m_framesWritten += frames;
+    return ok;
+}
+
+bool PcmEncoder::submit() {
+    if (m_fill == 0) return true;
+
+    if (!m_options.async) {
+        bool ok = m_file.write(m_buffers[0].data(), m_fill);
+        m_fill = 0;
+        return ok;
+    }
+
+    // Hand the full buffer to the I/O thread and continue in the other one.
+    std::unique_lock<std::mutex> lock(m_ioMutex);
+    m_ioCv.wait(lock, [this] { return m_pending < 0; });
+    m_pending = m_active;
+    m_pendingBytes = m_fill;
+    lock.unlock();
+    m_ioCv.notify_all();
+
+    m_active ^= 1;
+    m_fill = 0;
+    return m_ioOk;
+}
+
+bool PcmEncoder::flush() {
+    bool ok = submit();
+    if (m_options.async) {
+        std::unique_lock<std::mutex> lock(m_ioMutex);
+        m_ioCv.wait(lock, [this] { return m_pending < 0; });
+        ok = ok && m_ioOk;
+    }
+    return ok;
+}
+
+bool PcmEncoder::commit() {
+    if (!m_file.isOpen()) return false;
+    bool ok = flush();
+    return m_file.commit() && ok;
+}
+
+bool PcmEncoder::close() {
+    if (!m_file.isOpen()) return true;
+    bool ok = flush();
+
+    if (m_ioThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_ioMutex);
+            m_ioStop = true;
+        }
+        m_ioCv.notify_all();
+        m_ioThread.join();
+    }
+
+    ok = m_file.close() && ok;
+    if (!ok) std::cerr << "PcmEncoder: write error, output may be incomplete" << std::endl;
+    return ok;
+}
+
+void PcmEncoder::ioLoop() {
+    std::unique_lock<std::mutex> lock(m_ioMutex);
+    while (true) {
+        m_ioCv.wait(lock, [this] { return m_ioStop || m_pending >= 0; });
+        if (m_pending < 0) return; // Stopping with nothing in flight
+
+        int index = m_pending;
+        size_t bytes = m_pendingBytes;
+        lock.unlock();
+        bool ok = m_file.write(m_buffers[index].data(), bytes);
+        lock.lock();
+
+        m_ioOk = m_ioOk && ok;
+        m_pending = -1;
+        m_ioCv.notify_all();
+    }
+}
+
+} // namespace Beam
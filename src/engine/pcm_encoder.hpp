@@ -0,0 +1,97 @@
+#ifndef PCM_ENCODER_HPP
+#define PCM_ENCODER_HPP
+
+#include "wav_file_writer.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @class PcmEncoder
+ * @brief Converts float audio to a PCM WAV file: the single export path for
+ * WavWriter, OfflineRenderer and recording.
+ *
+ * Samples are clamped, optionally TPDF-dithered and converted with SIMD kernels
+ * into large staging buffers. In async mode the buffers are double-buffered:
+ * while one is written to disk by the encoder's I/O thread, the caller fills
+ * the other, so encoding and file I/O overlap.
+ */
+class PcmEncoder {
+public:
+    struct Options {
+        bool dither = false;              ///< TPDF dither at the target LSB (integer formats only)
+        bool async = true;                ///< Write full buffers on a dedicated I/O thread
+        size_t bufferBytes = 4 << 20;     ///< Size of each staging buffer
+    };
+
+    PcmEncoder() = default;
+    ~PcmEncoder();
+
+    PcmEncoder(const PcmEncoder&) = delete;
+    PcmEncoder& operator=(const PcmEncoder&) = delete;
+
+    bool open(const std::string& filePath, int sampleRate, int channels, PcmFormat format, const Options& options);
+    bool open(const std::string& filePath, int sampleRate, int channels, PcmFormat format) {
+        return open(filePath, sampleRate, channels, format, Options());
+    }
+
+    /**
+     * @brief Encodes interleaved frames and queues them for writing.
+     */
+    bool write(const float* interleaved, size_t frames);
+
+    /**
+     * @brief Writes out everything encoded so far and commits the file header (see WavFileWriter::commit).
+     */
+    bool commit();
+
+    /**
+     * @brief Flushes, finalises the header and closes the file.
+     */
+    bool close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    uint64_t getFramesWritten() const { return m_framesWritten; }
+
+    /**
+     * @brief Converts `samples` floats to `format` in `dst`. With a dither state, TPDF dither
+     * is applied first; `scratch` must then hold `samples` floats.
+     */
+    static void encode(const float* src, uint8_t* dst, size_t samples, PcmFormat format,
+                       uint32_t* ditherState = nullptr, float* scratch = nullptr);
+
+private:
+    bool submit();
+    bool flush();
+    void ioLoop();
+
+    WavFileWriter m_file;
+    PcmFormat m_format = PcmFormat::Int16;
+    int m_channels = 2;
+    Options m_options;
+    uint64_t m_framesWritten = 0;
+
+    std::vector<uint8_t> m_buffers[2];
+    size_t m_fill = 0;
+    int m_active = 0;
+    std::vector<float> m_ditherScratch;
+    uint32_t m_ditherState[4] = { 0x9E3779B9u, 0x243F6A88u, 0xB7E15162u, 0x85A308D3u };
+
+    // Async I/O: at most one buffer is in flight while the other is being filled
+    std::thread m_ioThread;
+    std::mutex m_ioMutex;
+    std::condition_variable m_ioCv;
+    int m_pending = -1;
+    size_t m_pendingBytes = 0;
+    bool m_ioOk = true;
+    bool m_ioStop = false;
+};
+
+} // namespace Beam
+
+#endif // PCM_ENCODER_HPP
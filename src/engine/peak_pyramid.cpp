@@ -0,0 +1,342 @@
+#include "peak_pyramid.hpp"
+#include "audio_reader.hpp"
+#include "simd_utils.hpp"
+#include "transcode_cache.hpp"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Beam {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kMagic[8] = { 'F', 'L', 'X', 'P', 'E', 'A', 'K', 'S' };
+const uint32_t kVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t sampleRate;
+    uint32_t numLevels;
+    uint64_t totalFrames;
+    uint64_t fingerprint;
+};
+
+struct FileLevel {
+    uint32_t binFrames;
+    uint32_t reserved;
+    uint64_t numBins;
+    uint64_t dataOffset;
+};
+
+inline int16_t quantise(float v) {
+    v = (std::max)(-1.0f, (std::min)(1.0f, v));
+    return (int16_t)std::lround(v * 32767.0f);
+}
+
+inline uint64_t levelBins(uint64_t totalFrames, uint32_t binFrames) {
+    return (totalFrames + binFrames - 1) / binFrames;
+}
+
+} // namespace
+
+PeakPyramid::~PeakPyramid() {
+    if (!m_mapping) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_mapping);
+    if (m_mapHandle) CloseHandle((HANDLE)m_mapHandle);
+    if (m_fileHandle) CloseHandle((HANDLE)m_fileHandle);
+#else
+    munmap(m_mapping, m_mappingSize);
+#endif
+}
+
+void PeakPyramid::layoutLevels(const int16_t* base) {
+    m_levels.clear();
+    uint32_t binFrames = kBaseBinFrames;
+    for (int l = 0; l < kNumLevels; ++l) {
+        uint64_t bins = levelBins(m_totalFrames, binFrames);
+        m_levels.push_back({ binFrames, bins, base });
+        base += bins * m_channels * 2;
+        binFrames *= kLevelFactor;
+    }
+}
+
+std::shared_ptr<PeakPyramid> PeakPyramid::build(const std::string& sourcePath, uint64_t sourceFingerprint,
+                                                const std::atomic<bool>* cancel) {
+    // A private decoder: the playback reader is never locked during the scan.
+    AudioReader reader;
+    if (!reader.open(sourcePath, 0)) return nullptr;
+
+    const int channels = (int)reader.getChannels();
+    if (channels <= 0) return nullptr;
+
+    std::shared_ptr<PeakPyramid> pyramid(new PeakPyramid());
+    pyramid->m_channels = (uint32_t)channels;
+    pyramid->m_sampleRate = reader.getSampleRate();
+    pyramid->m_fingerprint = sourceFingerprint;
+
+    // Level 0 is computed from the audio, the rest by reducing the level below.
+    std::vector<int16_t> base;
+    base.reserve((size_t)(levelBins(reader.getTotalFrames(), kBaseBinFrames) * channels * 2));
+
+    const size_t CHUNK_FRAMES = 65536; // Multiple of every bin size
+    std::vector<float> chunk(CHUNK_FRAMES * channels);
+    std::vector<float> mins(channels), maxs(channels);
+    uint64_t totalFrames = 0;
+
+    while (true) {
+        if (cancel && cancel->load()) return nullptr;
+        std::fill(chunk.begin(), chunk.end(), 0.0f);
+        size_t read = reader.readFrames(chunk.data(), CHUNK_FRAMES, channels);
+        if (read == 0) break;
+
+        for (size_t f = 0; f < read; f += kBaseBinFrames) {
+            int binLen = (int)(std::min)((size_t)kBaseBinFrames, read - f);
+            std::fill(mins.begin(), mins.end(), 1.0f);
+            std::fill(maxs.begin(), maxs.end(), -1.0f);
+            SIMD::minMax(&chunk[f * channels], binLen, channels, mins.data(), maxs.data());
+            for (int c = 0; c < channels; ++c) {
+                base.push_back(quantise(mins[c]));
+                base.push_back(quantise(maxs[c]));
+            }
+        }
+        totalFrames += read;
+        if (read < CHUNK_FRAMES) break;
+    }
+
+    pyramid->m_totalFrames = totalFrames;
+
+    size_t totalValues = 0;
+    uint32_t binFrames = kBaseBinFrames;
+    for (int l = 0; l < kNumLevels; ++l) {
+        totalValues += (size_t)levelBins(totalFrames, binFrames) * channels * 2;
+        binFrames *= kLevelFactor;
+    }
+    pyramid->m_storage.resize(totalValues);
+    std::copy(base.begin(), base.end(), pyramid->m_storage.begin());
+    pyramid->layoutLevels(pyramid->m_storage.data());
+
+    for (int l = 1; l < kNumLevels; ++l) {
+        const Level& src = pyramid->m_levels[l - 1];
+        int16_t* dst = const_cast<int16_t*>(pyramid->m_levels[l].data);
+        for (uint64_t b = 0; b < pyramid->m_levels[l].numBins; ++b) {
+            uint64_t first = b * kLevelFactor;
+            uint64_t last = (std::min)(first + kLevelFactor, src.numBins);
+            for (int c = 0; c < channels; ++c) {
+                int16_t mn = INT16_MAX, mx = INT16_MIN;
+                for (uint64_t s = first; s < last; ++s) {
+                    mn = (std::min)(mn, src.data[(s * channels + c) * 2]);
+                    mx = (std::max)(mx, src.data[(s * channels + c) * 2 + 1]);
+                }
+                dst[(b * channels + c) * 2] = mn;
+                dst[(b * channels + c) * 2 + 1] = mx;
+            }
+        }
+    }
+    return pyramid;
+}
+
+bool PeakPyramid::save(const std::string& peakPath) const {
+    std::error_code ec;
+    fs::create_directories(fs::path(peakPath).parent_path(), ec);
+
+    std::string partPath = peakPath + ".part";
+    {
+        std::ofstream file(partPath, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.channels = m_channels;
+        header.sampleRate = m_sampleRate;
+        header.numLevels = (uint32_t)m_levels.size();
+        header.totalFrames = m_totalFrames;
+        header.fingerprint = m_fingerprint;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        uint64_t offset = sizeof(FileHeader) + sizeof(FileLevel) * m_levels.size();
+        for (const auto& level : m_levels) {
+            FileLevel entry = { level.binFrames, 0, level.numBins, offset };
+            file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            offset += level.numBins * m_channels * 2 * sizeof(int16_t);
+        }
+        for (const auto& level : m_levels) {
+            file.write(reinterpret_cast<const char*>(level.data), (std::streamsize)(level.numBins * m_channels * 2 * sizeof(int16_t)));
+        }
+        if (!file.good()) return false;
+    }
+    fs::rename(partPath, peakPath, ec);
+    return !ec;
+}
+
+std::shared_ptr<PeakPyramid> PeakPyramid::load(const std::string& peakPath, uint64_t expectedFingerprint) {
+    std::shared_ptr<PeakPyramid> pyramid(new PeakPyramid());
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(peakPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+    pyramid->m_fileHandle = file;
+    pyramid->m_mapHandle = mapping;
+    pyramid->m_mapping = view;
+    pyramid->m_mappingSize = (size_t)size.QuadPart;
+#else
+    int fd = ::open(peakPath.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader)) { ::close(fd); return nullptr; }
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return nullptr;
+    pyramid->m_mapping = view;
+    pyramid->m_mappingSize = (size_t)st.st_size;
+#endif
+
+    if (pyramid->m_mappingSize < sizeof(FileHeader)) return nullptr;
+    const auto* bytes = static_cast<const char*>(pyramid->m_mapping);
+    FileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.numLevels != (uint32_t)kNumLevels || header.channels == 0) return nullptr;
+    if (expectedFingerprint != 0 && header.fingerprint != expectedFingerprint) return nullptr;
+
+    pyramid->m_channels = header.channels;
+    pyramid->m_sampleRate = header.sampleRate;
+    pyramid->m_totalFrames = header.totalFrames;
+    pyramid->m_fingerprint = header.fingerprint;
+
+    uint64_t dataStart = sizeof(FileHeader) + sizeof(FileLevel) * header.numLevels;
+    FileLevel first;
+    std::memcpy(&first, bytes + sizeof(FileHeader), sizeof(first));
+    if (first.dataOffset != dataStart) return nullptr;
+
+    pyramid->layoutLevels(reinterpret_cast<const int16_t*>(bytes + dataStart));
+    const Level& top = pyramid->m_levels.back();
+    const char* end = reinterpret_cast<const char*>(top.data + top.numBins * header.channels * 2);
+    if (end > bytes + pyramid->m_mappingSize) return nullptr;
+
+    return pyramid;
+}
+
+void PeakPyramid::query(int channel, uint64_t startFrame, uint64_t numFrames, int numPixels, float* outMin, float* outMax) const {
+    if (numPixels <= 0) return;
+    if (m_levels.empty() || channel < 0 || channel >= (int)m_channels || numFrames == 0) {
+        std::fill(outMin, outMin + numPixels, 0.0f);
+        std::fill(outMax, outMax + numPixels, 0.0f);
+        return;
+    }
+
+    // Coarsest level whose bins still fit inside one pixel.
+    double framesPerPixel = (double)numFrames / numPixels;
+    size_t levelIdx = 0;
+    while (levelIdx + 1 < m_levels.size() && m_levels[levelIdx + 1].binFrames <= framesPerPixel) ++levelIdx;
+    const Level& level = m_levels[levelIdx];
+
+    const float scale = 1.0f / 32767.0f;
+    for (int p = 0; p < numPixels; ++p) {
+        uint64_t f0 = startFrame + (uint64_t)(p * framesPerPixel);
+        uint64_t f1 = startFrame + (uint64_t)((p + 1) * framesPerPixel);
+        uint64_t b0 = f0 / level.binFrames;
+        uint64_t b1 = (std::max)(b0 + 1, (f1 + level.binFrames - 1) / level.binFrames);
+        b1 = (std::min)(b1, level.numBins);
+
+        int mn = INT16_MAX, mx = INT16_MIN;
+        for (uint64_t b = b0; b < b1; ++b) {
+            const int16_t* pair = level.data + (b * m_channels + channel) * 2;
+            mn = (std::min)(mn, (int)pair[0]);
+            mx = (std::max)(mx, (int)pair[1]);
+        }
+        outMin[p] = (b0 < b1) ? mn * scale : 0.0f;
+        outMax[p] = (b0 < b1) ? mx * scale : 0.0f;
+    }
+}
+
+// ============================================================================
+// PeakCache
+// ============================================================================
+
+PeakCache::~PeakCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+}
+
+void PeakCache::setCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cacheDirectory = directory;
+}
+
+std::string PeakCache::getCacheDirectory() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cacheDirectory;
+}
+
+void PeakCache::request(const std::string& sourcePath, ReadyCallback onReady) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_worker.joinable()) m_worker = std::thread(&PeakCache::workerLoop, this);
+        m_jobs.push_back({ sourcePath, std::move(onReady) });
+    }
+    m_cv.notify_one();
+}
+
+void PeakCache::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop.load() || !m_jobs.empty(); });
+            if (m_stop) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        uint64_t fp = TranscodeCache::fingerprint(job.sourcePath);
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.fluxpeaks", (unsigned long long)fp);
+        std::string peakPath = (fs::path(getCacheDirectory()) / name).string();
+
+        std::shared_ptr<PeakPyramid> pyramid = (fp != 0) ? PeakPyramid::load(peakPath, fp) : nullptr;
+        if (!pyramid) {
+            pyramid = PeakPyramid::build(job.sourcePath, fp, &m_stop);
+            if (pyramid && fp != 0 && !pyramid->save(peakPath)) {
+                std::cerr << "PeakCache: could not write " << peakPath << std::endl;
+            }
+        }
+        if (pyramid && job.onReady) job.onReady(pyramid);
+    }
+}
+
+} // namespace Beam
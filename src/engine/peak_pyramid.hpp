@@ -0,0 +1,132 @@
+#ifndef PEAK_PYRAMID_HPP
+#define PEAK_PYRAMID_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include "transcode_cache.hpp"
+
+namespace Beam {
+
+/**
+ * @class PeakPyramid
+ * @brief Multi-resolution min/max waveform summary of an audio file.
+ *
+ * Each level stores one (min, max) pair per channel for every bin of
+ * 64/256/1024/4096/16384/65536 frames, quantised to int16. Queries pick the
+ * level closest to the requested resolution, so drawing costs O(pixels) at any
+ * zoom. Pyramids persist as `.fluxpeaks` files and are memory-mapped on reload.
+ */
+class PeakPyramid {
+public:
+    static constexpr uint32_t kBaseBinFrames = 64;
+    static constexpr uint32_t kLevelFactor = 4;
+    static constexpr int kNumLevels = 6;
+
+    struct Level {
+        uint32_t binFrames;
+        uint64_t numBins;
+        const int16_t* data; ///< numBins * channels * (min, max)
+    };
+
+    ~PeakPyramid();
+
+    /**
+     * @brief Decodes a file with its own decoder instance and builds the pyramid.
+     * @param cancel Optional flag polled between chunks to abort the scan.
+     */
+    static std::shared_ptr<PeakPyramid> build(const std::string& sourcePath, uint64_t sourceFingerprint = 0,
+                                              const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * @brief Memory-maps a `.fluxpeaks` file. Returns nullptr if missing, invalid or stale.
+     */
+    static std::shared_ptr<PeakPyramid> load(const std::string& peakPath, uint64_t expectedFingerprint = 0);
+
+    bool save(const std::string& peakPath) const;
+
+    int getChannels() const { return (int)m_channels; }
+    uint32_t getSampleRate() const { return m_sampleRate; }
+    uint64_t getTotalFrames() const { return m_totalFrames; }
+    uint64_t getFingerprint() const { return m_fingerprint; }
+    const std::vector<Level>& getLevels() const { return m_levels; }
+
+    /**
+     * @brief Summarises frames [startFrame, startFrame + numFrames) into numPixels min/max pairs.
+     * Samples outside the file read as silence.
+     */
+    void query(int channel, uint64_t startFrame, uint64_t numFrames, int numPixels, float* outMin, float* outMax) const;
+
+private:
+    PeakPyramid() = default;
+    void layoutLevels(const int16_t* base);
+
+    uint32_t m_channels = 0;
+    uint32_t m_sampleRate = 0;
+    uint64_t m_totalFrames = 0;
+    uint64_t m_fingerprint = 0;
+    std::vector<Level> m_levels;
+
+    std::vector<int16_t> m_storage;  // Owned data for freshly built pyramids
+    void* m_mapping = nullptr;       // Mapped file view for loaded pyramids
+    size_t m_mappingSize = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mapHandle = nullptr;
+#endif
+};
+
+/**
+ * @class PeakCache
+ * @brief Loads or generates PeakPyramids on a background thread.
+ *
+ * Requests first try to map an existing `.fluxpeaks` file from the cache
+ * directory; otherwise the source is scanned and the result written back.
+ */
+class PeakCache {
+public:
+    using ReadyCallback = std::function<void(std::shared_ptr<const PeakPyramid>)>;
+
+    static PeakCache& instance() {
+        static PeakCache inst;
+        return inst;
+    }
+
+    ~PeakCache();
+
+    void setCacheDirectory(const std::string& directory);
+    std::string getCacheDirectory() const;
+
+    /**
+     * @brief Queues a source. The callback runs on the worker thread when the pyramid is available.
+     */
+    void request(const std::string& sourcePath, ReadyCallback onReady);
+
+private:
+    PeakCache() = default;
+
+    struct Job {
+        std::string sourcePath;
+        ReadyCallback onReady;
+    };
+
+    void workerLoop();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_jobs;
+    std::thread m_worker;
+    std::atomic<bool> m_stop{false};
+    std::string m_cacheDirectory = TranscodeCache::kDirectoryName;
+};
+
+} // namespace Beam
+
+#endif // PEAK_PYRAMID_HPP
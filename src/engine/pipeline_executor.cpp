@@ -0,0 +1,141 @@
+#include "pipeline_executor.hpp"
+#include "plan_executor.hpp"
+#include "simd_utils.hpp"
+#include "realtime_thread.hpp"
+#include "trace.hpp"
+#include "rt_checks.hpp"
+#include <unordered_map>
+#include <algorithm>
+
+namespace Beam {
+
+PipelineExecutor::PipelineExecutor(const RenderPlan& plan, int channels, int maxBlockFrames,
+                                   const std::vector<std::shared_ptr<AutomationLane>>& lanes)
+    : m_channels(channels), m_maxBlockFrames(maxBlockFrames) {
+    // Size from the sequence as well, so a plan whose numStages was not carried over cannot overflow.
+    int numStages = (std::max)(1, plan.numStages);
+    for (const auto& exec : plan.sequence) numStages = (std::max)(numStages, exec.stage + 1);
+    m_stages.resize((size_t)numStages);
+
+    std::unordered_map<const FluxNode*, int> stageOf;
+    for (const auto& exec : plan.sequence) stageOf[exec.node.get()] = exec.stage;
+
+    for (const auto& exec : plan.sequence) {
+        NodeExecution local;
+        local.node = exec.node;
+        local.stage = exec.stage;
+        local.name = exec.name;
+        for (const auto& route : exec.outgoingRoutes) {
+            const int destStage = stageOf[route.destNode.get()];
+            if (destStage == exec.stage) {
+                local.outgoingRoutes.push_back(route);
+                continue;
+            }
+            auto line = std::make_unique<DelayLine>();
+            line->sourceNode = route.sourceNode;
+            line->sourcePort = route.sourcePort;
+            line->destNode = route.destNode;
+            line->destPort = route.destPort;
+            line->delay = destStage - exec.stage;
+            line->slots.assign((size_t)line->delay + 1, std::vector<float>((size_t)maxBlockFrames * channels, 0.0f));
+            for (auto& slot : line->slots) RealtimeThread::prefault(slot);
+            m_stages[exec.stage].outputs.push_back(line.get());
+            m_stages[destStage].inputs.push_back(line.get());
+            m_lines.push_back(std::move(line));
+        }
+        m_stages[exec.stage].plan.sequence.push_back(local);
+    }
+
+    for (const auto& op : plan.clearOps) {
+        auto it = stageOf.find(op.node.get());
+        m_stages[it != stageOf.end() ? it->second : 0].plan.clearOps.push_back(op);
+    }
+
+    std::unordered_map<const Parameter*, int> stageOfParam;
+    for (const auto& exec : plan.sequence) {
+        for (const auto& [name, p] : exec.node->getParameters()) stageOfParam[p.get()] = exec.stage;
+    }
+    for (const auto& lane : lanes) {
+        auto it = stageOfParam.find(lane->getParameter().get());
+        m_stages[it != stageOfParam.end() ? it->second : numStages - 1].lanes.push_back(lane);
+    }
+
+    // The last stage runs on the calling thread; every other stage gets a pinned worker.
+    for (int i = 0; i + 1 < (int)m_stages.size(); ++i) {
+        m_workers.emplace_back(&PipelineExecutor::workerLoop, this, i);
+        RealtimeThread::instance().promote(m_workers.back(), i + 1);
+    }
+}
+
+PipelineExecutor::~PipelineExecutor() {
+    m_stop.store(true, std::memory_order_release);
+    m_tick.fetch_add(1, std::memory_order_release);
+    m_tick.notify_all();
+    for (auto& worker : m_workers) worker.join();
+}
+
+void PipelineExecutor::process(int frames, size_t startFrame, const MIDIBuffer* midi) {
+    frames = (std::min)(frames, m_maxBlockFrames);
+    m_frames = frames;
+    m_startFrame = startFrame;
+    m_midi = midi;
+
+    m_running.store((int)m_workers.size(), std::memory_order_relaxed);
+    m_tick.fetch_add(1, std::memory_order_release);
+    m_tick.notify_all();
+
+    runStage((int)m_stages.size() - 1);
+
+    for (int left = m_running.load(std::memory_order_acquire); left != 0; left = m_running.load(std::memory_order_acquire)) {
+        m_running.wait(left, std::memory_order_acquire);
+    }
+    ++m_blockIndex;
+}
+
+void PipelineExecutor::reset() {
+    for (auto& line : m_lines) {
+        for (auto& slot : line->slots) std::fill(slot.begin(), slot.end(), 0.0f);
+    }
+}
+
+void PipelineExecutor::runStage(int index) {
+    Stage& stage = m_stages[index];
+    const int frames = m_frames;
+    const size_t samples = (size_t)frames * m_channels;
+    const int lastStage = (int)m_stages.size() - 1;
+
+    PlanExecutor::clearInputs(stage.plan, frames, m_channels);
+    for (DelayLine* line : stage.inputs) {
+        // Written `delay` blocks ago by the upstream stage, which was then that much further ahead.
+        const auto& slot = line->slots[(m_blockIndex + line->slots.size() - (size_t)line->delay) % line->slots.size()];
+        SIMD::add(slot.data(), line->destNode->getInputBuffer(line->destPort), (int)samples);
+    }
+
+    const size_t stageFrame = m_startFrame + (size_t)(lastStage - index) * frames;
+    for (auto& lane : stage.lanes) lane->applyAt(stageFrame);
+    PlanExecutor::run(stage.plan, frames, m_channels, stageFrame, m_midi);
+
+    for (DelayLine* line : stage.outputs) {
+        auto& slot = line->slots[m_blockIndex % line->slots.size()];
+        SIMD::copy(line->sourceNode->getOutputBuffer(line->sourcePort), slot.data(), (int)samples);
+    }
+}
+
+void PipelineExecutor::workerLoop(int index) {
+    Tracer::instance().setThreadName("Pipeline Stage " + std::to_string(index + 1));
+    uint64_t seen = 0;
+    while (true) {
+        m_tick.wait(seen, std::memory_order_acquire);
+        seen = m_tick.load(std::memory_order_acquire);
+        if (m_stop.load(std::memory_order_acquire)) return;
+
+        {
+            FLUX_RT_SCOPE();
+            runStage(index);
+        }
+
+        if (m_running.fetch_sub(1, std::memory_order_acq_rel) == 1) m_running.notify_one();
+    }
+}
+
+} // namespace Beam
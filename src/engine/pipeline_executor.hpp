@@ -0,0 +1,97 @@
+#ifndef PIPELINE_EXECUTOR_HPP
+#define PIPELINE_EXECUTOR_HPP
+
+#include "render_plan.hpp"
+#include "midi_event.hpp"
+#include "../session/automation.hpp"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @class PipelineExecutor
+ * @brief Runs a staged RenderPlan (FluxGraph::compile with stages > 1) as a pipeline.
+ *
+ * Every block, all stages run at once, each on its own thread pinned to its
+ * own core: while the last stage (on the calling thread) finishes block t,
+ * the stage before it already works on block t + 1, and so on. Signals that
+ * cross from stage a to stage b pass through a delay line of (b - a) + 1
+ * block buffers, written and read in different slots each block, so the
+ * stages never share a buffer. The only synchronisation is one atomic
+ * start/finish handshake per block.
+ *
+ * Stage s renders (numStages - 1 - s) blocks ahead of the playhead, and each
+ * stage applies the automation of its own nodes at that frame, so timeline
+ * playback and automation stay aligned; live input reaches the output
+ * (numStages - 1) blocks later, as reported in RenderPlan::latencyFrames.
+ */
+class PipelineExecutor {
+public:
+    /**
+     * @param lanes Automation lanes of the plan's nodes; each is applied by the stage that
+     * owns its parameter (lanes of other parameters by the last stage).
+     */
+    PipelineExecutor(const RenderPlan& plan, int channels, int maxBlockFrames,
+                     const std::vector<std::shared_ptr<AutomationLane>>& lanes = {});
+    ~PipelineExecutor();
+
+    PipelineExecutor(const PipelineExecutor&) = delete;
+    PipelineExecutor& operator=(const PipelineExecutor&) = delete;
+
+    /**
+     * @brief Runs one block through every stage; returns when all stages are done.
+     * @param startFrame Playhead of the block leaving the last stage.
+     */
+    void process(int frames, size_t startFrame, const MIDIBuffer* midi = nullptr);
+
+    /**
+     * @brief Silences the delay lines, e.g. after a seek. Call between blocks.
+     */
+    void reset();
+
+    int getNumStages() const { return (int)m_stages.size(); }
+
+private:
+    struct DelayLine {
+        std::shared_ptr<FluxNode> sourceNode;
+        int sourcePort;
+        std::shared_ptr<FluxNode> destNode;
+        int destPort;
+        int delay;                             // Stage distance b - a
+        std::vector<std::vector<float>> slots; // delay + 1 blocks
+    };
+
+    struct Stage {
+        RenderPlan plan;                 // Nodes and same-stage routes
+        std::vector<DelayLine*> inputs;  // Lines read before processing
+        std::vector<DelayLine*> outputs; // Lines written after processing
+        std::vector<std::shared_ptr<AutomationLane>> lanes; // Parameters of this stage's nodes
+    };
+
+    void runStage(int index);
+    void workerLoop(int index);
+
+    int m_channels;
+    int m_maxBlockFrames;
+    std::vector<Stage> m_stages;
+    std::vector<std::unique_ptr<DelayLine>> m_lines;
+    std::vector<std::thread> m_workers;
+
+    // Current block, published to the workers by m_tick
+    int m_frames = 0;
+    size_t m_startFrame = 0;
+    const MIDIBuffer* m_midi = nullptr;
+    uint64_t m_blockIndex = 0;
+
+    std::atomic<uint64_t> m_tick{0};
+    std::atomic<int> m_running{0};
+    std::atomic<bool> m_stop{false};
+};
+
+} // namespace Beam
+
+#endif // PIPELINE_EXECUTOR_HPP
@@ -0,0 +1,67 @@
+#ifndef PLAN_EXECUTOR_HPP
+#define PLAN_EXECUTOR_HPP
+
+#include "render_plan.hpp"
+#include "simd_utils.hpp"
+#include "trace.hpp"
+#include <algorithm>
+
+namespace Beam {
+
+/**
+ * @class PlanExecutor
+ * @brief Runs one block of a RenderPlan: clears the inputs, processes each node
+ * in order and sums its outputs along the pre-computed routes.
+ *
+ * Shared by the real-time engine and the render-ahead worker so both follow
+ * the same bypass and MIDI rules. While NodeTiming is enabled each node's
+ * process() call is timed into its NodeTiming, and while the Tracer is
+ * enabled it appears on the timeline under the node's name.
+ */
+class PlanExecutor {
+public:
+    static void clearInputs(const RenderPlan& plan, int frames, int channels) {
+        for (const auto& op : plan.clearOps) {
+            float* buf = op.node->getInputBuffer(op.portIdx);
+            std::fill(buf, buf + frames * channels, 0.0f);
+        }
+    }
+
+    static void run(const RenderPlan& plan, int frames, int channels, size_t startFrame, const MIDIBuffer* midi = nullptr) {
+        const bool profiling = NodeTiming::isEnabled();
+        for (auto& exec : plan.sequence) {
+            exec.node->setCurrentFrame(startFrame);
+
+            if (midi && !midi->getEvents().empty()) {
+                exec.node->processMIDI(*midi);
+            }
+
+            if (!exec.node->isBypassed()) {
+                FLUX_TRACE_SCOPE(exec.name.c_str());
+                if (profiling) {
+                    const uint64_t start = NodeTiming::nowNs();
+                    exec.node->process(frames);
+                    const uint64_t budget = (uint64_t)((double)frames * 1e9 / exec.node->getSampleRate());
+                    exec.node->getTiming().record(NodeTiming::nowNs() - start, budget);
+                } else {
+                    exec.node->process(frames);
+                }
+            } else {
+                for (int i = 0; i < exec.node->getNumOutputBuffers(); ++i) {
+                    float* buf = exec.node->getOutputBuffer(i);
+                    std::fill(buf, buf + frames * channels, 0.0f);
+                }
+            }
+
+            for (auto& route : exec.outgoingRoutes) {
+                float* src = route.sourceNode->getOutputBuffer(route.sourcePort);
+                float* dst = route.destNode->getInputBuffer(route.destPort);
+                SIMD::add(src, dst, frames * channels);
+            }
+        }
+    }
+};
+
+} // namespace Beam
+
+#endif // PLAN_EXECUTOR_HPP
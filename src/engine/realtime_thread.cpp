@@ -0,0 +1,162 @@
+#include "realtime_thread.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+namespace Beam {
+
+void RealtimeThread::configure(const Config& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    m_hugePages.store(config.hugePages, std::memory_order_relaxed);
+}
+
+RealtimeThread::Config RealtimeThread::getConfig() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_config;
+}
+
+int RealtimeThread::coreForSlot(int slot) const {
+    if (slot < 0) return -1;
+    if (!m_config.cores.empty()) return m_config.cores[(size_t)slot % m_config.cores.size()];
+    // Unconfigured: leave the callback thread alone, spread pipeline stages over the other cores.
+    const unsigned cores = std::thread::hardware_concurrency();
+    return (slot > 0 && cores > 1) ? (int)((unsigned)slot % cores) : -1;
+}
+
+bool RealtimeThread::apply(std::thread::native_handle_type handle, int slot, int priorityOffset) {
+    Config config;
+    int core;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        config = m_config;
+        core = coreForSlot(slot);
+    }
+    bool ok = true;
+
+#ifdef _WIN32
+    if (config.realtime) {
+        ok = SetThreadPriority((HANDLE)handle, priorityOffset >= 0 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST) != 0;
+    }
+    if (core >= 0) SetThreadAffinityMask((HANDLE)handle, (DWORD_PTR)1 << core);
+#else
+    if (config.realtime) {
+        sched_param param{};
+        const int lo = sched_get_priority_min(SCHED_FIFO), hi = sched_get_priority_max(SCHED_FIFO);
+        param.sched_priority = std::max(lo, std::min(hi, config.priority + priorityOffset));
+        const int err = pthread_setschedparam(handle, SCHED_FIFO, &param);
+        ok = err == 0;
+        if (!ok && !m_warnedPriority.exchange(true)) {
+            std::cerr << "RealtimeThread: SCHED_FIFO unavailable (" << std::strerror(err)
+                      << "); grant rtprio in /etc/security/limits.conf for real-time audio." << std::endl;
+        }
+    }
+#ifdef __linux__
+    if (core >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pthread_setaffinity_np(handle, sizeof(set), &set);
+    }
+#endif // No affinity API elsewhere (macOS): the scheduler places the threads
+#endif
+    return ok;
+}
+
+bool RealtimeThread::promoteCurrentThread(int slot, int priorityOffset) {
+#ifdef _WIN32
+    const bool ok = apply(GetCurrentThread(), slot, priorityOffset);
+#else
+    const bool ok = apply(pthread_self(), slot, priorityOffset);
+#endif
+    // Fault in the stack the callback will use, so its first deep call does not.
+    volatile char stack[64 * 1024];
+    std::memset((char*)stack, 0, sizeof(stack));
+    return ok;
+}
+
+bool RealtimeThread::promote(std::thread& thread, int slot, int priorityOffset) {
+    return apply(thread.native_handle(), slot, priorityOffset);
+}
+
+bool RealtimeThread::lockMemory() {
+    if (!getConfig().lockMemory || m_memoryLocked.load()) return m_memoryLocked.load();
+#if defined(_WIN32)
+    return false;
+#else
+    // With a finite limit MCL_FUTURE would make later allocations fail once it is reached,
+    // so only lock everything when the limit is unlimited and fall back to per-buffer locks.
+    rlimit limit{};
+    if (getrlimit(RLIMIT_MEMLOCK, &limit) != 0 || limit.rlim_cur != RLIM_INFINITY) {
+        std::cout << "RealtimeThread: memlock limit is finite, locking DSP buffers individually." << std::endl;
+        return false;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "RealtimeThread: mlockall failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    m_memoryLocked.store(true);
+    return true;
+#endif
+}
+
+void RealtimeThread::prefault(void* data, size_t bytes) {
+    if (!data || bytes == 0) return;
+#ifdef _WIN32
+    const size_t page = 4096;
+#else
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+    volatile char* begin = static_cast<volatile char*>(data);
+    for (size_t offset = 0; offset < bytes; offset += page - ((size_t)(begin + offset) % page)) {
+        begin[offset] = begin[offset];
+    }
+    begin[bytes - 1] = begin[bytes - 1];
+
+#ifndef _WIN32
+    RealtimeThread& rt = instance();
+    if (!rt.isMemoryLocked() && rt.getConfig().lockMemory) mlock(data, bytes); // Best effort within the limit
+#endif
+}
+
+void* RealtimeThread::allocate(size_t bytes) {
+    const bool huge = instance().m_hugePages.load(std::memory_order_relaxed) && bytes >= kHugePageSize / 8;
+    const size_t alignment = huge ? kHugePageSize : 64;
+    const size_t size = (std::max<size_t>(bytes, 1) + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    void* data = nullptr;
+    if (posix_memalign(&data, alignment, size) != 0) return nullptr;
+#ifdef MADV_HUGEPAGE
+    if (huge) madvise(data, size, MADV_HUGEPAGE);
+#endif
+    return data;
+#endif
+}
+
+void RealtimeThread::deallocate(void* data) {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif
+}
+
+} // namespace Beam
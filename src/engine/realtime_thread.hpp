@@ -0,0 +1,130 @@
+#ifndef REALTIME_THREAD_HPP
+#define REALTIME_THREAD_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace Beam {
+
+/**
+ * @class RealtimeThread
+ * @brief Real-time scheduling, CPU affinity and memory residency for audio threads.
+ *
+ * The audio callback thread and the DSP workers (render-ahead, pipeline stages,
+ * asynchronous nodes) are promoted to SCHED_FIFO and optionally pinned to
+ * configured cores. Memory is locked with mlockall when the RLIMIT_MEMLOCK
+ * allows it; otherwise the buffers handed to prefault() are locked one by
+ * one. Every node's buffers are prefaulted when a plan is installed, so the
+ * first block after an edit does not take page faults.
+ *
+ * Large delay and reverb lines can additionally be backed by transparent huge
+ * pages (RealtimeBuffer), which turns hundreds of 4 KiB faults and TLB misses
+ * into a handful.
+ *
+ * All calls are best effort: without the privileges (rtprio / memlock limits)
+ * the engine runs as before and a single warning is logged.
+ */
+class RealtimeThread {
+public:
+    static constexpr size_t kHugePageSize = size_t(2) << 20;
+
+    struct Config {
+        bool realtime = true;    // SCHED_FIFO for the audio callback and DSP workers
+        int priority = 70;       // Audio callback priority; DSP workers run one below
+        std::vector<int> cores;  // Cores for pinned threads by slot; empty pins pipeline stages 1:1
+        bool lockMemory = true;  // mlockall / per-buffer mlock
+        bool hugePages = false;  // Back large RealtimeBuffers with transparent huge pages
+    };
+
+    /** @brief Slot of the device callback thread; pipeline stages use slots 1, 2, ... */
+    static constexpr int kCallbackSlot = 0;
+    /** @brief Slot for workers that should not be pinned. */
+    static constexpr int kUnpinned = -1;
+
+    static RealtimeThread& instance() {
+        static RealtimeThread inst;
+        return inst;
+    }
+
+    /** @brief Applies to threads promoted and buffers allocated afterwards. */
+    void configure(const Config& config);
+    Config getConfig() const;
+
+    /**
+     * @brief Promotes the calling thread (real-time priority, affinity for `slot`) and
+     * prefaults its stack. Call once, from the thread itself.
+     * @param priorityOffset Added to Config::priority (workers use -1).
+     */
+    bool promoteCurrentThread(int slot, int priorityOffset = 0);
+
+    /** @brief Same as promoteCurrentThread(), for a thread started by the caller. */
+    bool promote(std::thread& thread, int slot, int priorityOffset = -1);
+
+    /**
+     * @brief Locks current and future memory if the memlock limit is unlimited.
+     * @return True if all memory is locked; otherwise prefault() locks per buffer.
+     */
+    bool lockMemory();
+    bool isMemoryLocked() const { return m_memoryLocked.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Touches every page of [data, data + bytes) for writing, and locks it
+     * unless all memory is already locked. Contents are preserved.
+     */
+    static void prefault(void* data, size_t bytes);
+
+    template<typename Container>
+    static void prefault(Container& buffer) {
+        prefault(buffer.data(), buffer.size() * sizeof(typename Container::value_type));
+    }
+
+    /**
+     * @brief Allocation behind RealtimeBuffer: cache-line aligned, and huge-page
+     * aligned and advised when huge pages are enabled and the block is large.
+     */
+    static void* allocate(size_t bytes);
+    static void deallocate(void* data);
+
+private:
+    RealtimeThread() = default;
+    int coreForSlot(int slot) const;
+    bool apply(std::thread::native_handle_type handle, int slot, int priorityOffset);
+
+    mutable std::mutex m_mutex;
+    Config m_config;
+    std::atomic<bool> m_hugePages{false};
+    std::atomic<bool> m_memoryLocked{false};
+    std::atomic<bool> m_warnedPriority{false};
+};
+
+/**
+ * @brief Allocator for DSP state that must stay resident (see RealtimeThread::allocate).
+ */
+template<typename T>
+struct RealtimeAllocator {
+    using value_type = T;
+
+    RealtimeAllocator() = default;
+    template<typename U> RealtimeAllocator(const RealtimeAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        void* data = RealtimeThread::allocate(n * sizeof(T));
+        if (!data) throw std::bad_alloc();
+        return static_cast<T*>(data);
+    }
+    void deallocate(T* data, size_t) { RealtimeThread::deallocate(data); }
+
+    template<typename U> bool operator==(const RealtimeAllocator<U>&) const { return true; }
+    template<typename U> bool operator!=(const RealtimeAllocator<U>&) const { return false; }
+};
+
+/** @brief Delay lines, reverb tanks and other large per-node buffers. */
+using RealtimeBuffer = std::vector<float, RealtimeAllocator<float>>;
+
+} // namespace Beam
+
+#endif // REALTIME_THREAD_HPP
@@ -0,0 +1,118 @@
+#include "recording_writer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace Beam {
+
+namespace {
+
+const size_t DRAIN_CHUNK_FRAMES = 16384;
+const double COMMIT_INTERVAL_SECONDS = 2.0;
+
+} // namespace
+
+RecordingWriter::~RecordingWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+
+    for (auto& stream : m_streams) {
+        drain(*stream, true);
+        stream->m_encoder.close();
+    }
+}
+
+std::shared_ptr<RecordingStream> RecordingWriter::open(const std::string& filePath, int sampleRate, int channels,
+                                                       PcmFormat format, double ringSeconds) {
+    auto stream = std::make_shared<RecordingStream>();
+    stream->m_filePath = filePath;
+    stream->m_channels = channels;
+    stream->m_sampleRate = sampleRate;
+    stream->m_format = format;
+
+    // The writer thread is already off the audio path, so the encoder writes synchronously.
+    PcmEncoder::Options options;
+    options.async = false;
+    options.bufferBytes = DRAIN_CHUNK_FRAMES * channels * bytesPerSample(format);
+    if (!stream->m_encoder.open(filePath, sampleRate, channels, format, options)) return nullptr;
+
+    // All buffers are sized here so neither the audio nor the writer thread allocates.
+    size_t ringFrames = (std::max)((size_t)(ringSeconds * sampleRate), DRAIN_CHUNK_FRAMES * 2);
+    stream->m_ring.resize(ringFrames * channels);
+    stream->m_drainBuffer.resize(DRAIN_CHUNK_FRAMES * channels);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_worker.joinable()) m_worker = std::thread(&RecordingWriter::workerLoop, this);
+        m_streams.push_back(stream);
+    }
+    return stream;
+}
+
+void RecordingWriter::close(const std::shared_ptr<RecordingStream>& stream) {
+    if (!stream) return;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (stream->m_finished) return;
+    stream->m_stopRequested = true;
+    m_cv.notify_all();
+    m_closedCv.wait(lock, [&stream] { return stream->m_finished; });
+
+    std::cout << "Recording finished: " << stream->m_filePath << " (" << stream->getFramesWritten() << " frames, ring peak "
+              << stream->getHighWaterFrames() << "/" << stream->getCapacityFrames() << ", dropped "
+              << stream->getDroppedFrames() << ")" << std::endl;
+}
+
+void RecordingWriter::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        // Streams only leave the list on this thread, so iterating a snapshot without the lock is safe.
+        auto streams = m_streams;
+        lock.unlock();
+
+        std::vector<RecordingStream*> finished;
+        for (auto& stream : streams) {
+            bool stopping = stream->m_stopRequested.load();
+            drain(*stream, stopping);
+            if (stopping) {
+                stream->m_encoder.close();
+                finished.push_back(stream.get());
+            }
+        }
+
+        lock.lock();
+        if (!finished.empty()) {
+            for (auto* stream : finished) stream->m_finished = true;
+            m_streams.erase(std::remove_if(m_streams.begin(), m_streams.end(),
+                                           [](const auto& s) { return s->m_finished; }),
+                            m_streams.end());
+            m_closedCv.notify_all();
+        }
+        m_cv.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+void RecordingWriter::drain(RecordingStream& stream, bool flushAll) {
+    const size_t channels = (size_t)stream.m_channels;
+    while (true) {
+        size_t available = stream.m_ring.availableToRead() / channels;
+        if (available == 0 || (!flushAll && available < DRAIN_CHUNK_FRAMES)) return;
+
+        size_t frames = (std::min)(available, DRAIN_CHUNK_FRAMES);
+        size_t samples = stream.m_ring.read(stream.m_drainBuffer.data(), frames * channels);
+        if (!stream.m_encoder.write(stream.m_drainBuffer.data(), samples / channels)) {
+            std::cerr << "RecordingWriter: write failed for " << stream.m_filePath << std::endl;
+        }
+        uint64_t total = stream.m_framesWritten.fetch_add(samples / channels, std::memory_order_relaxed) + samples / channels;
+
+        if (total - stream.m_committedFrames >= (uint64_t)(COMMIT_INTERVAL_SECONDS * stream.m_sampleRate)) {
+            stream.m_encoder.commit();
+            stream.m_committedFrames = total;
+        }
+    }
+}
+
+} // namespace Beam
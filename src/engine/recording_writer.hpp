@@ -0,0 +1,122 @@
+#ifndef RECORDING_WRITER_HPP
+#define RECORDING_WRITER_HPP
+
+#include "lock_free_ring.hpp"
+#include "pcm_encoder.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @class RecordingStream
+ * @brief One take being recorded: a preallocated capture ring plus its output file.
+ *
+ * The audio thread only calls push(), which copies into the ring and never
+ * blocks or allocates. The RecordingWriter thread drains the ring, converts
+ * the samples and writes them to disk.
+ */
+class RecordingStream {
+public:
+    /**
+     * @brief Audio thread: queues interleaved frames. Frames that do not fit are dropped and counted.
+     */
+    bool push(const float* interleaved, int frames) {
+        const size_t samples = (size_t)frames * m_channels;
+        size_t written = m_ring.write(interleaved, samples);
+
+        size_t used = m_ring.availableToRead() / m_channels;
+        size_t peak = m_highWater.load(std::memory_order_relaxed);
+        while (used > peak && !m_highWater.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {}
+
+        if (written < samples) {
+            m_dropped.fetch_add((samples - written) / m_channels, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& getFilePath() const { return m_filePath; }
+    int getChannels() const { return m_channels; }
+    int getSampleRate() const { return m_sampleRate; }
+    PcmFormat getFormat() const { return m_format; }
+
+    size_t getCapacityFrames() const { return m_ring.capacity() / m_channels; }
+    /** @brief Largest ring fill level seen so far, in frames. */
+    size_t getHighWaterFrames() const { return m_highWater.load(std::memory_order_relaxed); }
+    uint64_t getDroppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t getFramesWritten() const { return m_framesWritten.load(std::memory_order_relaxed); }
+
+private:
+    friend class RecordingWriter;
+
+    std::string m_filePath;
+    int m_channels = 2;
+    int m_sampleRate = 44100;
+    PcmFormat m_format = PcmFormat::Int16;
+
+    LockFreeRing<float> m_ring;
+    PcmEncoder m_encoder;
+    uint64_t m_committedFrames = 0;
+    std::vector<float> m_drainBuffer;
+
+    std::atomic<size_t> m_highWater{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_framesWritten{0};
+    std::atomic<bool> m_stopRequested{false};
+    bool m_finished = false;
+};
+
+/**
+ * @class RecordingWriter
+ * @brief Background thread that drains every active RecordingStream to disk.
+ *
+ * Rings are drained in large chunks so the file grows in long sequential
+ * writes, and all filesystem calls stay off the audio thread. File headers are
+ * committed every couple of seconds so a crash loses at most that much audio.
+ */
+class RecordingWriter {
+public:
+    static RecordingWriter& instance() {
+        static RecordingWriter inst;
+        return inst;
+    }
+
+    ~RecordingWriter();
+
+    /**
+     * @brief Creates the file and registers a stream. The ring holds `ringSeconds` of audio.
+     * @return nullptr if the file cannot be created.
+     */
+    std::shared_ptr<RecordingStream> open(const std::string& filePath, int sampleRate, int channels,
+                                          PcmFormat format = PcmFormat::Int16, double ringSeconds = 4.0);
+
+    /**
+     * @brief Writes out everything still queued, finalises the file and unregisters the stream.
+     * Blocks until the writer thread is done with it.
+     */
+    void close(const std::shared_ptr<RecordingStream>& stream);
+
+private:
+    RecordingWriter() = default;
+
+    void workerLoop();
+    void drain(RecordingStream& stream, bool flushAll);
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_closedCv;
+    std::vector<std::shared_ptr<RecordingStream>> m_streams;
+    std::thread m_worker;
+    bool m_stop = false;
+};
+
+} // namespace Beam
+
+#endif // RECORDING_WRITER_HPP
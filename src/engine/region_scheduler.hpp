@@ -0,0 +1,141 @@
+#ifndef REGION_SCHEDULER_HPP
+#define REGION_SCHEDULER_HPP
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @struct RegionSegment
+ * @brief A clip placement as seen by playback: timeline position, length and source offset.
+ */
+struct RegionSegment {
+    uint64_t timelineStart;
+    uint64_t length;
+    uint64_t sourceOffset;
+};
+
+/**
+ * @class RegionMap
+ * @brief Immutable interval index mapping timeline frames to source frames for one track.
+ *
+ * Built on the UI thread from the track's regions (later regions cover earlier
+ * ones where they overlap) into a sorted list of disjoint segments. Playback
+ * walks it with a Cursor: a seek is a binary search, linear playback advances
+ * one segment at a time, so the per-block cost does not depend on clip count.
+ */
+class RegionMap {
+public:
+    struct Segment {
+        uint64_t start;        ///< First timeline frame
+        uint64_t end;          ///< One past the last timeline frame
+        uint64_t sourceStart;  ///< Source frame played at `start`
+    };
+
+    /**
+     * @brief Playback position within a map. Owned by a single reader thread.
+     */
+    struct Cursor {
+        const RegionMap* map = nullptr;
+        size_t index = 0;
+    };
+
+    /**
+     * @brief The stretch of timeline starting at a frame that maps uniformly to the source.
+     */
+    struct Span {
+        uint64_t frames;      ///< Length of the span (UINT64_MAX after the last segment)
+        bool audible;         ///< False inside gaps
+        uint64_t sourceFrame; ///< Source frame for the first timeline frame (if audible)
+    };
+
+    static std::shared_ptr<const RegionMap> build(const std::vector<RegionSegment>& regions) {
+        // Painter's algorithm over an ordered map: each region trims whatever it covers.
+        std::map<uint64_t, Segment> painted;
+        for (const auto& r : regions) {
+            if (r.length == 0) continue;
+            const uint64_t s = r.timelineStart, e = r.timelineStart + r.length;
+
+            auto it = painted.lower_bound(s);
+            if (it != painted.begin()) {
+                auto prev = std::prev(it);
+                if (prev->second.end > s) {
+                    Segment& p = prev->second;
+                    if (p.end > e) painted[e] = { e, p.end, p.sourceStart + (e - p.start) };
+                    p.end = s;
+                }
+            }
+            while (it != painted.end() && it->first < e) {
+                Segment seg = it->second;
+                it = painted.erase(it);
+                if (seg.end > e) {
+                    painted[e] = { e, seg.end, seg.sourceStart + (e - seg.start) };
+                    break;
+                }
+            }
+            painted[s] = { s, e, r.sourceOffset };
+        }
+
+        auto map = std::shared_ptr<RegionMap>(new RegionMap());
+        map->m_segments.reserve(painted.size());
+        for (const auto& [start, seg] : painted) {
+            // Coalesce neighbours that continue the same source run (e.g. an unmoved slice).
+            if (!map->m_segments.empty()) {
+                Segment& last = map->m_segments.back();
+                if (last.end == seg.start && last.sourceStart + (last.end - last.start) == seg.sourceStart) {
+                    last.end = seg.end;
+                    continue;
+                }
+            }
+            map->m_segments.push_back(seg);
+        }
+        return map;
+    }
+
+    const std::vector<Segment>& getSegments() const { return m_segments; }
+
+    /**
+     * @brief Index of the first segment ending after `frame` (O(log n)).
+     */
+    size_t locate(uint64_t frame) const {
+        auto it = std::upper_bound(m_segments.begin(), m_segments.end(), frame,
+                                   [](uint64_t f, const Segment& s) { return f < s.end; });
+        return (size_t)(it - m_segments.begin());
+    }
+
+    /**
+     * @brief Resolves the span starting at `frame`, moving the cursor as needed.
+     * Advancing to the next segment is O(1); any other jump falls back to locate().
+     */
+    Span spanAt(Cursor& cursor, uint64_t frame) const {
+        if (cursor.map != this || !isValid(cursor.index, frame)) {
+            if (cursor.map == this && isValid(cursor.index + 1, frame)) cursor.index++;
+            else cursor.index = locate(frame);
+            cursor.map = this;
+        }
+
+        if (cursor.index >= m_segments.size()) return { UINT64_MAX, false, 0 };
+        const Segment& seg = m_segments[cursor.index];
+        if (frame < seg.start) return { seg.start - frame, false, 0 };
+        return { seg.end - frame, true, seg.sourceStart + (frame - seg.start) };
+    }
+
+private:
+    RegionMap() = default;
+
+    bool isValid(size_t index, uint64_t frame) const {
+        if (index > m_segments.size()) return false;
+        if (index > 0 && m_segments[index - 1].end > frame) return false;
+        return index == m_segments.size() || m_segments[index].end > frame;
+    }
+
+    std::vector<Segment> m_segments;
+};
+
+} // namespace Beam
+
+#endif // REGION_SCHEDULER_HPP
@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <string>
 
 namespace Beam {
 
@@ -21,6 +22,8 @@ struct SignalRoute {
 struct NodeExecution {
     std::shared_ptr<FluxNode> node; 
     std::vector<SignalRoute> outgoingRoutes;
+    int stage = 0; // Pipeline stage (see PipelineExecutor)
+    std::string name; // node->getName(), cached at compile time for tracing
 };
 
 // The complete immutable plan for one audio callback
@@ -33,6 +36,12 @@ struct RenderPlan {
         int portIdx;
     };
     std::vector<BufferClearOp> clearOps;
+
+    // Largest accumulated node latency along any path through the graph, in frames
+    int latencyFrames = 0;
+
+    // Number of pipeline stages the sequence is split into (1 = not pipelined)
+    int numStages = 1;
 };
 
 } // namespace Beam
@@ -0,0 +1,244 @@
+#include "rt_checks.hpp"
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <algorithm>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#include <unistd.h>
+#define FLUX_RT_HAVE_BACKTRACE 1
+#endif
+
+// malloc and pthread interposition needs glibc, and would fight the sanitizers' own hooks.
+#if defined(FLUX_RT_CHECKS) && defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define FLUX_RT_HOOK_LIBC 1
+#include <dlfcn.h>
+#include <pthread.h>
+#include <cerrno>
+#endif
+
+namespace Beam {
+
+std::array<RealtimeChecks::Record, RealtimeChecks::kMaxRecords> RealtimeChecks::s_records;
+
+namespace {
+
+#ifdef FLUX_RT_CHECKS
+// backtrace() loads its unwinder (and allocates) on first use; do that before any scope runs.
+struct StartupHooks {
+    StartupHooks() {
+#ifdef FLUX_RT_HAVE_BACKTRACE
+        void* frame[1];
+        backtrace(frame, 1);
+#endif
+        const char* env = std::getenv("FLUX_RT_ABORT");
+        if (env && env[0] == '1') RealtimeChecks::setAbortOnViolation(true);
+    }
+} s_startupHooks;
+#endif
+
+} // namespace
+
+const char* RealtimeChecks::toString(Violation kind) {
+    switch (kind) {
+        case Violation::Allocation: return "allocation";
+        case Violation::Deallocation: return "deallocation";
+        case Violation::Lock: return "mutex lock";
+    }
+    return "unknown";
+}
+
+void RealtimeChecks::report(Violation kind, size_t bytes) {
+    Allow allow; // Capturing the stack must not report itself
+
+    const uint64_t index = s_count.fetch_add(1, std::memory_order_acq_rel);
+    Record local;
+    local.kind = kind;
+    local.bytes = bytes;
+#ifdef FLUX_RT_HAVE_BACKTRACE
+    local.depth = backtrace(local.stack.data(), kStackDepth);
+#endif
+    if (index < kMaxRecords) s_records[index] = local;
+
+    if (isAbortOnViolation()) {
+        char line[96];
+        int length = std::snprintf(line, sizeof(line), "Real-time violation: %s (%zu bytes) on a real-time thread\n",
+                                   toString(kind), bytes);
+        std::fwrite(line, 1, (size_t)length, stderr);
+#ifdef FLUX_RT_HAVE_BACKTRACE
+        backtrace_symbols_fd(local.stack.data(), local.depth, STDERR_FILENO);
+#endif
+        std::abort();
+    }
+}
+
+std::vector<RealtimeChecks::Record> RealtimeChecks::getRecords() {
+    const size_t count = (size_t)(std::min)(getViolationCount(), (uint64_t)kMaxRecords);
+    return std::vector<Record>(s_records.begin(), s_records.begin() + count);
+}
+
+void RealtimeChecks::printReport(std::ostream& out) {
+    const auto records = getRecords();
+    out << "Real-time violations: " << getViolationCount() << std::endl;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& record = records[i];
+        out << "#" << i << " " << toString(record.kind);
+        if (record.kind == Violation::Allocation) out << " of " << record.bytes << " bytes";
+        out << std::endl;
+#ifdef FLUX_RT_HAVE_BACKTRACE
+        char** symbols = backtrace_symbols(record.stack.data(), record.depth);
+        // Frame 0 is report() and frame 1 the hook.
+        for (int f = 2; symbols && f < record.depth; ++f) out << "    " << symbols[f] << std::endl;
+        std::free(symbols);
+#endif
+    }
+}
+
+void RealtimeChecks::reset() {
+    s_count.store(0, std::memory_order_release);
+}
+
+} // namespace Beam
+
+#ifdef FLUX_RT_CHECKS
+
+using Beam::RealtimeChecks;
+
+namespace {
+
+void* checkedAlloc(size_t size) {
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Allocation, size);
+    RealtimeChecks::Allow allow; // Reported once here, not again by the malloc hook
+    return std::malloc(size ? size : 1);
+}
+
+void* checkedAlignedAlloc(size_t size, std::align_val_t align) {
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Allocation, size);
+    RealtimeChecks::Allow allow;
+    const size_t alignment = (std::max)((size_t)align, sizeof(void*));
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    void* data = nullptr;
+    return posix_memalign(&data, alignment, size ? size : 1) == 0 ? data : nullptr;
+#endif
+}
+
+void checkedFree(void* data) {
+    if (!data) return;
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Deallocation, 0);
+    RealtimeChecks::Allow allow;
+    std::free(data);
+}
+
+void checkedAlignedFree(void* data) {
+    if (!data) return;
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Deallocation, 0);
+    RealtimeChecks::Allow allow;
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif
+}
+
+void* throwingAlloc(size_t size) {
+    void* data = checkedAlloc(size);
+    if (!data) throw std::bad_alloc();
+    return data;
+}
+
+void* throwingAlignedAlloc(size_t size, std::align_val_t align) {
+    void* data = checkedAlignedAlloc(size, align);
+    if (!data) throw std::bad_alloc();
+    return data;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return throwingAlloc(size); }
+void* operator new[](size_t size) { return throwingAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return checkedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return checkedAlloc(size); }
+void* operator new(size_t size, std::align_val_t align) { return throwingAlignedAlloc(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return throwingAlignedAlloc(size, align); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return checkedAlignedAlloc(size, align); }
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return checkedAlignedAlloc(size, align); }
+
+void operator delete(void* data) noexcept { checkedFree(data); }
+void operator delete[](void* data) noexcept { checkedFree(data); }
+void operator delete(void* data, size_t) noexcept { checkedFree(data); }
+void operator delete[](void* data, size_t) noexcept { checkedFree(data); }
+void operator delete(void* data, const std::nothrow_t&) noexcept { checkedFree(data); }
+void operator delete[](void* data, const std::nothrow_t&) noexcept { checkedFree(data); }
+void operator delete(void* data, std::align_val_t) noexcept { checkedAlignedFree(data); }
+void operator delete[](void* data, std::align_val_t) noexcept { checkedAlignedFree(data); }
+void operator delete(void* data, size_t, std::align_val_t) noexcept { checkedAlignedFree(data); }
+void operator delete[](void* data, size_t, std::align_val_t) noexcept { checkedAlignedFree(data); }
+void operator delete(void* data, std::align_val_t, const std::nothrow_t&) noexcept { checkedAlignedFree(data); }
+void operator delete[](void* data, std::align_val_t, const std::nothrow_t&) noexcept { checkedAlignedFree(data); }
+
+#ifdef FLUX_RT_HOOK_LIBC
+
+// C allocations (SDL, miniaudio, C++ runtime internals) and every pthread mutex,
+// including std::mutex, go through these before reaching glibc.
+extern "C" {
+
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+
+void* malloc(size_t size) {
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Allocation, size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Allocation, count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* data, size_t size) {
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Allocation, size);
+    return __libc_realloc(data, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Allocation, size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Allocation, size);
+    void* data = __libc_memalign(alignment, size);
+    if (!data) return ENOMEM;
+    *out = data;
+    return 0;
+}
+
+void free(void* data) {
+    if (data && RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Deallocation, 0);
+    __libc_free(data);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    using LockFn = int (*)(pthread_mutex_t*);
+    static std::atomic<LockFn> real{nullptr};
+    LockFn fn = real.load(std::memory_order_acquire);
+    if (!fn) {
+        fn = reinterpret_cast<LockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        real.store(fn, std::memory_order_release);
+    }
+    if (RealtimeChecks::isChecking()) RealtimeChecks::report(RealtimeChecks::Violation::Lock, 0);
+    return fn(mutex);
+}
+
+} // extern "C"
+
+#endif // FLUX_RT_HOOK_LIBC
+
+#endif // FLUX_RT_CHECKS
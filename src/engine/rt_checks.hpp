@@ -0,0 +1,113 @@
+#ifndef RT_CHECKS_HPP
+#define RT_CHECKS_HPP
+
+#include <atomic>
+#include <array>
+#include <ostream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Beam {
+
+/**
+ * @class RealtimeChecks
+ * @brief Debug/test detector for allocations and locks on real-time threads.
+ *
+ * Code that must stay real-time safe runs inside FLUX_RT_SCOPE(): the engine
+ * block, the device callbacks, pipeline stages, the render-ahead worker and
+ * asynchronous nodes. In builds with FLUX_RT_CHECKS defined, operator
+ * new/delete, malloc/free (glibc) and pthread_mutex_lock are intercepted; a
+ * call made inside a scope is a violation. It is recorded with its stack
+ * (first kMaxRecords) or, with setAbortOnViolation(true) or FLUX_RT_ABORT=1 in
+ * the environment, printed and aborted on.
+ *
+ * Known exceptions that are accepted for now (SDL's own stream lock) are
+ * wrapped in FLUX_RT_ALLOW(). Without FLUX_RT_CHECKS both macros compile to
+ * nothing and no hooks are installed.
+ */
+class RealtimeChecks {
+public:
+    enum class Violation : uint8_t { Allocation, Deallocation, Lock };
+
+    static constexpr size_t kMaxRecords = 64;
+    static constexpr int kStackDepth = 24;
+
+    struct Record {
+        Violation kind = Violation::Allocation;
+        size_t bytes = 0;   // Requested size, for allocations
+        int depth = 0;      // Captured stack frames
+        std::array<void*, kStackDepth> stack{};
+    };
+
+    /** @brief True if this build intercepts allocations and locks. */
+    static constexpr bool isCompiledIn() {
+#ifdef FLUX_RT_CHECKS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void setAbortOnViolation(bool enabled) { s_abort.store(enabled, std::memory_order_relaxed); }
+    static bool isAbortOnViolation() { return s_abort.load(std::memory_order_relaxed); }
+
+    static uint64_t getViolationCount() { return s_count.load(std::memory_order_acquire); }
+
+    /** @brief The recorded violations (at most kMaxRecords). Not from a real-time scope. */
+    static std::vector<Record> getRecords();
+
+    /** @brief Writes every recorded violation with a symbolized stack. */
+    static void printReport(std::ostream& out);
+
+    static void reset();
+
+    /** @brief True while the calling thread is inside a real-time scope (and not allowed). */
+    static bool isChecking() { return t_depth > 0 && t_allow == 0; }
+
+    /** @brief Called by the hooks. Never allocates or locks. */
+    static void report(Violation kind, size_t bytes);
+
+    static const char* toString(Violation kind);
+
+    /** @brief Marks the calling thread as real-time for its lifetime. Nests. */
+    class Scope {
+    public:
+        Scope() { ++t_depth; }
+        ~Scope() { --t_depth; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /** @brief Suspends checking inside a real-time scope. Nests. */
+    class Allow {
+    public:
+        Allow() { ++t_allow; }
+        ~Allow() { --t_allow; }
+        Allow(const Allow&) = delete;
+        Allow& operator=(const Allow&) = delete;
+    };
+
+private:
+    static inline thread_local int t_depth = 0;
+    static inline thread_local int t_allow = 0;
+
+    static inline std::atomic<bool> s_abort{false};
+    static inline std::atomic<uint64_t> s_count{0};
+    static std::array<Record, kMaxRecords> s_records;
+};
+
+} // namespace Beam
+
+#define FLUX_RT_CONCAT_INNER(a, b) a##b
+#define FLUX_RT_CONCAT(a, b) FLUX_RT_CONCAT_INNER(a, b)
+
+#ifdef FLUX_RT_CHECKS
+#define FLUX_RT_SCOPE() ::Beam::RealtimeChecks::Scope FLUX_RT_CONCAT(fluxRtScope_, __LINE__)
+#define FLUX_RT_ALLOW() ::Beam::RealtimeChecks::Allow FLUX_RT_CONCAT(fluxRtAllow_, __LINE__)
+#else
+#define FLUX_RT_SCOPE() ((void)0)
+#define FLUX_RT_ALLOW() ((void)0)
+#endif
+
+#endif // RT_CHECKS_HPP
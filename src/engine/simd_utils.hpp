@@ -2,6 +2,8 @@
 #define SIMD_UTILS_HPP
 
 #include <immintrin.h>
+#include <cstdint>
+#include <cmath>
 
 namespace Beam {
 namespace SIMD {
@@ -40,6 +42,140 @@ inline void copy(const float* src, float* dst, int count) {
     }
 }
 
+/**
+ * @brief Accumulates per-channel minimum and maximum over interleaved frames using SSE.
+ * @param outMin Running minimum per channel (must be initialised by the caller).
+ * @param outMax Running maximum per channel (must be initialised by the caller).
+ */
+inline void minMax(const float* src, int frames, int channels, float* outMin, float* outMax) {
+    int i = 0;
+    const int count = frames * channels;
+    if (channels == 1 || channels == 2 || channels == 4) {
+        // 4 lanes hold whole frames, so lane k always belongs to channel k % channels.
+        __m128 vmin = _mm_set1_ps(outMin[0]);
+        __m128 vmax = _mm_set1_ps(outMax[0]);
+        if (channels > 1) {
+            float mins[4], maxs[4];
+            for (int l = 0; l < 4; ++l) { mins[l] = outMin[l % channels]; maxs[l] = outMax[l % channels]; }
+            vmin = _mm_loadu_ps(mins);
+            vmax = _mm_loadu_ps(maxs);
+        }
+        for (; i <= count - 4; i += 4) {
+            __m128 v = _mm_loadu_ps(&src[i]);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+        float mins[4], maxs[4];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+        for (int l = 0; l < 4; ++l) {
+            int c = l % channels;
+            if (mins[l] < outMin[c]) outMin[c] = mins[l];
+            if (maxs[l] > outMax[c]) outMax[c] = maxs[l];
+        }
+    }
+    for (; i < count; ++i) {
+        int c = i % channels;
+        if (src[i] < outMin[c]) outMin[c] = src[i];
+        if (src[i] > outMax[c]) outMax[c] = src[i];
+    }
+}
+
+/**
+ * @brief Clamps to [-1, 1] and converts to signed 16-bit PCM using SSE2.
+ */
+inline void floatToInt16(const float* src, int16_t* dst, int count) {
+    int i = 0;
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i <= count - 8; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i]), lo), hi), scale);
+        __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i + 4]), lo), hi), scale);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]), packed);
+    }
+    for (; i < count; ++i) {
+        float s = src[i] < -1.0f ? -1.0f : (src[i] > 1.0f ? 1.0f : src[i]);
+        dst[i] = (int16_t)std::lrintf(s * 32767.0f);
+    }
+}
+
+/**
+ * @brief Clamps to [-1, 1] and converts to packed little-endian 24-bit PCM (3 bytes per sample).
+ */
+inline void floatToInt24(const float* src, uint8_t* dst, int count) {
+    int i = 0;
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(8388607.0f);
+    alignas(16) int32_t tmp[4];
+    for (; i <= count - 4; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i]), lo), hi), scale);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp), _mm_cvtps_epi32(v));
+        for (int k = 0; k < 4; ++k) {
+            uint8_t* out = dst + (size_t)(i + k) * 3;
+            out[0] = (uint8_t)(tmp[k]);
+            out[1] = (uint8_t)(tmp[k] >> 8);
+            out[2] = (uint8_t)(tmp[k] >> 16);
+        }
+    }
+    for (; i < count; ++i) {
+        float s = src[i] < -1.0f ? -1.0f : (src[i] > 1.0f ? 1.0f : src[i]);
+        int32_t v = (int32_t)std::lrintf(s * 8388607.0f);
+        uint8_t* out = dst + (size_t)i * 3;
+        out[0] = (uint8_t)(v);
+        out[1] = (uint8_t)(v >> 8);
+        out[2] = (uint8_t)(v >> 16);
+    }
+}
+
+/**
+ * @brief Copies a buffer while clamping every sample to [-1, 1].
+ */
+inline void clamp(const float* src, float* dst, int count) {
+    int i = 0;
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    for (; i <= count - 4; i += 4) {
+        _mm_storeu_ps(&dst[i], _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i]), lo), hi));
+    }
+    for (; i < count; ++i) {
+        dst[i] = src[i] < -1.0f ? -1.0f : (src[i] > 1.0f ? 1.0f : src[i]);
+    }
+}
+
+/**
+ * @brief Adds triangular (TPDF) dither of +/- `lsb` to a buffer.
+ * @param state Four independent xorshift32 generators (must be non-zero), advanced in place.
+ */
+inline void addTpdfDither(const float* src, float* dst, int count, float lsb, uint32_t state[4]) {
+    int i = 0;
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    const __m128i mantissa = _mm_set1_epi32(0x007FFFFF);
+    const __m128i one = _mm_set1_epi32(0x3F800000);
+    const __m128 scale = _mm_set1_ps(lsb);
+
+    auto next = [&x, &mantissa, &one]() {
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        // Random mantissa with exponent 0 gives a float in [1, 2)
+        return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(x, mantissa), one));
+    };
+
+    for (; i <= count - 4; i += 4) {
+        __m128 tri = _mm_sub_ps(next(), next()); // (-1, 1), triangular
+        _mm_storeu_ps(&dst[i], _mm_add_ps(_mm_loadu_ps(&src[i]), _mm_mul_ps(tri, scale)));
+    }
+    if (i < count) {
+        alignas(16) float tri[4];
+        _mm_store_ps(tri, _mm_sub_ps(next(), next()));
+        for (int k = 0; i < count; ++i, ++k) dst[i] = src[i] + tri[k] * lsb;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), x);
+}
+
 } // namespace SIMD
 } // namespace Beam
 
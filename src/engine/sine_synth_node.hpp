@@ -14,10 +14,13 @@ namespace Beam {
 class SineSynthNode : public FluxNode {
 public:
     SineSynthNode(int bufferSize, float sampleRate) 
-        : m_sampleRate(sampleRate), m_phase(0.0f), m_active(false) {
+        : m_phase(0.0f), m_active(false) {
+        m_sampleRate = sampleRate;
         setupBuffers(0, 1, bufferSize, 2);
     }
 
+    bool isLiveSource() const override { return true; }
+
     void processMIDI(const MIDIBuffer& midi) override {
         for (const auto& event : midi.getEvents()) {
             uint8_t type = event.status & 0xF0;
@@ -53,7 +56,6 @@ public:
     }
 
 private:
-    float m_sampleRate;
     float m_frequency = 440.0f;
     float m_phase;
     bool m_active;
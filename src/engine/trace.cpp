@@ -0,0 +1,172 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+namespace Beam {
+
+namespace {
+
+// Trace event names are plain identifiers; escape anything JSON would choke on.
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out << '\\' << *c;
+        else if ((unsigned char)*c < 0x20) out << ' ';
+        else out << *c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+void TraceBuffer::record(char phase, const char* name, uint64_t ns) {
+    const uint64_t index = m_writeIndex.load(std::memory_order_relaxed);
+    TraceEvent& event = m_events[index % kCapacity];
+    event.ns = ns;
+    event.phase = phase;
+    size_t length = 0;
+    while (length < TraceEvent::kNameLength - 1 && name[length]) {
+        event.name[length] = name[length];
+        ++length;
+    }
+    event.name[length] = '\0';
+    m_writeIndex.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceBuffer::snapshot() const {
+    const uint64_t end = m_writeIndex.load(std::memory_order_acquire);
+    const uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+    std::vector<TraceEvent> events;
+    events.reserve((size_t)(end - begin));
+    for (uint64_t i = begin; i < end; ++i) events.push_back(m_events[i % kCapacity]);
+
+    // Slots the writer reached while we copied may hold newer, half-written events.
+    const uint64_t after = m_writeIndex.load(std::memory_order_acquire);
+    const uint64_t firstIntact = after > kCapacity ? after - kCapacity : 0;
+    if (firstIntact > begin) {
+        const size_t drop = (size_t)(std::min)(firstIntact - begin, (uint64_t)events.size());
+        events.erase(events.begin(), events.begin() + drop);
+    }
+    return events;
+}
+
+std::string TraceBuffer::getThreadName() const {
+    std::lock_guard<std::mutex> lock(m_nameMutex);
+    return m_threadName;
+}
+
+void TraceBuffer::setThreadName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_nameMutex);
+    m_threadName = name;
+}
+
+Tracer::Tracer() {
+    const char* env = std::getenv("FLUX_TRACE");
+    if (env && std::strcmp(env, "0") != 0) setEnabled(true);
+}
+
+uint64_t Tracer::nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceBuffer& Tracer::threadBuffer() {
+    struct Slot {
+        TraceBuffer* buffer = nullptr;
+        ~Slot() { if (buffer) buffer->inUse.store(false, std::memory_order_release); }
+    };
+    thread_local Slot slot;
+    if (!slot.buffer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& buffer : m_buffers) {
+            if (!buffer->inUse.load(std::memory_order_acquire)) {
+                buffer->inUse.store(true, std::memory_order_relaxed);
+                buffer->setThreadName("Thread " + std::to_string(buffer->getThreadId()));
+                slot.buffer = buffer.get();
+                break;
+            }
+        }
+        if (!slot.buffer) {
+            const uint32_t id = (uint32_t)m_buffers.size() + 1;
+            m_buffers.push_back(std::make_unique<TraceBuffer>(id, "Thread " + std::to_string(id)));
+            slot.buffer = m_buffers.back().get();
+        }
+    }
+    return *slot.buffer;
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    threadBuffer().setThreadName(name);
+}
+
+void Tracer::record(char phase, const char* name) {
+    threadBuffer().record(phase, name, nowNs());
+}
+
+void Tracer::notifyXrun() {
+    if (isEnabled() && isDumpOnXrun()) m_dumpPending.store(true, std::memory_order_release);
+}
+
+std::string Tracer::servicePendingDump() {
+    if (!m_dumpPending.exchange(false, std::memory_order_acq_rel)) return {};
+    const uint64_t now = nowNs();
+    if (m_lastXrunDumpNs != 0 && now - m_lastXrunDumpNs < kXrunDumpCooldownMs * 1000000ull) return {};
+    m_lastXrunDumpNs = now;
+
+    std::string path = nextDumpPath();
+    if (!dump(path)) return {};
+    std::cout << "Trace: xrun, timeline written to " << path << std::endl;
+    return path;
+}
+
+void Tracer::writeJson(std::ostream& out) const {
+    std::vector<TraceBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& buffer : m_buffers) buffers.push_back(buffer.get());
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) out << ",\n";
+        first = false;
+    };
+
+    for (TraceBuffer* buffer : buffers) {
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->getThreadId() << ",\"args\":{\"name\":";
+        writeJsonString(out, buffer->getThreadName().c_str());
+        out << "}}";
+
+        for (const TraceEvent& event : buffer->snapshot()) {
+            separator();
+            out << "{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"ph\":\"" << event.phase << "\",\"ts\":" << event.ns / 1000 << '.' << (event.ns % 1000) / 100
+                << ",\"pid\":1,\"tid\":" << buffer->getThreadId() << '}';
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool Tracer::dump(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Trace: cannot write " << path << std::endl;
+        return false;
+    }
+    writeJson(file);
+    return (bool)file;
+}
+
+std::string Tracer::nextDumpPath() {
+    return "flux_trace_" + std::to_string((long long)std::time(nullptr)) + "_" + std::to_string(++m_dumpCount) + ".json";
+}
+
+} // namespace Beam
@@ -0,0 +1,172 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Beam {
+
+/**
+ * @struct TraceEvent
+ * @brief One begin ('B') or end ('E') mark in a thread's trace ring.
+ */
+struct TraceEvent {
+    static constexpr size_t kNameLength = 40;
+
+    uint64_t ns = 0;
+    char phase = 'B';
+    char name[kNameLength] = {};
+};
+
+/**
+ * @class TraceBuffer
+ * @brief Fixed ring of TraceEvents written by exactly one thread.
+ *
+ * Writing is a copy into a preallocated slot plus a release store of the write
+ * index, so it never locks or allocates. Once the ring is full the oldest
+ * events are overwritten.
+ */
+class TraceBuffer {
+public:
+    static constexpr size_t kCapacity = 16384;
+
+    TraceBuffer(uint32_t threadId, std::string threadName)
+        : m_threadId(threadId), m_threadName(std::move(threadName)) {}
+
+    void record(char phase, const char* name, uint64_t ns);
+
+    /**
+     * @brief Copies the events still in the ring. Safe while the owner keeps writing:
+     * events overwritten during the copy are dropped.
+     */
+    std::vector<TraceEvent> snapshot() const;
+
+    uint32_t getThreadId() const { return m_threadId; }
+
+    // Cleared when the owning thread exits, so the next new thread can take the buffer over.
+    std::atomic<bool> inUse{true};
+
+    std::string getThreadName() const;
+    void setThreadName(const std::string& name);
+
+private:
+    std::array<TraceEvent, kCapacity> m_events;
+    std::atomic<uint64_t> m_writeIndex{0};
+    uint32_t m_threadId;
+    mutable std::mutex m_nameMutex;
+    std::string m_threadName;
+};
+
+/**
+ * @class Tracer
+ * @brief Timeline of audio, worker, I/O and UI thread activity, exported as
+ * Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * Code marks sections with FLUX_TRACE_SCOPE("Name"). Each thread gets its own
+ * TraceBuffer the first time it records or calls setThreadName(); threads
+ * that must not allocate later (the audio and DSP threads) name themselves
+ * when they start. The buffer of a thread that exits keeps its events and is
+ * handed to the next new thread, so plan rebuilds (which restart the DSP
+ * workers) do not grow memory.
+ *
+ * Tracing is off by default; setting FLUX_TRACE=1 in the environment turns it
+ * on at startup. With tracing off a scope costs one relaxed load. A dump is
+ * written on demand (dump()), or requested by the audio thread on an xrun
+ * (notifyXrun()) and written by the UI thread in servicePendingDump(), at most
+ * once every kXrunDumpCooldownMs.
+ */
+class Tracer {
+public:
+    static constexpr uint64_t kXrunDumpCooldownMs = 5000;
+
+    static Tracer& instance() {
+        static Tracer inst;
+        return inst;
+    }
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+    void setDumpOnXrun(bool enabled) { m_dumpOnXrun.store(enabled, std::memory_order_relaxed); }
+    bool isDumpOnXrun() const { return m_dumpOnXrun.load(std::memory_order_relaxed); }
+
+    /** @brief Names the calling thread in the trace and allocates its buffer. */
+    void setThreadName(const std::string& name);
+
+    /** @brief Records a mark for the calling thread. */
+    void record(char phase, const char* name);
+
+    /** @brief Audio thread: asks for a dump (lock-free). Ignored unless tracing and dump-on-xrun are on. */
+    void notifyXrun();
+
+    /**
+     * @brief UI thread: writes the dump requested by notifyXrun(), if any.
+     * @return The file written, or an empty string.
+     */
+    std::string servicePendingDump();
+
+    /** @brief Writes every thread's events as Chrome trace-event JSON. */
+    void writeJson(std::ostream& out) const;
+
+    /** @brief writeJson() to `path`. */
+    bool dump(const std::string& path) const;
+
+    /** @brief A fresh file name in the working directory: flux_trace_<time>_<n>.json. */
+    std::string nextDumpPath();
+
+    static uint64_t nowNs();
+
+private:
+    Tracer();
+    TraceBuffer& threadBuffer();
+
+    static inline std::atomic<bool> s_enabled{false};
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> m_buffers;
+    std::atomic<bool> m_dumpOnXrun{true};
+    std::atomic<bool> m_dumpPending{false};
+    uint64_t m_lastXrunDumpNs = 0;
+    int m_dumpCount = 0;
+};
+
+/**
+ * @class TraceScope
+ * @brief Records a begin mark now and the matching end mark on destruction.
+ * `name` must stay valid for the scope's lifetime; it is copied into the ring.
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : m_name(Tracer::isEnabled() ? name : nullptr) {
+        if (m_name) Tracer::instance().record('B', m_name);
+    }
+    ~TraceScope() {
+        if (m_name) Tracer::instance().record('E', m_name);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+};
+
+} // namespace Beam
+
+#define FLUX_TRACE_CONCAT_INNER(a, b) a##b
+#define FLUX_TRACE_CONCAT(a, b) FLUX_TRACE_CONCAT_INNER(a, b)
+
+#ifdef FLUX_DISABLE_TRACING
+#define FLUX_TRACE_SCOPE(name) ((void)0)
+#else
+#define FLUX_TRACE_SCOPE(name) ::Beam::TraceScope FLUX_TRACE_CONCAT(fluxTraceScope_, __LINE__)(name)
+#endif
+
+#endif // TRACE_HPP
@@ -4,7 +4,7 @@
 #include "audio_node.hpp"
 #include "disk_streamer.hpp"
 #include "analog_base.hpp"
-#include "../../third_party/dr_wav.h"
+#include "recording_writer.hpp"
 #include <string>
 #include <atomic>
 #include <iostream>
@@ -20,15 +20,16 @@ enum class TrackState {
 
 class TrackNode : public AudioNode {
 public:
-    TrackNode(const std::string& name) 
-        : m_name(name), m_state(TrackState::Idle), m_isWriterOpen(false), 
-          m_wowFlutter(44100.0f) 
+    TrackNode(const std::string& name, float sampleRate = 44100.0f) 
+        : m_name(name), m_state(TrackState::Idle),
+          m_sampleRate(sampleRate),
+          m_wowFlutter(sampleRate) 
     {
         m_wowFlutter.setIntensity(0.001f, 0.0005f);
     }
 
     ~TrackNode() {
-        stopRecording();
+        closeTake();
     }
 
     void setTapeParams(float drive, float age) {
@@ -37,41 +38,50 @@ public:
         m_wowFlutter.setIntensity(0.001f * age, 0.002f * age);
     }
 
+    /**
+     * @brief Sets the rate the tape model runs at. Not while the track is processed.
+     */
+    void prepare(float sampleRate) {
+        m_sampleRate = sampleRate;
+        m_wowFlutter.setSampleRate(sampleRate);
+        for (auto& filter : m_ageFilters) filter.reset();
+    }
+
     bool load(const std::string& filePath) {
         m_streamer = std::make_unique<DiskStreamer>();
         return m_streamer->open(filePath);
     }
 
-    bool startRecording(const std::string& filePath, int sampleRate, int channels) {
-        drwav_data_format format;
-        format.container = drwav_container_riff;
-        format.format = DR_WAVE_FORMAT_PCM;
-        format.channels = (drwav_uint32)channels;
-        format.sampleRate = (drwav_uint32)sampleRate;
-        format.bitsPerSample = 16;
-
-        if (drwav_init_file_write(&m_wavWriter, filePath.c_str(), &format, NULL)) {
-            m_isWriterOpen = true;
-            m_state = TrackState::Recording;
-            return true;
-        }
-        return false;
+    /**
+     * @brief Opens a take without starting to record into it; switching the state to
+     * Recording (e.g. from the audio thread) starts the capture. Samples are handed to the
+     * RecordingWriter thread through a lock-free ring; nothing on the audio thread touches
+     * the file. UI thread.
+     */
+    bool openTake(const std::string& filePath, int sampleRate, int channels, PcmFormat format = PcmFormat::Int16) {
+        closeTake();
+        m_recording = RecordingWriter::instance().open(filePath, sampleRate, channels, format);
+        if (!m_recording) return false;
+        m_activeRecording = m_recording.get();
+        return true;
     }
 
-    void stopRecording() {
-        if (m_isWriterOpen) {
-            drwav_uninit(&m_wavWriter);
-            m_isWriterOpen = false;
-        }
-        m_state = TrackState::Idle;
+    /**
+     * @brief Finalizes the take. The track must already have left the Recording state. UI thread.
+     */
+    void closeTake() {
+        if (m_activeRecording.exchange(nullptr)) RecordingWriter::instance().close(m_recording);
     }
 
+    /**
+     * @brief The current (or last) take, for ring usage and drop statistics.
+     */
+    std::shared_ptr<RecordingStream> getRecordingStream() const { return m_recording; }
+
     void process(float* buffer, int frames, int channels, size_t startFrame = 0) override {
         // 1. Capture/Read raw signal
         if (m_state == TrackState::Playing && m_streamer) {
-            if (startFrame != m_lastProcessedFrame) m_streamer->seek(startFrame);
-            m_streamer->read(buffer, frames, channels);
-            m_lastProcessedFrame = startFrame + frames;
+            m_streamer->readTimeline(buffer, frames, channels, startFrame, m_nonRealtime);
         }
 
         // 2. Apply Tape Physics
@@ -83,36 +93,39 @@ public:
                 s = AnalogBase::saturateLangevin(s, 1.0f + m_tapeDrive);
                 
                 if (m_tapeAge > 0.01f) {
-                    m_ageFilters[c].setCutoff(20000.0f - (m_tapeAge * 15000.0f), 44100.0f);
+                    m_ageFilters[c].setCutoff(20000.0f - (m_tapeAge * 15000.0f), m_sampleRate);
                     s = m_ageFilters[c].process(s);
                 }
             }
         }
 
-        // 3. Write if recording
-        if (m_state == TrackState::Recording && m_isWriterOpen) {
-            std::vector<int16_t> pcm(frames * channels);
-            for (int i = 0; i < frames * channels; ++i) {
-                float s = buffer[i];
-                if (s > 1.0f) s = 1.0f;
-                if (s < -1.0f) s = -1.0f;
-                pcm[i] = (int16_t)(s * 32767.0f);
-            }
-            drwav_write_pcm_frames(&m_wavWriter, (drwav_uint64)frames, pcm.data());
+        // 3. Queue for the writer thread if recording
+        if (m_state == TrackState::Recording) {
+            if (RecordingStream* take = m_activeRecording.load(std::memory_order_acquire)) take->push(buffer, frames);
         }
     }
 
-    void setState(TrackState state) { 
-        m_state = state; 
-        if (state == TrackState::Idle) m_lastProcessedFrame = (size_t)-1;
-    }
+    void setState(TrackState state) { m_state = state; }
     TrackState getState() const { return m_state; }
+
+    /** @brief Off the real-time path, playback waits for the disk instead of playing silence. */
+    void setNonRealtime(bool nonRealtime) { m_nonRealtime = nonRealtime; }
     
     void seek(size_t frame) {
-        m_lastProcessedFrame = frame;
         if (m_streamer) m_streamer->seek(frame);
     }
 
+    /**
+     * @brief Sets the timeline layout of this track's clips. Call from the UI thread.
+     */
+    void setRegions(const std::vector<RegionSegment>& regions) {
+        if (m_streamer) m_streamer->setRegionMap(RegionMap::build(regions));
+    }
+
+    uint64_t getUnderrunCount() const {
+        return m_streamer ? m_streamer->getUnderrunCount() : 0;
+    }
+
     std::vector<std::vector<float>> getPeakData(int numPoints) {
         if (m_streamer) return m_streamer->getPeakData(numPoints);
         return {};
@@ -129,16 +142,17 @@ private:
     std::string m_name;
     std::unique_ptr<DiskStreamer> m_streamer;
     std::atomic<TrackState> m_state;
-    size_t m_lastProcessedFrame = (size_t)-1;
+    bool m_nonRealtime = false;
     
     // Tape Physics
     float m_tapeDrive = 0.0f;
     float m_tapeAge = 0.0f;
+    float m_sampleRate;
     AnalogBase::WowFlutterGenerator m_wowFlutter;
     AnalogBase::OnePoleFilter m_ageFilters[2]; // Stereo age filtering
 
-    drwav m_wavWriter;
-    bool m_isWriterOpen;
+    std::shared_ptr<RecordingStream> m_recording;          // Owned by the UI thread
+    std::atomic<RecordingStream*> m_activeRecording{nullptr}; // What the audio thread writes to
 };
 
 } // namespace Beam
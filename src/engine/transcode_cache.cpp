@@ -0,0 +1,177 @@
+#include "transcode_cache.hpp"
+#include "../../third_party/miniaudio.h"
+#include "../../third_party/dr_wav.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cctype>
+#include <algorithm>
+#include <iostream>
+
+namespace Beam {
+
+namespace fs = std::filesystem;
+
+TranscodeCache::~TranscodeCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+}
+
+void TranscodeCache::setCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cacheDirectory = directory;
+}
+
+std::string TranscodeCache::getCacheDirectory() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cacheDirectory;
+}
+
+bool TranscodeCache::isCompressed(const std::string& filePath) {
+    std::string ext = fs::path(filePath).extension().string();
+    for (auto& c : ext) c = (char)std::tolower((unsigned char)c);
+    return ext == ".mp3" || ext == ".flac" || ext == ".ogg";
+}
+
+uint64_t TranscodeCache::fingerprint(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return 0;
+
+    const uint64_t size = (uint64_t)file.tellg();
+    const uint64_t window = 64 * 1024;
+
+    uint64_t hash = 1469598103934665603ULL; // FNV-1a offset basis
+    auto mix = [&hash](const unsigned char* data, size_t len) {
+        for (size_t i = 0; i < len; ++i) {
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    mix(reinterpret_cast<const unsigned char*>(&size), sizeof(size));
+    std::error_code ec;
+    const int64_t mtime = (int64_t)fs::last_write_time(filePath, ec).time_since_epoch().count();
+    if (!ec) mix(reinterpret_cast<const unsigned char*>(&mtime), sizeof(mtime));
+
+    std::vector<char> chunk((size_t)(std::min)(window, size));
+    file.seekg(0, std::ios::beg);
+    file.read(chunk.data(), (std::streamsize)chunk.size());
+    mix(reinterpret_cast<const unsigned char*>(chunk.data()), (size_t)file.gcount());
+
+    if (size > window) {
+        file.clear();
+        file.seekg((std::streamoff)(size - chunk.size()), std::ios::beg);
+        file.read(chunk.data(), (std::streamsize)chunk.size());
+        mix(reinterpret_cast<const unsigned char*>(chunk.data()), (size_t)file.gcount());
+    }
+    return hash;
+}
+
+std::string TranscodeCache::cachePathFor(uint64_t fp) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.f32.wav", (unsigned long long)fp);
+    return (fs::path(getCacheDirectory()) / name).string();
+}
+
+std::string TranscodeCache::lookup(const std::string& sourcePath) const {
+    uint64_t fp = fingerprint(sourcePath);
+    if (fp == 0) return {};
+    std::string path = cachePathFor(fp);
+    std::error_code ec;
+    return fs::exists(path, ec) ? path : std::string();
+}
+
+void TranscodeCache::request(const std::string& sourcePath, ReadyCallback onReady) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ensureWorker();
+        m_jobs.push_back({ sourcePath, std::move(onReady) });
+        m_pending++;
+    }
+    m_cv.notify_one();
+}
+
+void TranscodeCache::ensureWorker() {
+    if (!m_worker.joinable()) {
+        m_worker = std::thread(&TranscodeCache::workerLoop, this);
+    }
+}
+
+void TranscodeCache::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            if (m_stop) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        // Entries are written under a temporary name and renamed once complete,
+        // so an existing cache file is always a finished transcode.
+        uint64_t fp = fingerprint(job.sourcePath);
+        if (fp != 0) {
+            std::string cachePath = cachePathFor(fp);
+            std::error_code ec;
+            bool ready = fs::exists(cachePath, ec) || transcode(job.sourcePath, cachePath);
+            if (ready && job.onReady) job.onReady(cachePath);
+        }
+        m_pending--;
+    }
+}
+
+bool TranscodeCache::transcode(const std::string& sourcePath, const std::string& cachePath) {
+    std::error_code ec;
+    fs::create_directories(fs::path(cachePath).parent_path(), ec);
+
+    // Keep the native channel count and sample rate; AudioReader maps channels on playback.
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 0, 0);
+    ma_decoder decoder;
+    if (ma_decoder_init_file(sourcePath.c_str(), &config, &decoder) != MA_SUCCESS) {
+        std::cerr << "TranscodeCache: cannot decode " << sourcePath << std::endl;
+        return false;
+    }
+
+    drwav_data_format format;
+    format.container = drwav_container_riff;
+    format.format = DR_WAVE_FORMAT_IEEE_FLOAT;
+    format.channels = decoder.outputChannels;
+    format.sampleRate = decoder.outputSampleRate;
+    format.bitsPerSample = 32;
+
+    std::string partPath = cachePath + ".part";
+    drwav wav;
+    if (!drwav_init_file_write(&wav, partPath.c_str(), &format, nullptr)) {
+        ma_decoder_uninit(&decoder);
+        return false;
+    }
+
+    const ma_uint64 CHUNK_FRAMES = 65536;
+    std::vector<float> chunk((size_t)CHUNK_FRAMES * decoder.outputChannels);
+    bool ok = true;
+    while (true) {
+        ma_uint64 read = 0;
+        ma_result result = ma_decoder_read_pcm_frames(&decoder, chunk.data(), CHUNK_FRAMES, &read);
+        if (read > 0 && drwav_write_pcm_frames(&wav, read, chunk.data()) != read) { ok = false; break; }
+        if (result != MA_SUCCESS || read < CHUNK_FRAMES) break;
+    }
+
+    drwav_uninit(&wav);
+    ma_decoder_uninit(&decoder);
+
+    if (ok) fs::rename(partPath, cachePath, ec);
+    if (!ok || ec) {
+        fs::remove(partPath, ec);
+        std::cerr << "TranscodeCache: failed to write " << cachePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Beam
@@ -0,0 +1,97 @@
+#ifndef TRANSCODE_CACHE_HPP
+#define TRANSCODE_CACHE_HPP
+
+#include <string>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+namespace Beam {
+
+/**
+ * @class TranscodeCache
+ * @brief Decodes compressed sources (MP3/FLAC/OGG) once into float32 PCM WAV files.
+ *
+ * Compressed imports are queued on a background worker which decodes the whole
+ * file into the cache directory. Cache entries are named after a fingerprint of
+ * the source content and modification time, so an entry that exists is valid for
+ * any unchanged source with the same data. Playback is then served from the cached PCM file, which has the
+ * same per-block cost as a WAV import and seeks sample-exactly.
+ */
+class TranscodeCache {
+public:
+    using ReadyCallback = std::function<void(const std::string& cachedPath)>;
+
+    /** @brief Name of the cache directory, shared with PeakCache; BeamHost puts it next to the project. */
+    static constexpr const char* kDirectoryName = "flux_cache";
+
+    static TranscodeCache& instance() {
+        static TranscodeCache inst;
+        return inst;
+    }
+
+    ~TranscodeCache();
+
+    /**
+     * @brief Sets the directory where decoded PCM files are stored (created on demand).
+     */
+    void setCacheDirectory(const std::string& directory);
+    std::string getCacheDirectory() const;
+
+    /**
+     * @brief True if the file extension denotes a compressed format worth caching.
+     */
+    static bool isCompressed(const std::string& filePath);
+
+    /**
+     * @brief Cheap content fingerprint: file size and modification time plus FNV-1a over the
+     * head and tail of the file, so an edit in the middle of a same-sized file still misses.
+     * @return 0 if the file cannot be read.
+     */
+    static uint64_t fingerprint(const std::string& filePath);
+
+    /**
+     * @brief Returns the cache path for a source, or an empty string if it is not cached yet.
+     */
+    std::string lookup(const std::string& sourcePath) const;
+
+    /**
+     * @brief Queues a source for transcoding. The callback runs on the worker thread
+     * once a valid cache file exists (immediately after validation on a cache hit).
+     */
+    void request(const std::string& sourcePath, ReadyCallback onReady);
+
+    /**
+     * @brief Number of jobs that are queued or being decoded.
+     */
+    size_t getPendingJobs() const { return m_pending.load(); }
+
+private:
+    TranscodeCache() = default;
+
+    struct Job {
+        std::string sourcePath;
+        ReadyCallback onReady;
+    };
+
+    void ensureWorker();
+    void workerLoop();
+    std::string cachePathFor(uint64_t fingerprint) const;
+    bool transcode(const std::string& sourcePath, const std::string& cachePath);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_jobs;
+    std::thread m_worker;
+    bool m_stop = false;
+    std::atomic<size_t> m_pending{0};
+    std::string m_cacheDirectory = kDirectoryName;
+};
+
+} // namespace Beam
+
+#endif // TRANSCODE_CACHE_HPP
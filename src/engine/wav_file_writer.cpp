@@ -0,0 +1,244 @@
+#include "wav_file_writer.hpp"
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Beam {
+
+namespace {
+
+const size_t kAlignment = 4096;
+
+// Header layout: RIFF/WAVE | JUNK padding | fmt | data header, sample data at kHeaderBytes.
+// Past 4 GiB the file becomes RF64: the start of the JUNK area turns into the
+// ds64 chunk holding the 64-bit sizes, and the 32-bit size fields read 0xFFFFFFFF.
+const size_t kJunkOffset = 12;
+const size_t kDs64PayloadBytes = 28;
+const size_t kFmtOffset = WavFileWriter::kHeaderBytes - 32;
+const size_t kDataSizeOffset = WavFileWriter::kHeaderBytes - 4;
+
+inline void put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+inline void put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+inline void put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+
+} // namespace
+
+WavFileWriter::WavFileWriter(size_t chunkBytes, uint64_t extentBytes)
+    : m_chunkBytes((std::max)(kAlignment, chunkBytes / kAlignment * kAlignment)),
+      m_extentBytes(extentBytes) {}
+
+WavFileWriter::~WavFileWriter() {
+    close();
+}
+
+bool WavFileWriter::open(const std::string& filePath, int sampleRate, int channels, PcmFormat format) {
+    close();
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    m_format = format;
+    m_chunkFill = 0;
+    m_chunkOffset = kHeaderBytes;
+    m_dataBytes = 0;
+    m_allocatedBytes = 0;
+    m_isRF64 = false;
+
+#ifdef _WIN32
+    HANDLE h = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                           CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    m_handle = h;
+#else
+    m_fd = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) return false;
+#endif
+
+    m_chunk = static_cast<uint8_t*>(::operator new(m_chunkBytes, std::align_val_t(kAlignment)));
+    m_isOpen = true;
+
+    if (!writeHeader()) {
+        std::cerr << "WavFileWriter: cannot write header to " << filePath << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool WavFileWriter::write(const void* data, size_t bytes) {
+    if (!m_isOpen) return false;
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    m_dataBytes += bytes;
+    while (bytes > 0) {
+        size_t n = (std::min)(bytes, m_chunkBytes - m_chunkFill);
+        std::memcpy(m_chunk + m_chunkFill, src, n);
+        m_chunkFill += n;
+        src += n;
+        bytes -= n;
+        if (m_chunkFill == m_chunkBytes && !flushChunk(false)) return false;
+    }
+    return true;
+}
+
+bool WavFileWriter::commit() {
+    if (!m_isOpen) return false;
+    bool ok = flushChunk(true) && writeHeader();
+    sync();
+    return ok;
+}
+
+bool WavFileWriter::close() {
+    if (!m_isOpen) return true;
+
+    // RIFF chunks are word aligned; odd-sized data gets a pad byte.
+    bool ok = true;
+    if (m_dataBytes & 1) {
+        uint8_t pad = 0;
+        ok = write(&pad, 1);
+        m_dataBytes -= 1;
+    }
+    ok = commit() && ok;
+    ok = truncateTo(kHeaderBytes + m_dataBytes + (m_dataBytes & 1)) && ok;
+
+#ifdef _WIN32
+    CloseHandle((HANDLE)m_handle);
+    m_handle = nullptr;
+#else
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+    ::operator delete(m_chunk, std::align_val_t(kAlignment));
+    m_chunk = nullptr;
+    m_isOpen = false;
+    return ok;
+}
+
+bool WavFileWriter::writeHeader() {
+    alignas(16) uint8_t header[kHeaderBytes];
+    std::memset(header, 0, sizeof(header));
+
+    const uint64_t paddedData = m_dataBytes + (m_dataBytes & 1);
+    const uint64_t riffSize = kHeaderBytes - 8 + paddedData;
+    m_isRF64 = m_isRF64 || riffSize > 0xFFFFFFFFull;
+
+    std::memcpy(header, m_isRF64 ? "RF64" : "RIFF", 4);
+    put32(header + 4, m_isRF64 ? 0xFFFFFFFFu : (uint32_t)riffSize);
+    std::memcpy(header + 8, "WAVE", 4);
+
+    if (m_isRF64) {
+        uint8_t* ds64 = header + kJunkOffset;
+        std::memcpy(ds64, "ds64", 4);
+        put32(ds64 + 4, (uint32_t)kDs64PayloadBytes);
+        put64(ds64 + 8, riffSize);
+        put64(ds64 + 16, m_dataBytes);
+        put64(ds64 + 24, m_dataBytes / ((uint64_t)m_channels * bytesPerSample(m_format)));
+        put32(ds64 + 32, 0); // No table entries
+
+        uint8_t* junk = ds64 + 8 + kDs64PayloadBytes;
+        std::memcpy(junk, "JUNK", 4);
+        put32(junk + 4, (uint32_t)(kFmtOffset - (junk - header) - 8));
+    } else {
+        std::memcpy(header + kJunkOffset, "JUNK", 4);
+        put32(header + kJunkOffset + 4, (uint32_t)(kFmtOffset - kJunkOffset - 8));
+    }
+
+    const uint16_t bytes = (uint16_t)bytesPerSample(m_format);
+    uint8_t* fmt = header + kFmtOffset;
+    std::memcpy(fmt, "fmt ", 4);
+    put32(fmt + 4, 16);
+    put16(fmt + 8, m_format == PcmFormat::Float32 ? 3 : 1);
+    put16(fmt + 10, (uint16_t)m_channels);
+    put32(fmt + 12, (uint32_t)m_sampleRate);
+    put32(fmt + 16, (uint32_t)m_sampleRate * m_channels * bytes);
+    put16(fmt + 20, (uint16_t)(m_channels * bytes));
+    put16(fmt + 22, (uint16_t)(bytes * 8));
+
+    std::memcpy(header + kDataSizeOffset - 4, "data", 4);
+    put32(header + kDataSizeOffset, m_isRF64 ? 0xFFFFFFFFu : (uint32_t)m_dataBytes);
+
+    return writeAt(0, header, sizeof(header));
+}
+
+bool WavFileWriter::flushChunk(bool partial) {
+    if (m_chunkFill == 0) return true;
+    if (!ensureAllocated(m_chunkOffset + m_chunkBytes)) return false;
+    if (!writeAt(m_chunkOffset, m_chunk, partial ? m_chunkFill : m_chunkBytes)) return false;
+    // A partial flush keeps the staging buffer; the full chunk overwrites it later.
+    if (!partial) {
+        m_chunkOffset += m_chunkBytes;
+        m_chunkFill = 0;
+    }
+    return true;
+}
+
+bool WavFileWriter::ensureAllocated(uint64_t fileEnd) {
+    if (fileEnd <= m_allocatedBytes || m_extentBytes == 0) return true;
+    uint64_t target = (fileEnd + m_extentBytes - 1) / m_extentBytes * m_extentBytes;
+
+    // Preallocation is an optimisation: failure just means ordinary appends.
+#ifdef _WIN32
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = (LONGLONG)target;
+    SetFileInformationByHandle((HANDLE)m_handle, FileAllocationInfo, &info, sizeof(info));
+#elif defined(__linux__)
+    posix_fallocate(m_fd, (off_t)m_allocatedBytes, (off_t)(target - m_allocatedBytes));
+#elif defined(__APPLE__)
+    fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)(target - m_allocatedBytes), 0 };
+    fcntl(m_fd, F_PREALLOCATE, &store);
+#endif
+    m_allocatedBytes = target;
+    return true;
+}
+
+bool WavFileWriter::writeAt(uint64_t offset, const void* data, size_t bytes) {
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+#ifdef _WIN32
+    while (bytes > 0) {
+        OVERLAPPED ov = {};
+        ov.Offset = (DWORD)(offset & 0xFFFFFFFFu);
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD written = 0;
+        DWORD n = (DWORD)(std::min)(bytes, (size_t)(1u << 30));
+        if (!WriteFile((HANDLE)m_handle, src, n, &written, &ov) || written == 0) return false;
+        src += written; offset += written; bytes -= written;
+    }
+#else
+    while (bytes > 0) {
+        ssize_t written = ::pwrite(m_fd, src, bytes, (off_t)offset);
+        if (written <= 0) return false;
+        src += written; offset += (uint64_t)written; bytes -= (size_t)written;
+    }
+#endif
+    return true;
+}
+
+bool WavFileWriter::truncateTo(uint64_t length) {
+#ifdef _WIN32
+    LARGE_INTEGER pos;
+    pos.QuadPart = (LONGLONG)length;
+    return SetFilePointerEx((HANDLE)m_handle, pos, nullptr, FILE_BEGIN) && SetEndOfFile((HANDLE)m_handle);
+#else
+    return ::ftruncate(m_fd, (off_t)length) == 0;
+#endif
+}
+
+void WavFileWriter::sync() {
+#ifdef _WIN32
+    FlushFileBuffers((HANDLE)m_handle);
+#elif defined(__APPLE__)
+    fsync(m_fd);
+#else
+    fdatasync(m_fd);
+#endif
+}
+
+} // namespace Beam
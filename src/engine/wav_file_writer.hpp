@@ -0,0 +1,99 @@
+#ifndef WAV_FILE_WRITER_HPP
+#define WAV_FILE_WRITER_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Beam {
+
+enum class PcmFormat {
+    Int16,
+    Int24,
+    Float32
+};
+
+inline int bytesPerSample(PcmFormat format) {
+    switch (format) {
+        case PcmFormat::Int16: return 2;
+        case PcmFormat::Int24: return 3;
+        default: return 4;
+    }
+}
+
+/**
+ * @class WavFileWriter
+ * @brief Streaming WAV writer built for long, crash-tolerant recordings.
+ *
+ * - The file is preallocated in large extents so it grows without fragmenting.
+ * - Sample data starts on a 4 KiB boundary (the header is padded with a JUNK
+ *   chunk) and is written in whole, aligned chunks.
+ * - commit() writes out the partial chunk and rewrites the RIFF/data sizes, so
+ *   after a crash the file is valid up to the last commit.
+ * - close() writes the final sizes and trims the preallocated tail.
+ * - Files switch to RF64 automatically once the data outgrows the 4 GiB RIFF limit.
+ */
+class WavFileWriter {
+public:
+    static constexpr size_t kHeaderBytes = 4096;
+
+    WavFileWriter(size_t chunkBytes = 1 << 20, uint64_t extentBytes = 64ull << 20);
+    ~WavFileWriter();
+
+    WavFileWriter(const WavFileWriter&) = delete;
+    WavFileWriter& operator=(const WavFileWriter&) = delete;
+
+    bool open(const std::string& filePath, int sampleRate, int channels, PcmFormat format);
+
+    /**
+     * @brief Appends already-encoded sample bytes.
+     */
+    bool write(const void* data, size_t bytes);
+
+    /**
+     * @brief Makes everything written so far durable and visible in the header.
+     */
+    bool commit();
+
+    /**
+     * @brief Commits, trims the file to its true length and closes it.
+     */
+    bool close();
+
+    bool isOpen() const { return m_isOpen; }
+    bool isRF64() const { return m_isRF64; }
+    uint64_t getDataBytes() const { return m_dataBytes; }
+
+private:
+    bool writeHeader();
+    bool flushChunk(bool partial);
+    bool ensureAllocated(uint64_t fileEnd);
+    bool writeAt(uint64_t offset, const void* data, size_t bytes);
+    bool truncateTo(uint64_t length);
+    void sync();
+
+    size_t m_chunkBytes;
+    uint64_t m_extentBytes;
+
+    int m_sampleRate = 0;
+    int m_channels = 0;
+    PcmFormat m_format = PcmFormat::Int16;
+
+    uint8_t* m_chunk = nullptr;   // Aligned staging buffer
+    size_t m_chunkFill = 0;
+    uint64_t m_chunkOffset = 0;   // File offset the staging buffer maps to
+    uint64_t m_dataBytes = 0;     // Sample bytes accepted so far
+    uint64_t m_allocatedBytes = 0;
+    bool m_isOpen = false;
+    bool m_isRF64 = false;
+
+#ifdef _WIN32
+    void* m_handle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+} // namespace Beam
+
+#endif // WAV_FILE_WRITER_HPP
@@ -18,48 +18,60 @@ namespace Beam {
  */
 class WavReader {
 public:
+    static constexpr size_t kScratchFrames = 4096;
+
     WavReader() : m_sampleRate(0), m_channels(0), m_bitsPerSample(0), m_dataSize(0), m_dataOffset(0), m_formatTag(0) {}
 
     bool open(const std::string& filePath) {
         std::lock_guard<std::recursive_mutex> lock(m_fileMutex);
         if (m_file.is_open()) m_file.close();
+        m_file.clear();
         
         m_file.open(filePath, std::ios::binary);
         if (!m_file.is_open()) return false;
 
+        // RF64/BW64 files keep their 64-bit sizes in a ds64 chunk; the 32-bit fields read 0xFFFFFFFF.
         char buffer[4];
-        if (!m_file.read(buffer, 4) || std::string(buffer, 4) != "RIFF") return false;
+        if (!m_file.read(buffer, 4)) return false;
+        std::string magic(buffer, 4);
+        bool is64 = (magic == "RF64" || magic == "BW64");
+        if (magic != "RIFF" && !is64) return false;
         m_file.seekg(8, std::ios::beg); 
         if (!m_file.read(buffer, 4) || std::string(buffer, 4) != "WAVE") return false;
 
+        uint64_t ds64DataSize = 0;
         bool foundFmt = false;
-        while (m_file.read(buffer, 4)) {
+        bool foundData = false;
+        while (!foundData && m_file.read(buffer, 4)) {
             uint32_t chunkSize;
             if (!m_file.read(reinterpret_cast<char*>(&chunkSize), 4)) break;
-            if (std::string(buffer, 4) == "fmt ") {
+            std::string id(buffer, 4);
+            std::streamoff next = (std::streamoff)m_file.tellg() + (std::streamoff)chunkSize + (chunkSize & 1);
+
+            if (id == "ds64" && is64) {
+                uint64_t riffSize = 0;
+                m_file.read(reinterpret_cast<char*>(&riffSize), 8);
+                m_file.read(reinterpret_cast<char*>(&ds64DataSize), 8);
+            } else if (id == "fmt ") {
                 m_file.read(reinterpret_cast<char*>(&m_formatTag), 2);
                 m_file.read(reinterpret_cast<char*>(&m_channels), 2);
                 m_file.read(reinterpret_cast<char*>(&m_sampleRate), 4);
                 m_file.seekg(6, std::ios::cur); 
                 m_file.read(reinterpret_cast<char*>(&m_bitsPerSample), 2);
-                if (chunkSize > 16) m_file.seekg(chunkSize - 16, std::ios::cur);
                 if (m_channels > 0 && m_bitsPerSample > 0) foundFmt = true;
-                break;
-            } else { m_file.seekg(chunkSize, std::ios::cur); }
-        }
-
-        if (!foundFmt) return false;
-
-        bool foundData = false;
-        while (m_file.read(buffer, 4)) {
-            uint32_t chunkSize;
-            if (!m_file.read(reinterpret_cast<char*>(&chunkSize), 4)) break;
-            if (std::string(buffer, 4) == "data") {
-                m_dataSize = chunkSize;
-                m_dataOffset = (uint32_t)m_file.tellg();
+            } else if (id == "data") {
+                if (!foundFmt) return false;
+                m_dataSize = (is64 && chunkSize == 0xFFFFFFFFu) ? ds64DataSize : chunkSize;
+                m_dataOffset = (uint64_t)m_file.tellg();
                 foundData = true;
                 break;
-            } else { m_file.seekg(chunkSize, std::ios::cur); }
+            }
+            m_file.seekg(next, std::ios::beg);
+        }
+        if (foundData) {
+            // Sized for a typical block up front, so streaming reads do not allocate.
+            m_srcScratch.resize((size_t)kScratchFrames * m_channels);
+            if (m_bitsPerSample == 16) m_intScratch.resize((size_t)kScratchFrames * m_channels);
         }
         return foundData;
     }
@@ -68,18 +80,21 @@ public:
         std::lock_guard<std::recursive_mutex> lock(m_fileMutex);
         if (!m_file.is_open() || m_channels == 0 || m_bitsPerSample == 0) return 0;
 
+        // Scratch grows to the largest block seen and is reused after that.
         size_t samplesToRead = frames * m_channels;
-        std::vector<float> srcBuffer(samplesToRead, 0.0f);
+        if (m_srcScratch.size() < samplesToRead) m_srcScratch.resize(samplesToRead);
+        float* srcBuffer = m_srcScratch.data();
         size_t totalBytesRead = 0;
 
         if (m_bitsPerSample == 16) {
-            std::vector<int16_t> intBuffer(samplesToRead);
-            m_file.read(reinterpret_cast<char*>(intBuffer.data()), samplesToRead * 2);
+            if (m_intScratch.size() < samplesToRead) m_intScratch.resize(samplesToRead);
+            int16_t* intBuffer = m_intScratch.data();
+            m_file.read(reinterpret_cast<char*>(intBuffer), samplesToRead * 2);
             totalBytesRead = (size_t)m_file.gcount();
             size_t samplesRead = totalBytesRead / 2;
             for (size_t i = 0; i < samplesRead; ++i) srcBuffer[i] = intBuffer[i] / 32768.0f;
         } else if (m_bitsPerSample == 32) {
-            m_file.read(reinterpret_cast<char*>(srcBuffer.data()), samplesToRead * 4);
+            m_file.read(reinterpret_cast<char*>(srcBuffer), samplesToRead * 4);
             totalBytesRead = (size_t)m_file.gcount();
         }
 
@@ -96,17 +111,16 @@ public:
     void seek(size_t frame) {
         std::lock_guard<std::recursive_mutex> lock(m_fileMutex);
         if (!m_file.is_open()) return;
-        uint32_t bytesPerFrame = m_channels * (m_bitsPerSample / 8);
+        uint64_t bytesPerFrame = (uint64_t)m_channels * (m_bitsPerSample / 8);
         m_file.clear();
-        m_file.seekg(m_dataOffset + (frame * bytesPerFrame), std::ios::beg);
+        m_file.seekg((std::streamoff)(m_dataOffset + (uint64_t)frame * bytesPerFrame), std::ios::beg);
     }
 
     std::vector<float> getPeakData(int numPoints) {
         std::lock_guard<std::recursive_mutex> lock(m_fileMutex);
         if (!m_file.is_open() || numPoints <= 0 || m_channels == 0) return {};
         
-        size_t bytesPerFrame = m_channels * (m_bitsPerSample / 8);
-        size_t totalFrames = m_dataSize / bytesPerFrame;
+        size_t totalFrames = (size_t)getTotalFrames();
         if (totalFrames == 0) return std::vector<float>(numPoints, 0.0f);
 
         size_t framesPerPoint = totalFrames / numPoints;
@@ -142,6 +156,11 @@ public:
     uint32_t getSampleRate() const { return m_sampleRate; }
     uint16_t getChannels() const { return m_channels; }
 
+    uint64_t getTotalFrames() const {
+        uint64_t bytesPerFrame = (uint64_t)m_channels * (m_bitsPerSample / 8);
+        return bytesPerFrame ? m_dataSize / bytesPerFrame : 0;
+    }
+
 private:
     std::ifstream m_file;
     std::recursive_mutex m_fileMutex;
@@ -149,8 +168,10 @@ private:
     uint16_t m_channels;
     uint16_t m_bitsPerSample;
     uint16_t m_formatTag;
-    uint32_t m_dataSize;
-    uint32_t m_dataOffset;
+    uint64_t m_dataSize;
+    uint64_t m_dataOffset;
+    std::vector<float> m_srcScratch;
+    std::vector<int16_t> m_intScratch;
 };
 
 } // namespace Beam
@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <cstdio>
 
 namespace Beam {
 
@@ -35,7 +36,7 @@ public:
         
         // 2. Centered Window Box
         float winW = 600;
-        float winH = 500;
+        float winH = 560;
         float winX = m_bounds.x + (m_bounds.w - winW) * 0.5f;
         float winY = m_bounds.y + (m_bounds.h - winH) * 0.5f;
 
@@ -103,6 +104,28 @@ public:
             rx += 75;
         }
 
+        yOff += 40;
+        // Input Monitoring
+        batcher.drawText("Input Monitoring:", xOff, yOff, 12, 0.6f, 0.6f, 0.6f, 1.0f);
+        yOff += 20;
+        bool direct = m_engine && m_engine->isDirectMonitoring();
+        batcher.drawRoundedRect(xOff, yOff, 145, 24, 4.0f, 0.5f, direct ? 0.25f : 0.18f, direct ? 0.45f : 0.19f, direct ? 0.85f : 0.2f, 1.0f);
+        batcher.drawText(direct ? "Direct (Low Latency)" : "Through Graph", xOff + 10, yOff + 6, 11, 0.9f, 0.9f, 0.9f, 1.0f);
+
+        if (m_engine) {
+            // Adaptive output latency and what it is based on
+            yOff += 40;
+            LatencyStats stats = m_engine->getLatencyStats();
+            char line[128];
+            snprintf(line, sizeof(line), "Output Latency: %.1f ms   DSP p99: %.2f ms   Underruns: %llu   Late: %llu",
+                          stats.latencyMs, stats.dspP99Ms, (unsigned long long)stats.underruns, (unsigned long long)stats.lateBlocks);
+            batcher.drawText(line, xOff, yOff, 12, 0.6f, 0.6f, 0.6f, 1.0f);
+            if (m_engine->getQualityLevel() > 0) {
+                snprintf(line, sizeof(line), "CPU load: quality reduced to tier %d", m_engine->getQualityLevel());
+                batcher.drawText(line, xOff, yOff + 18, 12, 1.0f, 0.7f, 0.3f, 1.0f);
+            }
+        }
+
         // Close Button (Top Right)
         float closeBtnX = winX + winW - 40;
         float closeBtnY = winY + 7;
@@ -114,7 +137,7 @@ public:
         if (!m_isVisible) return false;
 
         float winW = 600;
-        float winH = 500;
+        float winH = 560;
         float winX = m_bounds.x + (m_bounds.w - winW) * 0.5f;
         float winY = m_bounds.y + (m_bounds.h - winH) * 0.5f;
 
@@ -181,6 +204,13 @@ public:
             rx += 75;
         }
 
+        currentY += 60;
+        // Input monitoring toggle
+        if (m_engine && x > xOff && x < xOff + 145 && y > currentY && y < currentY + 24) {
+            m_engine->setDirectMonitoring(!m_engine->isDirectMonitoring());
+            return true;
+        }
+
         return true; // Modal behavior: absorb all clicks
     }
 
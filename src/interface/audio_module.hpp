@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <cstdio>
 
 namespace Beam {
 
@@ -121,6 +122,18 @@ public:
             batcher.drawText("x", m_deleteBtnBounds.x + 4, m_deleteBtnBounds.y + 2, 10, 1.0f, 1.0f, 1.0f, 1.0f);
         }
 
+        // CPU Badge: this node's share of its real-time budget
+        if (NodeTiming::isEnabled()) {
+            NodeTimingStats timing = m_node->getTiming().getStats();
+            if (timing.blocks > 0) {
+                char text[16];
+                snprintf(text, sizeof(text), "%.1f%%", timing.load * 100.0);
+                float r = timing.load > 0.25 ? 1.0f : 0.5f;
+                float g = timing.load > 0.5 ? 0.3f : 0.8f;
+                batcher.drawText(text, m_bounds.x + m_bounds.w - 62, m_bounds.y + 10, 9, r, g, 0.4f, 1.0f);
+            }
+        }
+
         // Inner Content Area
         batcher.drawRoundedRect(m_bounds.x + 6, m_bounds.y + 35, m_bounds.w - 12, m_bounds.h - 41, 5.0f, 1.0f, 0.12f, 0.12f, 0.13f, 1.0f);
 
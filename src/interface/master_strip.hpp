@@ -5,16 +5,22 @@
 #include "vu_meter.hpp"
 #include "meter.hpp"
 #include "../engine/master_node.hpp"
+#include "../engine/audio_engine.hpp"
+#include <cstdio>
 
 namespace Beam {
 
 /**
  * @class MasterStrip
  * @brief High-fidelity master output strip with integrated meters and gain control.
+ *
+ * With an engine attached, the foot of the strip shows the global DSP load
+ * (mean DSP time per block over the block's duration); clicking it toggles
+ * per-node profiling.
  */
 class MasterStrip : public Component {
 public:
-    MasterStrip(std::shared_ptr<MasterNode> node) : m_node(node) {
+    MasterStrip(std::shared_ptr<MasterNode> node, AudioEngine* engine = nullptr) : m_node(node), m_engine(engine) {
         m_vuMeter = std::make_shared<VUMeter>();
         m_levelMeterL = std::make_shared<LuminousMeter>(LuminousMeter::Orientation::Vertical);
         m_levelMeterR = std::make_shared<LuminousMeter>(LuminousMeter::Orientation::Vertical);
@@ -67,9 +73,34 @@ public:
         
         batcher.drawRoundedRect(fx - 12, hy, 30, 30, 4.0f, 0.5f, 0.7f, 0.7f, 0.75f, 1.0f);
         batcher.drawQuad(fx - 10, hy + 14, 26, 2, 0.1f, 0.1f, 0.1f, 1.0f); // Center line
+
+        // DSP Load
+        if (m_engine) {
+            Rect meter = getDspMeterBounds();
+            float load = (float)m_engine->getDspLoad();
+            float fill = std::clamp(load, 0.0f, 1.0f) * meter.w;
+            float r = load > 0.8f ? 1.0f : (load > 0.5f ? 0.9f : 0.3f);
+            float g = load > 0.8f ? 0.25f : 0.75f;
+            batcher.drawQuad(meter.x, meter.y, meter.w, meter.h, 0.05f, 0.05f, 0.06f, 1.0f);
+            batcher.drawQuad(meter.x, meter.y, fill, meter.h, r, g, 0.3f, 1.0f);
+
+            char text[32];
+            snprintf(text, sizeof(text), "DSP %.0f%%%s", load * 100.0f, m_engine->isProfiling() ? " P" : "");
+            batcher.drawText(text, meter.x, meter.y - 11, 8, 0.7f, 0.7f, 0.7f, 1.0f);
+        }
     }
 
     bool onMouseDown(float x, float y, int button) override {
+        if (m_engine) {
+            Rect meter = getDspMeterBounds();
+            meter.y -= 11;
+            meter.h += 11;
+            if (meter.contains(x, y)) {
+                m_engine->setProfiling(!m_engine->isProfiling());
+                return true;
+            }
+        }
+
         float fx = m_bounds.x + (m_bounds.w - 30)/2;
         float fy = m_bounds.y + 115;
         float fh = m_bounds.h - 145;
@@ -97,6 +128,10 @@ public:
     }
 
 private:
+    Rect getDspMeterBounds() const {
+        return {m_bounds.x + 10, m_bounds.y + m_bounds.h - 12, m_bounds.w - 20, 5};
+    }
+
     void updateFader(float y) {
         if (!m_node) return;
         float fy = m_bounds.y + 115;
@@ -106,6 +141,7 @@ private:
     }
 
     std::shared_ptr<MasterNode> m_node;
+    AudioEngine* m_engine;
     std::shared_ptr<VUMeter> m_vuMeter;
     std::shared_ptr<LuminousMeter> m_levelMeterL;
     std::shared_ptr<LuminousMeter> m_levelMeterR;
@@ -4,6 +4,7 @@
 #include "audio_module.hpp"
 #include "../engine/flux_track_node.hpp"
 #include "../utilities/flux_audio_utils.hpp"
+#include <functional>
 
 namespace Beam {
 
@@ -59,23 +60,21 @@ public:
 
     bool onMouseDown(float x, float y, int button) override {
         if (AudioModule::onMouseDown(x, y, button)) return true;
-        auto track = m_trackNode->getInternalNode();
-        
+
         // Record Button check
         Rect recBounds = { m_bounds.x + m_bounds.w - 30, m_bounds.y + 8, 20, 20 };
         if (recBounds.contains(x, y)) {
-            if (track->getState() == TrackState::Recording) {
-                m_trackNode->stopRecording();
-            } else {
-                std::string path = "recording_" + std::to_string(getNodeId()) + ".wav";
-                m_trackNode->startRecording(path, 44100);
-            }
+            std::string path = "recording_" + std::to_string(getNodeId()) + ".wav";
+            if (onArmRequested) onArmRequested(m_trackNode, !m_trackNode->isArmed(), path);
             return true;
         }
 
         return false;
     }
 
+    /** @brief Asks the engine to arm (with a take path) or disarm the track. */
+    std::function<void(const std::shared_ptr<FluxTrackNode>&, bool armed, const std::string& takePath)> onArmRequested;
+
 private:
     std::shared_ptr<FluxTrackNode> m_trackNode;
     float m_rotation = 0.0f;
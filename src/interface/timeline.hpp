@@ -84,22 +84,34 @@ public:
 
                     batcher.drawRoundedRect(rx, ry, rw, rh, 4.0f, 0.5f, rCol, gCol, bCol, 1.0f);
                     
-                    if (!reg.channelPeaks.empty()) {
-                        float channelHeight = rh / (float)reg.channelPeaks.size();
-                        for (size_t c = 0; c < reg.channelPeaks.size(); ++c) {
-                            auto const& peaks = reg.channelPeaks[c];
-                            float midY = ry + (c * channelHeight) + channelHeight * 0.5f;
-                            float step = rw / (float)peaks.size();
-                            std::vector<std::pair<float, float>> top, bot;
-                            for (size_t p = 0; p < peaks.size(); ++p) {
-                                float px = rx + p * step;
-                                float ph = peaks[p] * (channelHeight * 0.45f);
-                                top.push_back({px, midY - ph});
-                                bot.push_back({px, midY + ph});
+                    auto pyramid = reg.source ? reg.source->getPeaks() : nullptr;
+                    if (pyramid && pyramid->getChannels() > 0) {
+                        // Only the visible part of the region is queried, one min/max pair per pixel
+                        float x0 = (std::max)(rx, m_bounds.x);
+                        float x1 = (std::min)(rx + rw, m_bounds.x + m_bounds.w);
+                        int numPixels = (int)(x1 - x0);
+                        if (numPixels > 0) {
+                            uint64_t startFrame = reg.sourceOffset + (uint64_t)((x0 - rx) * framesPerPixel);
+                            uint64_t numFrames = (uint64_t)(numPixels * framesPerPixel);
+                            m_peakMin.resize(numPixels);
+                            m_peakMax.resize(numPixels);
+
+                            int channels = pyramid->getChannels();
+                            float channelHeight = rh / (float)channels;
+                            for (int c = 0; c < channels; ++c) {
+                                pyramid->query(c, startFrame, numFrames, numPixels, m_peakMin.data(), m_peakMax.data());
+                                float midY = ry + (c * channelHeight) + channelHeight * 0.5f;
+                                float scale = channelHeight * 0.45f;
+                                for (int p = 0; p < numPixels; ++p) {
+                                    float top = midY - m_peakMax[p] * scale;
+                                    float bottom = midY - m_peakMin[p] * scale;
+                                    batcher.drawQuad(x0 + p, top, 1.0f, (std::max)(1.0f, bottom - top), 0.6f, 0.9f, 1.0f, 0.9f);
+                                }
                             }
-                            batcher.drawCurve(top, 1.2f, 0.6f, 0.9f, 1.0f, 1.0f);
-                            batcher.drawCurve(bot, 1.2f, 0.6f, 0.9f, 1.0f, 1.0f);
                         }
+                    } else if (reg.source) {
+                        // Pyramid still being generated
+                        batcher.drawQuad(rx, ry + rh * 0.5f, rw, 1.0f, 0.6f, 0.9f, 1.0f, 0.4f);
                     }
                     batcher.drawText(reg.name, rx + 5, ry + 5, 10, 0.9f, 0.9f, 0.9f, 1.0f);
                 }
@@ -108,7 +120,7 @@ public:
 
         // Playhead
         if (m_engine) {
-            float playheadX = m_bounds.x + (float)m_engine->getCurrentFrame() / framesPerPixel - m_offsetX;
+            float playheadX = m_bounds.x + (float)m_engine->getPlayheadFrame() / framesPerPixel - m_offsetX;
             if (playheadX >= m_bounds.x && playheadX <= m_bounds.x + m_bounds.w) {
                 batcher.drawQuad(playheadX - 1, m_bounds.y, 3, m_bounds.h, 1.0f, 0.3f, 0.3f, 1.0f);
             }
@@ -125,6 +137,11 @@ public:
                     batcher.drawText("GLUE", mx + 5, my - 15, 10, 1.0f, 1.0f, 1.0f, 1.0f);
                 }
             }
+            // Why the last tool action did nothing
+            if (m_toolMessageTime > 0.0f) {
+                m_toolMessageTime -= dt;
+                batcher.drawText(m_toolMessage, m_bounds.x + 10, m_bounds.y + m_bounds.h - 20, 12, 1.0f, 0.7f, 0.3f, 1.0f);
+            }
         }
     }
 
@@ -140,6 +157,7 @@ public:
             } else if (key == 1073741903) { // RIGHT
                 m_selectedTrackPtr->regions[m_selectedRegionIndex].startFrame += nudge;
             }
+            m_selectedTrackPtr->publishRegions();
         } else {
             if (key == 1073741904) m_offsetX = (std::max)(0.0f, m_offsetX - 50.0f);
             if (key == 1073741903) m_offsetX += 50.0f;
@@ -215,6 +233,7 @@ public:
     }
 
     bool onMouseUp(float x, float y, int button) override {
+        if (m_isDraggingRegion && m_dragTrackPtr) m_dragTrackPtr->publishRegions();
         m_isDraggingRegion = false; m_isScrubbing = false; m_isPanning = false; m_dragTrackPtr = nullptr;
         return true;
     }
@@ -234,51 +253,34 @@ public:
 private:
     void sliceRegion(TrackData& track, size_t index, size_t offsetInFrames) {
         if (offsetInFrames <= 0 || offsetInFrames >= track.regions[index].duration) return;
-        Region original = track.regions[index];
-        track.regions[index].duration = offsetInFrames;
-        
-        float ratio = (float)offsetInFrames / original.duration;
-        std::vector<std::vector<float>> p1, p2;
-        for (auto const& ch : original.channelPeaks) {
-            size_t split = (size_t)(ch.size() * ratio);
-            p1.push_back(std::vector<float>(ch.begin(), ch.begin() + split));
-            p2.push_back(std::vector<float>(ch.begin() + split, ch.end()));
-        }
-        track.regions[index].channelPeaks = p1;
-        Region second = {original.name + " (Slice)", original.startFrame + offsetInFrames, original.duration - offsetInFrames, original.sourceOffset + offsetInFrames, original.trackIndex, p2};
+        Region& original = track.regions[index];
+        Region second = {original.name + " (Slice)", original.startFrame + offsetInFrames, original.duration - offsetInFrames, original.sourceOffset + offsetInFrames, original.trackIndex, original.source};
+        original.duration = offsetInFrames;
         track.regions.insert(track.regions.begin() + index + 1, second);
+        track.publishRegions();
     }
 
     void glueRegions(TrackData& track, size_t index) {
         if (index >= track.regions.size() - 1) return;
         Region& r1 = track.regions[index];
         Region& r2 = track.regions[index + 1];
-        
-        long gapFrames = (long)r2.startFrame - (long)(r1.startFrame + r1.duration);
-        
-        if (gapFrames > 0) {
-            // Add silence gap
-            r1.duration += gapFrames + r2.duration;
-            for(size_t c=0; c < r1.channelPeaks.size(); ++c) {
-                // Approximate silence in peaks (1 peak per pixel approx)
-                size_t silenceCount = (size_t)((float)gapFrames / 44100.0f * 50.0f); // scale to visual
-                r1.channelPeaks[c].insert(r1.channelPeaks[c].end(), silenceCount, 0.0f);
-                if (c < r2.channelPeaks.size())
-                    r1.channelPeaks[c].insert(r1.channelPeaks[c].end(), r2.channelPeaks[c].begin(), r2.channelPeaks[c].end());
-            }
-        } else {
-            // Overlap or perfect touch
-            size_t newEnd = (std::max)(r1.startFrame + r1.duration, r2.startFrame + r2.duration);
-            r1.duration = newEnd - r1.startFrame;
-            
-            // Simple merge: append remaining part of r2 peaks
-            for(size_t c=0; c < r1.channelPeaks.size(); ++c) {
-                if (c < r2.channelPeaks.size())
-                    r1.channelPeaks[c].insert(r1.channelPeaks[c].end(), r2.channelPeaks[c].begin(), r2.channelPeaks[c].end());
-            }
+
+        // A glued region is still a single view, so the two parts must touch on the
+        // timeline and continue each other in the same source (e.g. the two halves of
+        // a slice). Anything else would replay or skip audio, so it stays separate.
+        const char* reason = nullptr;
+        if (r1.source != r2.source) reason = "Different sources, not glued";
+        else if (r2.startFrame != r1.startFrame + r1.duration) reason = "Regions must touch to glue";
+        else if (r2.sourceOffset != r1.sourceOffset + r1.duration) reason = "Not continuous in the source, not glued";
+        if (reason) {
+            m_toolMessage = reason;
+            m_toolMessageTime = 2.0f;
+            return;
         }
-        
+
+        r1.duration += r2.duration;
         track.regions.erase(track.regions.begin() + index + 1);
+        track.publishRegions();
     }
 
     std::shared_ptr<FluxProject> m_project;
@@ -290,12 +292,15 @@ private:
     float m_offsetX = 0, m_offsetY = 0;
     float m_zoom = 1.0f;
     TimelineTool m_tool = TimelineTool::Pointer;
+    std::string m_toolMessage;
+    float m_toolMessageTime = 0.0f;
     TrackData* m_dragTrackPtr = nullptr;
     int m_dragRegionIndex = -1;
     float m_dragOffsetX = 0;
     float m_lastMouseX = 0, m_lastMouseY = 0;
     TrackData* m_selectedTrackPtr = nullptr;
     int m_selectedRegionIndex = -1;
+    std::vector<float> m_peakMin, m_peakMax; // Scratch for waveform queries
 };
 
 } // namespace Beam
@@ -11,6 +11,7 @@
 #include "../engine/flux_script_node.hpp"
 #include "../engine/analog_suite.hpp"
 #include "../engine/flux_fx_nodes.hpp"
+#include "../engine/async_node_wrapper.hpp"
 #include "../engine/audio_engine.hpp"
 #include "../session/flux_project.hpp"
 #include "../utilities/flux_audio_utils.hpp"
@@ -105,6 +106,9 @@ public:
                 float x = (400.0f + (track.trackIndex * 50.0f) + m_panX) / m_zoom;
                 float y = (100.0f + (track.trackIndex * 150.0f) + m_panY) / m_zoom;
                 auto reel = std::make_shared<TapeReel>(track.node, track.nodeId, x, y);
+                reel->onArmRequested = [this](const std::shared_ptr<FluxTrackNode>& node, bool armed, const std::string& path) {
+                    if (m_engine) m_engine->setArmed(node, armed, path);
+                };
                 setupModule(reel);
             }
         }
@@ -143,7 +147,8 @@ public:
         size_t lastSlash = filePath.find_last_of("/\\");
         if (lastSlash != std::string::npos) fileName = filePath.substr(lastSlash + 1);
 
-        auto fluxTrack = std::make_shared<FluxTrackNode>(fileName, 1024 * 4);
+        auto fluxTrack = std::make_shared<FluxTrackNode>(fileName, engine.getMaxBlockFrames(), (float)engine.getSampleRate());
+        fluxTrack->setInputSource(engine.getInputNode());
         if (fluxTrack->load(filePath)) {
             size_t nodeId = m_project->getGraph()->addNode(fluxTrack);
             
@@ -153,9 +158,10 @@ public:
             td.trackIndex = (int)m_project->getTracks().size();
             
             size_t totalFrames = fluxTrack->getInternalNode()->getTotalFrames();
-            Region r = {fileName, 0, totalFrames, 0, td.trackIndex};
-            r.channelPeaks = fluxTrack->getPeakData(400); 
+            // Peaks are built (or mapped from the project cache) off the UI thread
+            Region r = {fileName, 0, totalFrames, 0, td.trackIndex, WaveformSource::acquire(filePath)};
             td.regions.push_back(r);
+            td.publishRegions();
             
             m_project->addTrack(td);
             syncReels(); 
@@ -165,8 +171,9 @@ public:
 
     void addFX(const std::string& type, float x, float y) {
         std::shared_ptr<FluxNode> fxNode;
-        int buf = 1024 * 4;
-        float sr = 44100.0f;
+        // Built for the current device; the engine re-prepares them if it changes.
+        int buf = m_engine ? m_engine->getMaxBlockFrames() : AudioEngine::kDefaultMaxBlockFrames;
+        float sr = m_engine ? (float)m_engine->getSampleRate() : 44100.0f;
 
         x = (x - m_panX) / m_zoom;
         y = (y - m_panY) / m_zoom;
@@ -224,7 +231,8 @@ public:
         else if (type == "Steel Plate") fxNode = std::make_shared<SteelPlate>(buf, sr);
         else if (type == "Golden Hall") fxNode = std::make_shared<GoldenHall>(buf, sr);
         else if (type == "Copper Spring") fxNode = std::make_shared<CopperSpring>(buf, sr);
-        else if (type == "Cathedral") fxNode = std::make_shared<Cathedral>(buf, sr);
+        // Long reverb tails run on their own core, one block behind
+        else if (type == "Cathedral") fxNode = std::make_shared<AsyncNodeWrapper>(std::make_shared<Cathedral>(buf, sr));
         else if (type == "Grain Verb") fxNode = std::make_shared<GrainVerb>(buf, sr);
 
         else if (type == "Echo-Plex") fxNode = std::make_shared<EchoPlex>(buf, sr);
@@ -233,7 +241,7 @@ public:
         else if (type == "Ping-Pong") fxNode = std::make_shared<PingPong_Delay>(buf, sr);
         else if (type == "Space Shift") fxNode = std::make_shared<SpaceShift>(buf, sr);
 
-        else if (type == "Gain") fxNode = std::make_shared<FluxGainNode>(buf);
+        else if (type == "Gain") fxNode = std::make_shared<FluxGainNode>(buf, sr);
         else if (type == "Delay") fxNode = std::make_shared<FluxDelayNode>(buf, sr);
         else if (type == "Spectrum") {
             auto node = std::make_shared<FluxSpectrumAnalyzer>(buf, sr);
@@ -244,7 +252,8 @@ public:
         }
         else if (type == "Loudness") fxNode = std::make_shared<FluxLoudnessMeter>(buf, sr);
         else if (type == "Empty Tape") {
-            auto fluxTrack = std::make_shared<FluxTrackNode>("Empty Tape", buf);
+            auto fluxTrack = std::make_shared<FluxTrackNode>("Empty Tape", buf, sr);
+            if (m_engine) fluxTrack->setInputSource(m_engine->getInputNode());
             size_t nodeId = m_project->getGraph()->addNode(fluxTrack);
             
             TrackData td;
@@ -267,8 +276,8 @@ public:
     }
 
     void addScriptFX(const std::string& path, float x, float y) {
-        float sr = 44100.0f;
-        int buf = 1024 * 4;
+        int buf = m_engine ? m_engine->getMaxBlockFrames() : AudioEngine::kDefaultMaxBlockFrames;
+        float sr = m_engine ? (float)m_engine->getSampleRate() : 44100.0f;
         auto node = std::make_shared<FluxScriptNode>(path, buf, sr);
         size_t id = m_project->getGraph()->addNode(node);
         float vx = (x - m_panX) / m_zoom;
@@ -281,7 +290,10 @@ public:
 
     void removeModule(AudioModule* mod) {
         size_t id = mod->getNodeId();
-        m_project->getGraph()->removeNode(id);
+        GraphTransaction edit(*m_project->getGraph());
+        edit.removeNode(id);
+        if (m_engine) m_engine->commit(edit);
+        else edit.commit();
         auto& tracks = m_project->getTracks();
         for(auto it = tracks.begin(); it != tracks.end(); ++it) {
             if(it->nodeId == id) { tracks.erase(it); break; }
@@ -293,14 +305,14 @@ public:
         for (auto it = m_modules.begin(); it != m_modules.end(); ++it) {
             if (it->get() == mod) { m_modules.erase(it); break; }
         }
-        if (m_engine) m_engine->updatePlan();
     }
 
     void startCableDrag(Port* p) { 
         for (auto it = m_cables.begin(); it != m_cables.end(); ++it) {
             if (it->input == p || it->output == p) {
-                m_project->getGraph()->disconnect(it->output->getModule()->getNodeId(), 0, it->input->getModule()->getNodeId(), 0);
-                m_engine->updatePlan();
+                GraphTransaction edit(*m_project->getGraph());
+                edit.disconnect(it->output->getModule()->getNodeId(), 0, it->input->getModule()->getNodeId(), 0);
+                m_engine->commit(edit);
                 m_activePort = (it->input == p) ? it->output : it->input;
                 m_cables.erase(it);
                 m_isDraggingCable = true;
@@ -315,9 +327,11 @@ public:
         if (!p1 || !p2 || p1->getType() == p2->getType() || !m_engine) return;
         Port* out = (p1->getType() == PortType::Output) ? p1 : p2;
         Port* in = (p1->getType() == PortType::Input) ? p1 : p2;
+        GraphTransaction edit(*m_project->getGraph());
+        edit.connect(out->getModule()->getNodeId(), 0, in->getModule()->getNodeId(), 0);
+        // Rejected edits (e.g. a feedback loop) leave no cable behind.
+        if (!m_engine->commit(edit)) return;
         m_cables.push_back({out, in});
-        m_project->getGraph()->connect(out->getModule()->getNodeId(), 0, in->getModule()->getNodeId(), 0);
-        m_engine->updatePlan();
     }
 
     bool onMouseDown(float x, float y, int button) override {
@@ -1,5 +1,6 @@
 #include "quad_batcher.hpp"
 #include "shader.hpp"
+#include "../engine/trace.hpp"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
@@ -394,6 +395,7 @@ void QuadBatcher::resetViewTransform(float screenW, float screenH) {
 
 void QuadBatcher::flush() {
     if (m_quadCount == 0) return;
+    FLUX_TRACE_SCOPE("QuadBatcher::flush");
 
     if (m_shader) {
         m_shader->use();
@@ -4,6 +4,9 @@
 #include "../engine/midi_event.hpp"
 #include "../engine/audio_device_manager.hpp"
 #include "../engine/offline_renderer.hpp"
+#include "../engine/transcode_cache.hpp"
+#include "../engine/peak_pyramid.hpp"
+#include "../engine/trace.hpp"
 #include "../interface/workspace.hpp"
 #include "../interface/timeline.hpp"
 #include "../interface/tape_reel.hpp"
@@ -13,6 +16,7 @@
 #include "../interface/audio_config_view.hpp"
 #include "../render/ui_shaders.hpp"
 #include <iostream>
+#include <filesystem>
 #include <SDL3/SDL_dialog.h>
 
 namespace Beam {
@@ -36,6 +40,9 @@ void BeamHost::onSaveDialogCallback(void* userdata, const char* const* filelist,
                 path += ".flux";
             }
             ProjectManager::saveProject(path, host->m_project->serialize());
+            std::string cacheDir = (std::filesystem::path(path).parent_path() / TranscodeCache::kDirectoryName).string();
+            TranscodeCache::instance().setCacheDirectory(cacheDir);
+            PeakCache::instance().setCacheDirectory(cacheDir);
             std::cout << "Project saved to: " << path << std::endl;
         }
     }
@@ -46,6 +53,9 @@ void BeamHost::onLoadDialogCallback(void* userdata, const char* const* filelist,
         BeamHost* host = static_cast<BeamHost*>(userdata);
         auto data = ProjectManager::loadProject(filelist[0]);
         if (!data.empty() && host && host->m_project) {
+             std::string cacheDir = (std::filesystem::path(filelist[0]).parent_path() / TranscodeCache::kDirectoryName).string();
+             TranscodeCache::instance().setCacheDirectory(cacheDir);
+             PeakCache::instance().setCacheDirectory(cacheDir);
              host->m_project->deserialize(data);
              std::cout << "Project loaded from: " << filelist[0] << std::endl;
         }
@@ -66,10 +76,11 @@ void BeamHost::onRenderDialogCallback(void* userdata, const char* const* filelis
                     if (end > maxFrame) maxFrame = end;
                 }
             }
-            if (maxFrame == 0) maxFrame = 44100 * 5; 
+            const int sampleRate = host->m_audioEngine->getSampleRate(); // The rate the nodes are prepared for
+            if (maxFrame == 0) maxFrame = (size_t)sampleRate * 5; 
             
             host->m_audioEngine->setPlaying(false);
-            OfflineRenderer::renderToWav(path, host->m_project->getGraph(), maxFrame, 44100);
+            OfflineRenderer::renderToWav(path, host->m_project->getGraph(), maxFrame, sampleRate);
         }
     }
 }
@@ -150,7 +161,7 @@ bool BeamHost::init() {
     m_timeline = std::make_shared<Timeline>(m_project, m_audioEngine.get());
     m_topBar = std::make_shared<TopBar>(m_width);
     m_browser = std::make_shared<Sidebar>(Sidebar::Side::Left);
-    m_masterStrip = std::make_shared<MasterStrip>(m_audioEngine->getMasterNode());
+    m_masterStrip = std::make_shared<MasterStrip>(m_audioEngine->getMasterNode(), m_audioEngine.get());
     m_configView = std::make_shared<AudioConfigView>(m_audioDeviceManager.get(), m_audioEngine.get());
 
     m_browser->onAddFX = [this](std::string type) {
@@ -187,21 +198,13 @@ bool BeamHost::init() {
     m_topBar->onPauseRequested = [this]() { m_audioEngine->setPlaying(false); };
     m_topBar->onRewindRequested = [this]() { m_audioEngine->rewind(); };
     m_topBar->onRecordRequested = [this](bool recording) {
-        if (recording) {
-            auto nodes = m_project->getGraph()->getNodes();
-            for (auto& [id, node] : nodes) {
-                auto track = std::dynamic_pointer_cast<FluxTrackNode>(node);
-                if (track) {
-                    std::string filename = "recording_" + std::to_string(id) + ".wav";
-                    track->startRecording(filename, 44100);
-                }
-            }
-        } else {
-            auto nodes = m_project->getGraph()->getNodes();
-            for (auto& [id, node] : nodes) {
-                auto track = std::dynamic_pointer_cast<FluxTrackNode>(node);
-                if (track) track->stopRecording();
-            }
+        // The engine opens and finalizes the takes and moves armed tracks into the live part.
+        auto nodes = m_project->getGraph()->getNodes();
+        for (auto& [id, node] : nodes) {
+            auto track = std::dynamic_pointer_cast<FluxTrackNode>(node);
+            if (!track) continue;
+            if (recording) m_audioEngine->setArmed(track, true, "recording_" + std::to_string(id) + ".wav");
+            else if (track->isArmed()) m_audioEngine->setArmed(track, false);
         }
     };
     m_topBar->onSaveRequested = [this]() {
@@ -274,6 +277,15 @@ void BeamHost::handleEvents() {
                 m_audioEngine->setPlaying(playing);
                 if (m_topBar) m_topBar->setPlaying(playing);
             }
+            else if (event.key.key == SDLK_F9) {
+                Tracer& tracer = Tracer::instance();
+                tracer.setEnabled(!tracer.isEnabled());
+                std::cout << "Trace: " << (tracer.isEnabled() ? "recording" : "stopped") << std::endl;
+            }
+            else if (event.key.key == SDLK_F10) {
+                std::string path = Tracer::instance().nextDumpPath();
+                if (Tracer::instance().dump(path)) std::cout << "Trace: timeline written to " << path << std::endl;
+            }
             if (m_mode == DAWMode::Splicing && m_timeline) {
                 m_timeline->handleKeyDown(event.key.key);
             }
@@ -310,6 +322,7 @@ void BeamHost::handleEvents() {
 }
 
 void BeamHost::render(float dt) {
+    FLUX_TRACE_SCOPE("BeamHost::render");
     glViewport(0, 0, m_width, m_height);
     glClearColor(0.08f, 0.09f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -332,15 +345,18 @@ void BeamHost::run() {
     float audioBuffer[1024 * 2];
     uint64_t lastTime = SDL_GetTicks();
     int heartbeats = 0;
+    Tracer::instance().setThreadName("Main (UI + Audio)");
     while (m_isRunning) {
         uint64_t currentTime = SDL_GetTicks();
         float dt = (currentTime - lastTime) / 1000.0f;
         lastTime = currentTime;
         handleEvents();
+        m_audioEngine->pollCommands();
         if (m_uiHandler) m_uiHandler->update(dt);
         MIDIBuffer emptyMidi;
         m_audioEngine->process(audioBuffer, 1024, emptyMidi);
         render(dt);
+        Tracer::instance().servicePendingDump();
         heartbeats++;
         if (heartbeats % 500 == 0) std::cout << "DAW Heartbeat: Still alive." << std::endl;
         SDL_Delay(1);
@@ -20,6 +20,17 @@ struct TrackData {
     size_t nodeId;
     std::vector<Region> regions;
     int trackIndex;
+
+    /**
+     * @brief Pushes the current region layout to the playback node. Call after every edit.
+     */
+    void publishRegions() const {
+        if (!node) return;
+        std::vector<RegionSegment> segments;
+        segments.reserve(regions.size());
+        for (const auto& r : regions) segments.push_back({ r.startFrame, r.duration, r.sourceOffset });
+        node->setRegions(segments);
+    }
 };
 
 class FluxProject {
@@ -1,14 +1,18 @@
 #ifndef REGION_HPP
 #define REGION_HPP
 
+#include "waveform_source.hpp"
 #include <string>
-#include <vector>
+#include <memory>
 
 namespace Beam {
 
 /**
  * @struct Region
  * @brief Represents a clip of audio on the timeline.
+ *
+ * A region is a view into a shared WaveformSource; copying, slicing and
+ * gluing only touch these few fields.
  */
 struct Region {
     std::string name;
@@ -16,7 +20,7 @@ struct Region {
     size_t duration;    ///< Length in frames
     size_t sourceOffset; ///< Offset into the source audio file
     int trackIndex;     ///< Vertical lane index
-    std::vector<std::vector<float>> channelPeaks; ///< Cached waveform data per channel
+    std::shared_ptr<const WaveformSource> source; ///< Shared audio file and its peaks
 };
 
 } // namespace Beam
@@ -0,0 +1,70 @@
+#ifndef WAVEFORM_SOURCE_HPP
+#define WAVEFORM_SOURCE_HPP
+
+#include "../engine/peak_pyramid.hpp"
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Beam {
+
+/**
+ * @class WaveformSource
+ * @brief Shared, immutable description of an audio file referenced by regions.
+ *
+ * One instance exists per file while any region refers to it. Regions are
+ * views (source offset + length) into it, so edits never copy waveform data.
+ * The peak pyramid is attached once by the PeakCache worker.
+ */
+class WaveformSource {
+public:
+    /**
+     * @brief Returns the live source for a file, creating it (and requesting its peaks) on first use.
+     */
+    static std::shared_ptr<const WaveformSource> acquire(const std::string& filePath) {
+        static std::mutex registryMutex;
+        static std::unordered_map<std::string, std::weak_ptr<WaveformSource>> registry;
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (auto existing = registry[filePath].lock()) return existing;
+
+        auto source = std::shared_ptr<WaveformSource>(new WaveformSource(filePath));
+        registry[filePath] = source;
+        for (auto it = registry.begin(); it != registry.end();) {
+            it = it->second.expired() ? registry.erase(it) : std::next(it);
+        }
+
+        std::weak_ptr<WaveformSource> weak = source;
+        PeakCache::instance().request(filePath, [weak](std::shared_ptr<const PeakPyramid> pyramid) {
+            if (auto s = weak.lock()) s->setPeaks(std::move(pyramid));
+        });
+        return source;
+    }
+
+    const std::string& getFilePath() const { return m_filePath; }
+
+    /**
+     * @brief The peak pyramid, or nullptr while it is still being generated.
+     */
+    std::shared_ptr<const PeakPyramid> getPeaks() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_peaks;
+    }
+
+private:
+    explicit WaveformSource(const std::string& filePath) : m_filePath(filePath) {}
+
+    void setPeaks(std::shared_ptr<const PeakPyramid> peaks) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_peaks = std::move(peaks);
+    }
+
+    const std::string m_filePath;
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const PeakPyramid> m_peaks;
+};
+
+} // namespace Beam
+
+#endif // WAVEFORM_SOURCE_HPP
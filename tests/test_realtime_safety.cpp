@@ -0,0 +1,261 @@
+#include "../src/engine/audio_engine.hpp"
+#include "../src/engine/analog_suite.hpp"
+#include "../src/engine/flux_fx_nodes.hpp"
+#include "../src/engine/tube_compressor_node.hpp"
+#include "../src/engine/sine_synth_node.hpp"
+#include "../src/engine/flux_script_node.hpp"
+#include "../src/engine/flux_track_node.hpp"
+#include "../src/engine/wav_writer.hpp"
+#include "../src/engine/rt_checks.hpp"
+#include <iostream>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <cmath>
+
+// Runs representative graphs through AudioEngine::renderBlock() and fails if any
+// real-time scope allocated, freed or locked. Build with FLUX_RT_CHECKS defined.
+
+using namespace Beam;
+
+namespace {
+
+const int kSampleRate = 48000;
+const int kBlockFrames = 512;
+const int kBlocks = 200;
+
+size_t findNode(FluxGraph& graph, const std::shared_ptr<FluxNode>& node) {
+    for (const auto& [id, n] : graph.getNodes()) {
+        if (n == node) return id;
+    }
+    return 0;
+}
+
+// UI-side steps around the rendering; none of them runs in a real-time scope itself.
+struct Hooks {
+    std::function<void(AudioEngine&)> configure;   // Before the graph is built
+    std::function<void(AudioEngine&)> start;       // After the plan is installed, before playback
+    std::function<void(AudioEngine&, int)> block;  // Before each block, e.g. capture or a seek
+    std::function<void(AudioEngine&)> stop;        // After the last block, before the transport stops
+};
+
+// Chains `nodes` in order into the master and renders kBlocks blocks.
+bool runGraph(const std::string& name, const std::vector<std::shared_ptr<FluxNode>>& nodes, const Hooks& hooks = {}) {
+    AudioEngine engine;
+    engine.prepare(kSampleRate, 2, kBlockFrames);
+    engine.setRenderAhead(false);
+    if (hooks.configure) hooks.configure(engine);
+
+    auto graph = std::make_shared<FluxGraph>();
+    std::vector<size_t> ids;
+    for (const auto& node : nodes) ids.push_back(graph->addNode(node));
+    engine.setGraph(graph);
+    size_t master = findNode(*graph, engine.getMasterNode());
+    for (size_t i = 0; i + 1 < ids.size(); ++i) graph->connect(ids[i], 0, ids[i + 1], 0);
+    graph->connect(ids.back(), 0, master, 0);
+    engine.updatePlan();
+    if (hooks.start) hooks.start(engine);
+    engine.setPlaying(true);
+
+    std::vector<float> output((size_t)kBlockFrames * 2);
+    MIDIBuffer midi;
+    midi.addEvent({ 0, (uint8_t)MIDIStatus::NoteOn, 60, 100 });
+
+    RealtimeChecks::reset();
+    int rendered = 0;
+    for (int attempt = 0, prepared = -1; rendered < kBlocks && attempt < kBlocks * 100; ++attempt) {
+        if (hooks.block && prepared != rendered) hooks.block(engine, prepared = rendered);
+        if (engine.renderBlock(output.data(), kBlockFrames, rendered == 0 ? midi : MIDIBuffer())) {
+            ++rendered;
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(200)); // Render-ahead catching up
+        }
+    }
+    if (hooks.stop) hooks.stop(engine);
+    engine.setPlaying(false);
+    engine.renderBlock(output.data(), kBlockFrames);
+    engine.pollCommands();
+
+    const uint64_t violations = RealtimeChecks::getViolationCount();
+    std::cout << name << ": " << rendered << " blocks, " << violations << " real-time violations" << std::endl;
+    if (violations > 0) RealtimeChecks::printReport(std::cerr);
+    return rendered == kBlocks && violations == 0;
+}
+
+// The hooks must see each kind of violation, or a clean run proves nothing.
+bool detectorWorks() {
+    RealtimeChecks::reset();
+    std::mutex mutex;
+    {
+        RealtimeChecks::Scope scope;
+        std::vector<float> allocated(64);
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    const auto records = RealtimeChecks::getRecords();
+    bool allocation = false, deallocation = false, locked = false;
+    for (const auto& record : records) {
+        allocation |= record.kind == RealtimeChecks::Violation::Allocation;
+        deallocation |= record.kind == RealtimeChecks::Violation::Deallocation;
+        locked |= record.kind == RealtimeChecks::Violation::Lock;
+    }
+    RealtimeChecks::reset();
+    std::cout << "Detector: allocation " << allocation << ", deallocation " << deallocation << ", lock " << locked << std::endl;
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+    return allocation && deallocation && locked;
+#else
+    return allocation && deallocation; // Locks are only intercepted on glibc
+#endif
+}
+
+std::string writeScript() {
+    const std::string path = "test_realtime_safety.fluxscript";
+    std::ofstream file(path);
+    file << "param drive 0 10 2\n"
+            "param mix 0 1 0.5\n"
+            "process:\n"
+            "in drive * tanh mix * = out\n";
+    return path;
+}
+
+// Two seconds of a stereo sine, played back by the track tests.
+std::string writeTrackFile() {
+    const std::string path = "test_realtime_safety_track.wav";
+    std::vector<float> samples((size_t)kSampleRate * 2 * 2);
+    for (size_t i = 0; i < samples.size() / 2; ++i) {
+        samples[i * 2] = samples[i * 2 + 1] = 0.5f * std::sin(2.0f * 3.14159265f * 220.0f * (float)i / (float)kSampleRate);
+    }
+    return WavWriter::write(path, samples.data(), samples.size(), kSampleRate, 2) ? path : std::string();
+}
+
+// A track playing two regions of the file, with a seek back to the start halfway through.
+bool runTrackPlayback(const std::string& name, const std::string& file, bool renderAhead) {
+    auto track = std::make_shared<FluxTrackNode>("Track", kBlockFrames, (float)kSampleRate);
+    if (!track->load(file)) {
+        std::cerr << name << ": cannot open " << file << std::endl;
+        return false;
+    }
+    track->setRegions({ { 0, (uint64_t)kSampleRate, 0 }, { (uint64_t)kSampleRate, (uint64_t)kSampleRate, (uint64_t)kSampleRate / 2 } });
+
+    // Only the blocks before the first served one after the start and after the seek may
+    // miss the ring; once the prefetch has caught up, every block must be served.
+    std::shared_ptr<TrackNode> streamer = track->getInternalNode();
+    uint64_t seen = 0;
+    uint64_t settledUnderruns = 0;
+    bool settled = false;
+    auto account = [&]() {
+        const uint64_t underruns = streamer->getUnderrunCount();
+        if (underruns == seen) settled = true;
+        else if (settled) settledUnderruns += underruns - seen;
+        seen = underruns;
+    };
+
+    Hooks hooks;
+    hooks.configure = [renderAhead](AudioEngine& engine) { engine.setRenderAhead(renderAhead); };
+    hooks.block = [&](AudioEngine& engine, int block) {
+        // Paced like a device, so the disk thread gets the time it would have in a session.
+        std::this_thread::sleep_for(std::chrono::microseconds((int64_t)kBlockFrames * 1000000 / kSampleRate));
+        if (block > 0) account(); // The previous block
+        if (block == kBlocks / 2) {
+            engine.seek(0);
+            settled = false;
+        }
+    };
+    hooks.stop = [&](AudioEngine&) { account(); };
+    bool ok = runGraph(name, { track, std::make_shared<FluxGainNode>(kBlockFrames, (float)kSampleRate) }, hooks);
+
+    std::cout << name << ": " << seen << " streaming underruns, " << settledUnderruns << " after the prefetch settled" << std::endl;
+    return ok && settled && settledUnderruns == 0;
+}
+
+// An armed track recording the input node's capture block, fed as the capture callback would.
+bool runTrackRecording(const std::string& name) {
+    const std::string take = "test_realtime_safety_take.wav";
+    auto track = std::make_shared<FluxTrackNode>("Track", kBlockFrames, (float)kSampleRate);
+    std::vector<float> capture((size_t)kBlockFrames * 2, 0.25f);
+
+    Hooks hooks;
+    hooks.start = [&](AudioEngine& engine) {
+        track->setInputSource(engine.getInputNode());
+        engine.setArmed(track, true, take);
+    };
+    hooks.block = [&](AudioEngine& engine, int) {
+        engine.getInputNode()->pushData(capture.data(), (int)capture.size());
+    };
+    hooks.stop = [&](AudioEngine& engine) { engine.setArmed(track, false); };
+
+    bool ok = runGraph(name, { track }, hooks);
+    std::shared_ptr<RecordingStream> stream = track->getInternalNode()->getRecordingStream();
+    track->setInputSource(nullptr);
+    std::remove(take.c_str());
+    if (!stream) {
+        std::cerr << name << ": no take was opened" << std::endl;
+        return false;
+    }
+    // Every rendered block is captured, recorded and written out.
+    const uint64_t expected = (uint64_t)kBlocks * kBlockFrames;
+    std::cout << name << ": " << stream->getFramesWritten() << " of " << expected << " frames written, "
+              << stream->getDroppedFrames() << " dropped" << std::endl;
+    return ok && stream->getFramesWritten() == expected && stream->getDroppedFrames() == 0;
+}
+
+} // namespace
+
+int main() {
+    if (!RealtimeChecks::isCompiledIn()) {
+        std::cerr << "test_realtime_safety must be built with FLUX_RT_CHECKS" << std::endl;
+        return 1;
+    }
+
+    const float sr = (float)kSampleRate;
+    const std::string script = writeScript();
+    bool ok = detectorWorks();
+
+    ok &= runGraph("Synth and dynamics", {
+        std::make_shared<SineSynthNode>(kBlockFrames, sr),
+        std::make_shared<TubeCompressorNode>(kBlockFrames, sr),
+        std::make_shared<Opto2A>(kBlockFrames, sr),
+        std::make_shared<FET76>(kBlockFrames, sr),
+        std::make_shared<TubeLimiter>(kBlockFrames, sr),
+    });
+
+    ok &= runGraph("EQ, filters and script", {
+        std::make_shared<SineSynthNode>(kBlockFrames, sr),
+        std::make_shared<TubeP_EQ>(kBlockFrames, sr),
+        std::make_shared<Graphic10_EQ>(kBlockFrames, sr),
+        std::make_shared<FluxFilterNode>(kBlockFrames, sr),
+        std::make_shared<FluxScriptNode>(script, kBlockFrames, sr),
+        std::make_shared<FluxGainNode>(kBlockFrames, sr),
+    });
+
+    auto spaceChain = [&]() -> std::vector<std::shared_ptr<FluxNode>> {
+        return {
+            std::make_shared<SineSynthNode>(kBlockFrames, sr),
+            std::make_shared<FluxDelayNode>(kBlockFrames, sr),
+            std::make_shared<EchoPlex>(kBlockFrames, sr),
+            std::make_shared<PingPong_Delay>(kBlockFrames, sr),
+            std::make_shared<GoldenHall>(kBlockFrames, sr),
+            std::make_shared<GrainVerb>(kBlockFrames, sr),
+            std::make_shared<FluxSpectrumAnalyzer>(kBlockFrames, sr),
+            std::make_shared<FluxLoudnessMeter>(kBlockFrames, sr),
+        };
+    };
+    ok &= runGraph("Delays and reverbs", spaceChain());
+    ok &= runGraph("Delays and reverbs, render-ahead", spaceChain(), { [](AudioEngine& engine) { engine.setRenderAhead(true); } });
+    ok &= runGraph("Delays and reverbs, 2 pipeline stages", spaceChain(), { [](AudioEngine& engine) { engine.setPipelineStages(2); } });
+
+    const std::string trackFile = writeTrackFile();
+    ok &= !trackFile.empty();
+    if (!trackFile.empty()) {
+        ok &= runTrackPlayback("Track playback and seek", trackFile, false);
+        ok &= runTrackPlayback("Track playback and seek, render-ahead", trackFile, true);
+        std::remove(trackFile.c_str());
+    }
+    ok &= runTrackRecording("Armed track recording the input");
+
+    std::remove(script.c_str());
+    std::cout << (ok ? "Real-time safety test passed." : "Real-time safety test FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}